@@ -1,11 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 
 
 struct ASTNode {
+    int line = 0; // строка исходного текста (операторы, вызовы, функции); 0 — неизвестна
     virtual ~ASTNode() = default;
     virtual void accept(class Visitor&) = 0;
 };
@@ -18,13 +20,21 @@ struct DeclNode : ASTNode {
 struct StmtNode : ASTNode {
 };
 
+struct Type;
+struct StructType;
+struct FieldLayout;
+struct VectorLoop;
+class ConstantPool;
+
 // Промежуточный класс для выражений
 struct ExprNode : ASTNode {
+    std::shared_ptr<Type> resolved_type; // заполняется семантическим анализом
 };
 
 // Декларации
 struct TranslationUnitNode : DeclNode {
     std::vector<std::unique_ptr<ASTNode>> declarations;
+    std::shared_ptr<ConstantPool> constants; // заполняется ConstantPool::run перед исполнением
     TranslationUnitNode(std::vector<std::unique_ptr<ASTNode>> decls) : declarations(std::move(decls)) {}
     void accept(Visitor&) override;
 };
@@ -41,8 +51,10 @@ struct TypeNode : DeclNode {
 struct DeclaratorNode : DeclNode {
     std::string name;
     std::unique_ptr<ASTNode> array_size;
+    bool is_array = false; // есть [], в том числе без размера (параметр int a[])
+    int slot = -1; // слот кадра, назначенный FrameAllocator
     DeclaratorNode(const std::string& name, std::unique_ptr<ASTNode> size = nullptr)
-        : name(name), array_size(std::move(size)) {}
+        : name(name), array_size(std::move(size)), is_array(array_size != nullptr) {}
     void accept(Visitor&) override;
 };
 
@@ -84,6 +96,7 @@ struct FuncDeclNode : DeclNode {
     std::vector<std::unique_ptr<ParamDeclNode>> params;
     std::unique_ptr<ASTNode> body;
     bool is_const;
+    int frame_size = 0; // число слотов кадра, назначенное FrameAllocator
     FuncDeclNode(std::unique_ptr<ASTNode> ret, const std::string& name,
                  std::vector<std::unique_ptr<ParamDeclNode>> params,
                  std::unique_ptr<ASTNode> body = nullptr, bool is_const = false)
@@ -94,6 +107,7 @@ struct FuncDeclNode : DeclNode {
 struct StructDeclNode : DeclNode {
     std::string name;
     std::vector<std::unique_ptr<VarDeclNode>> members;
+    std::shared_ptr<StructType> type; // тип с раскладкой, назначенный семантическим анализом
     StructDeclNode(const std::string& name, std::vector<std::unique_ptr<VarDeclNode>> members)
         : name(name), members(std::move(members)) {}
     void accept(Visitor&) override;
@@ -144,6 +158,7 @@ struct ForLoopNode : StmtNode {
     std::unique_ptr<ASTNode> condition;
     std::unique_ptr<ASTNode> increment;
     std::unique_ptr<ASTNode> body;
+    std::shared_ptr<VectorLoop> vector; // план векторного исполнения, назначенный LoopOptimizer
     ForLoopNode(std::unique_ptr<ASTNode> init, std::unique_ptr<ASTNode> cond,
                 std::unique_ptr<ASTNode> inc, std::unique_ptr<ASTNode> body)
         : init(std::move(init)), condition(std::move(cond)), increment(std::move(inc)), body(std::move(body)) {}
@@ -224,6 +239,7 @@ struct CastExprNode : ExprNode {
 struct SubscriptExprNode : ExprNode {
     std::unique_ptr<ASTNode> array;
     std::unique_ptr<ASTNode> index;
+    bool checked = true; // false — оптимизатор доказал, что индекс в границах
     SubscriptExprNode(std::unique_ptr<ASTNode> array, std::unique_ptr<ASTNode> index)
         : array(std::move(array)), index(std::move(index)) {}
     void accept(Visitor&) override;
@@ -240,6 +256,7 @@ struct CallExprNode : ExprNode {
 struct LiteralExprNode : ExprNode {
     std::unique_ptr<ASTNode> type;
     std::string value;
+    uint32_t constant = UINT32_MAX; // номер в пуле констант программы
     LiteralExprNode(std::unique_ptr<ASTNode> type, const std::string& value)
         : type(std::move(type)), value(value) {}
     void accept(Visitor&) override;
@@ -247,6 +264,7 @@ struct LiteralExprNode : ExprNode {
 
 struct IdentifierExprNode : ExprNode {
     std::string name;
+    int slot = -1; // -1: не локальная переменная
     IdentifierExprNode(const std::string& name) : name(name) {}
     void accept(Visitor&) override;
 };
@@ -287,6 +305,7 @@ struct MemberAccessExprNode : ExprNode {
     std::unique_ptr<ASTNode> object;
     std::string member;
     std::string op;
+    const FieldLayout* field = nullptr; // поле в раскладке структуры, назначенное семантическим анализом
     MemberAccessExprNode(std::unique_ptr<ASTNode> object, const std::string& member, const std::string& op)
         : object(std::move(object)), member(member), op(op) {}
     void accept(Visitor&) override;
@@ -295,6 +314,7 @@ struct MemberAccessExprNode : ExprNode {
 struct SizeofExprNode : ExprNode {
     std::unique_ptr<ASTNode> operand;
     bool isType;
+    int64_t size = -1; // размер в байтах, вычисленный семантическим анализом
     SizeofExprNode(std::unique_ptr<ASTNode> op, bool isType) : operand(std::move(op)), isType(isType) {}
     void accept(Visitor&) override;
 };
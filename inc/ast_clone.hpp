@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ast.hpp"
+#include "visitor.hpp"
+#include <memory>
+
+// Глубокое копирование поддерева AST (нужно оптимизатору для размножения тел циклов)
+class AstCloner : public Visitor {
+public:
+    std::unique_ptr<ASTNode> clone(ASTNode& node);
+
+    template<typename T>
+    std::unique_ptr<T> cloneAs(T& node) {
+        return std::unique_ptr<T>(static_cast<T*>(clone(node).release()));
+    }
+
+    void visit(TranslationUnitNode& node) override;
+    void visit(TypeNode& node) override;
+    void visit(DeclaratorNode& node) override;
+    void visit(InitDeclaratorNode& node) override;
+    void visit(VarDeclNode& node) override;
+    void visit(ParamDeclNode& node) override;
+    void visit(FuncDeclNode& node) override;
+    void visit(StructDeclNode& node) override;
+
+    void visit(BlockStatementNode& node) override;
+    void visit(IfStatementNode& node) override;
+    void visit(WhileLoopNode& node) override;
+    void visit(DoWhileLoopNode& node) override;
+    void visit(ForLoopNode& node) override;
+    void visit(ReturnStatementNode& node) override;
+
+    void visit(BinaryExprNode& node) override;
+    void visit(UnaryExprNode& node) override;
+    void visit(TernaryExprNode& node) override;
+    void visit(CastExprNode& node) override;
+    void visit(SubscriptExprNode& node) override;
+    void visit(CallExprNode& node) override;
+    void visit(LiteralExprNode& node) override;
+    void visit(IdentifierExprNode& node) override;
+    void visit(GroupExprNode& node) override;
+    void visit(PostfixExprNode& node) override;
+    void visit(InitListNode& node) override;
+    void visit(BreakStmtNode& node) override;
+    void visit(ContinueStmtNode& node) override;
+    void visit(SizeofExprNode& node) override;
+    void visit(StaticAssertNode& node) override;
+    void visit(ExitExprNode& node) override;
+    void visit(AssertExprNode& node) override;
+    void visit(ReadStmtNode& node) override;
+    void visit(PrintStmtNode& node) override;
+    void visit(AssignmentExprNode& node) override;
+    void visit(MemberAccessExprNode& node) override;
+    void visit(NamespaceDeclNode& node) override;
+    void visit(ScopedIdentifierExprNode& node) override;
+
+private:
+    std::unique_ptr<ASTNode> result;
+
+    std::unique_ptr<ASTNode> cloneOpt(const std::unique_ptr<ASTNode>& node) {
+        return node ? clone(*node) : nullptr;
+    }
+    std::vector<std::unique_ptr<ASTNode>> cloneList(const std::vector<std::unique_ptr<ASTNode>>& nodes);
+    void finishExpr(ExprNode& from, std::unique_ptr<ASTNode> copy);
+};
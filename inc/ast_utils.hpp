@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ast.hpp"
+#include "type.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+// Вспомогательные функции для проходов, переписывающих AST
+
+// Вызывает fn для каждого заменяемого дочернего слота (операторы и выражения)
+void forEachSlot(ASTNode& node, const std::function<void(std::unique_ptr<ASTNode>&)>& fn);
+
+// Обход поддерева в прямом порядке
+void walk(ASTNode& node, const std::function<void(ASTNode&)>& fn);
+
+// Текстовое представление выражения: и ключ для сравнения, и строка для отчётов
+std::string exprToString(ASTNode& node);
+
+size_t countNodes(ASTNode& node);
+
+// Имя переменной, в которую пишет lvalue (a, a.x, a[i] -> "a")
+std::string rootVariable(ASTNode& lvalue);
+
+// Имена переменных, которые присваиваются или объявляются внутри поддерева
+void collectAssigned(ASTNode& node, std::unordered_set<std::string>& names);
+
+// Выражение без побочных эффектов (нет присваиваний, ++/--, вызовов, read/exit)
+bool isPure(ASTNode& node);
+
+// Чистое выражение, которое не может завершиться ошибкой исполнения: без индексации,
+// разыменования и целого деления на что-либо, кроме ненулевой константы
+bool cannotFail(ASTNode& node);
+
+// Содержит break/continue, относящийся к текущему циклу (вложенные циклы не учитываются)
+bool hasLoopExit(ASTNode& body);
+
+std::optional<long long> intLiteralValue(ASTNode* node);
+// Значение константного целого выражения из литералов, + - * / %, унарного минуса и sizeof
+std::optional<long long> constantIntValue(ASTNode* node);
+bool isBuiltin(const std::shared_ptr<Type>& type, const std::string& name);
+
+std::unique_ptr<ASTNode> makeIntLiteral(long long value);
+std::unique_ptr<ASTNode> makeIdentifier(const std::string& name, std::shared_ptr<Type> type);
+std::unique_ptr<VarDeclNode> makeVarDecl(const std::string& name, const std::shared_ptr<Type>& type,
+                                         std::unique_ptr<ASTNode> init);
+
+// Заменяет чтения переменной name на копии выражения value
+void substituteIdentifier(std::unique_ptr<ASTNode>& slot, const std::string& name, ASTNode& value);
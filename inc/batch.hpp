@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Пул потоков с кражей работы. Задачи 0..count-1 заранее делятся между
+// потоками непрерывными кусками (соседние файлы обычно похожи по размеру);
+// поток берёт задачи с конца своей очереди, а когда она пуста — крадёт
+// с начала очереди другого потока. Новых задач по ходу не появляется,
+// поэтому поток завершается, как только все очереди пусты
+class WorkStealingPool {
+public:
+    // threads == 0 — по числу процессоров
+    explicit WorkStealingPool(unsigned threads);
+
+    void run(size_t count, const std::function<void(size_t)>& task);
+    unsigned size() const { return threads; }
+
+private:
+    unsigned threads;
+};
+
+// Результат проверки одного файла
+struct FileReport {
+    bool ok = false;
+    std::string diagnostics; // сообщения лексера, парсера и анализа в порядке появления
+};
+
+// Лексер, парсер и семантический анализ одного файла
+FileReport checkFile(const std::string& path);
+
+// Проверяет файлы параллельно; сообщения печатаются в out в порядке файлов,
+// затем итог. Возвращает код завершения: 0 — ошибок нет
+int runBatch(const std::vector<std::string>& files, unsigned jobs, std::ostream& out);
+
+// Пути из списка: по одному в строке, пустые строки и строки с '#' пропускаются;
+// "-" — стандартный ввод. false — список не прочитан
+bool readFileList(const std::string& list, std::vector<std::string>& files);
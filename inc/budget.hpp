@@ -0,0 +1,56 @@
+#pragma once
+
+#include "limits.hpp"
+#include <cstdint>
+#include <functional>
+
+// Бюджет исполнения в шагах. Шаг — обратный переход цикла или вызов функции
+// в интерпретаторе по дереву и в байт-коде (машинный код JIT шаги не считает),
+// поэтому проверка стоит одного уменьшения счётчика, а не работы на каждой
+// инструкции. Когда квант исчерпан, вызывается expire (например, волокно
+// уступает поток), и начинается следующий квант. Если задан limit, последний
+// квант укорачивается так, чтобы на limit-м шаге вылетел LimitError.
+// Профиль (Profiler) спрашивается на границе кванта, пора ли снять выборку:
+// step возвращает ответ, и выборку снимает вызывающий — только он знает, где
+// сейчас исполнение
+class Budget {
+public:
+    static constexpr int64_t kDefaultQuantum = 10000;
+
+    Budget(int64_t quantum, std::function<void()> expire, uint64_t limit = 0)
+        : quantum(quantum > 0 ? quantum : 1), limit(limit), expire(std::move(expire)) {
+        start();
+    }
+
+    bool step() {
+        if (--left <= 0) return nextQuantum();
+        return false;
+    }
+    // Выборки профиля; квант становится равным quantum шагов
+    void setSampler(std::function<bool()> sample, int64_t quantum) {
+        this->sample = std::move(sample);
+        this->quantum = quantum > 0 ? quantum : 1;
+        spent += static_cast<uint64_t>(period - left);
+        start();
+    }
+    // Шагов с начала исполнения
+    uint64_t getSteps() const { return spent + static_cast<uint64_t>(period - left); }
+
+private:
+    void start() {
+        period = quantum;
+        if (limit && limit - spent < static_cast<uint64_t>(period)) period = static_cast<int64_t>(limit - spent);
+        left = period;
+    }
+
+    // Вне строки: горячие циклы интерпретатора и VM видят только уменьшение счётчика
+    bool nextQuantum();
+
+    int64_t quantum;
+    int64_t period = 0; // длина текущего кванта
+    int64_t left = 0;
+    uint64_t spent = 0;
+    uint64_t limit;
+    std::function<void()> expire;
+    std::function<bool()> sample;
+};
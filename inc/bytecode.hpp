@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ast.hpp"
+#include "constant_pool.hpp"
+#include "value.hpp"
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Стековый байт-код. Ячейки кадра и стека — значения без тегов (Slot): целые
+// любого вида хранятся приведёнными к своей разрядности в int64, float и double —
+// в double. Вид значения известен статически, поэтому операции специализированы:
+// Add..Neg — int с переполнением по модулю 2^32, суффикс U — unsigned int,
+// L — long и unsigned long, UL — деление unsigned long, D — float и double
+// (результат float округляет Convert). Lt..Ne сравнивают int64 со знаком, LtU..GeU —
+// без знака, LtD..NeD — вещественные. Convert приводит значение вида a к виду b.
+// a — операнд (константа, слот кадра, адрес перехода или номер вызываемой функции),
+// b — число аргументов вызова. ConstK кладёт константу a из пула constants.
+// Inc (slot += b) и CmpJz (сравнение b, переход на a, если оно ложно) — составные
+// инструкции, их порождает только optimizeBytecode.
+// Exit и Deopt (точка возобновления a) встречаются только в циклах для замены на стеке;
+// b = 1 у Jmp отмечает обратный переход цикла
+enum class Op : uint8_t {
+    Const, Load, Store, Dup, Pop,
+    Add, Sub, Mul, Div, Mod, Neg, Not,
+    Lt, Le, Gt, Ge, Eq, Ne,
+    Jmp, Jz, Jnz, Call, Ret,
+    Inc, CmpJz, Exit, Deopt,
+    ConstK, Convert,
+    AddU, SubU, MulU, DivU, ModU, NegU,
+    AddL, SubL, MulL, DivL, ModL, NegL, DivUL, ModUL,
+    AddD, SubD, MulD, DivD, NegD,
+    LtU, LeU, GtU, GeU,
+    LtD, LeD, GtD, GeD, EqD, NeD
+};
+constexpr size_t kOpCount = static_cast<size_t>(Op::NeD) + 1;
+
+// Мнемоника инструкции, как в disassemble
+const char* opName(Op op);
+
+union Slot {
+    int64_t i;
+    double f;
+};
+
+struct Instr {
+    Op op;
+    int32_t a = 0;
+    int32_t b = 0;
+};
+
+// Точка деоптимизации: оператор, с которого интерпретатор продолжает итерацию,
+// и продолжения объемлющих блоков — (блок, индекс следующего оператора),
+// от внутреннего к внешнему
+struct ResumePoint {
+    ASTNode* statement;
+    std::vector<std::pair<BlockStatementNode*, size_t>> rest;
+};
+
+struct BytecodeFunction {
+    std::string name;
+    int param_count = 0;
+    int frame_size = 0;
+    std::vector<Instr> code;
+    int max_stack = 0;                // наибольшая глубина стека вычислений
+    std::vector<std::string> callees; // операнд Call — индекс в этом списке
+    std::vector<const BytecodeFunction*> targets; // callees после связывания
+    std::vector<ResumePoint> resume;  // для цикла: операнды Deopt
+    std::vector<Slot> constants;      // операнды ConstK
+    std::vector<Value::Kind> param_kinds;
+    Value::Kind return_kind = Value::Kind::Int;
+    std::vector<Value::Kind> slot_kinds; // вид каждого слота кадра; Void — слот не используется
+    std::vector<int32_t> lines;       // строка исходного текста каждой инструкции (0 — неизвестна)
+};
+
+// Переводит функцию в байт-код. Поддерживается подмножество языка: параметры,
+// локальные переменные и результат встроенных числовых типов, арифметика,
+// сравнения, приведения, ветвления, циклы и вызовы. Продвижение и приведения
+// повторяют интерпретатор. Для остального compile возвращает nullopt, причина — в getError.
+// compileLoop переводит один цикл функции для замены на стеке: кадр — все слоты
+// функции, вход — проверка условия, как после обратного перехода. Неподдерживаемые
+// операторы тела становятся точками деоптимизации
+class BytecodeCompiler {
+public:
+    // functions — объявления вызываемых функций: по ним приводятся аргументы и результат;
+    // constants — пул констант программы, на который ссылаются литералы
+    BytecodeCompiler(const std::unordered_map<std::string, FuncDeclNode*>& functions, const ConstantPool& constants)
+        : functions(functions), constants(constants) {}
+
+    std::optional<BytecodeFunction> compile(FuncDeclNode& func);
+    std::optional<BytecodeFunction> compileLoop(FuncDeclNode& func, ASTNode& loop, int frameSize);
+    const std::string& getError() const { return error; }
+
+private:
+    struct Unsupported {
+        std::string reason;
+    };
+    struct LoopLabels {
+        std::vector<size_t> breaks;
+        std::vector<size_t> continues;
+    };
+
+    const std::unordered_map<std::string, FuncDeclNode*>& functions;
+    const ConstantPool& constants;
+    BytecodeFunction out;
+    FuncDeclNode* function = nullptr;
+    std::vector<LoopLabels> loops;
+    std::vector<std::pair<BlockStatementNode*, size_t>> blocks; // путь к текущему оператору
+    bool osr = false;
+    int line = 0; // строка текущего оператора, её получают новые инструкции
+    std::string error;
+
+    size_t emit(Op op, int32_t a = 0, int32_t b = 0);
+    void insert(size_t at, Instr in);
+    void patch(size_t at, size_t target);
+    void patchLoop(LoopLabels& labels, size_t breakTarget, size_t continueTarget);
+    void statement(ASTNode& node);
+    void lower(ASTNode& node);
+    void effect(ASTNode& node);
+    Value::Kind expression(ASTNode& node);
+    void condition(ASTNode& node);
+    void constant(Value::Kind kind, Slot value);
+    void convert(Value::Kind from, Value::Kind to);
+    Value::Kind arithmetic(const std::string& op, Value::Kind left, Value::Kind right, size_t rightStart);
+    void step(Value::Kind kind, const std::string& op);
+    int slotOf(ASTNode& node, Value::Kind& kind);
+    void useSlot(int slot, Value::Kind kind);
+    Value::Kind requireNumeric(ASTNode* type, const std::string& what, bool allowVoid = false);
+};
+
+// Оптимизация готового байт-кода: свёртка констант, ветвления по константам,
+// цепочки переходов, удаление недостижимого кода и составные инструкции
+void optimizeBytecode(BytecodeFunction& func);
+
+// Байт-код всех функций программы, которые компилируются вместе со всеми
+// вызываемыми (оптимизирован, ещё не связан)
+std::vector<BytecodeFunction> compileProgram(TranslationUnitNode& program, const ConstantPool& constants);
+
+void disassemble(const BytecodeFunction& func, std::ostream& out);
+
+// Перенос значений между интерпретатором и ячейками байт-кода
+Slot toSlot(const Value& v, Value::Kind kind);
+Value fromSlot(Slot v, Value::Kind kind);
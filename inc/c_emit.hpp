@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ast.hpp"
+#include "type.hpp"
+#include "visitor.hpp"
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class CEmitError : public std::runtime_error {
+public:
+    explicit CEmitError(const std::string& message)
+        : std::runtime_error("C Backend Error: " + message) {}
+};
+
+// Генератор C: по проверенному AST строит самостоятельную единицу трансляции.
+// Семантика совпадает с интерпретатором: int 32-битный с переполнением по модулю
+// (компилировать с -fwrapv), объявления обнуляют переменные, индексы массивов
+// проверяются, деление на ноль — ошибка времени исполнения. print/read/assert/exit
+// и проверки реализованы в небольшом runtime, который вставляется в начало файла.
+// Имена программы получают префиксы (fn_, v_, s_, m_), чтобы не пересекаться с C.
+class CEmitVisitor : public Visitor {
+public:
+    std::string emit(TranslationUnitNode& unit);
+
+    void visit(TranslationUnitNode& node) override;
+    void visit(TypeNode& node) override;
+    void visit(DeclaratorNode& node) override;
+    void visit(InitDeclaratorNode& node) override;
+    void visit(VarDeclNode& node) override;
+    void visit(ParamDeclNode& node) override;
+    void visit(FuncDeclNode& node) override;
+    void visit(StructDeclNode& node) override;
+
+    void visit(BlockStatementNode& node) override;
+    void visit(IfStatementNode& node) override;
+    void visit(WhileLoopNode& node) override;
+    void visit(DoWhileLoopNode& node) override;
+    void visit(ForLoopNode& node) override;
+    void visit(ReturnStatementNode& node) override;
+
+    void visit(BinaryExprNode& node) override;
+    void visit(UnaryExprNode& node) override;
+    void visit(TernaryExprNode& node) override;
+    void visit(CastExprNode& node) override;
+    void visit(SubscriptExprNode& node) override;
+    void visit(CallExprNode& node) override;
+    void visit(LiteralExprNode& node) override;
+    void visit(IdentifierExprNode& node) override;
+    void visit(GroupExprNode& node) override;
+    void visit(PostfixExprNode& node) override;
+    void visit(InitListNode& node) override;
+    void visit(BreakStmtNode& node) override;
+    void visit(ContinueStmtNode& node) override;
+    void visit(SizeofExprNode& node) override;
+    void visit(StaticAssertNode& node) override;
+    void visit(ExitExprNode& node) override;
+    void visit(AssertExprNode& node) override;
+    void visit(ReadStmtNode& node) override;
+    void visit(PrintStmtNode& node) override;
+    void visit(AssignmentExprNode& node) override;
+    void visit(MemberAccessExprNode& node) override;
+    void visit(NamespaceDeclNode& node) override;
+    void visit(ScopedIdentifierExprNode& node) override;
+
+private:
+    std::ostringstream out;
+    std::ostringstream globalInit;
+    int indentLevel = 0;
+    bool inGlobalInit = false;
+    FuncDeclNode* currentFunction = nullptr;
+    std::unordered_map<std::string, StructDeclNode*> structs;
+    std::unordered_map<std::string, FuncDeclNode*> functions;
+    std::vector<std::unordered_set<std::string>> arrays; // имена массивов по областям видимости
+
+    std::ostream& code() { return inGlobalInit ? globalInit : out; }
+    void indent();
+    void statement(ASTNode& node);
+    void nested(ASTNode& node);
+    void declare(TypeNode& type, InitDeclaratorNode& decl);
+    void expr(ASTNode& node);
+    bool isArray(const std::string& name) const;
+    std::string cType(TypeNode& type);
+    std::string cType(const std::shared_ptr<Type>& type);
+    std::string signature(FuncDeclNode& func);
+    std::string divide(const std::string& op, ASTNode& left, ASTNode& right);
+};
+
+// Текст runtime, которым начинается каждая сгенерированная единица трансляции
+const char* cRuntimeHeader();
+
+// Компилирует C-код установленным компилятором (переменная окружения CC или cc)
+bool compileNative(const std::string& source, const std::string& output, std::string& error);
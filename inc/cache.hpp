@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ast.hpp"
+#include "image.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Кэш результатов front-end на диске. Ключ — хеш исходного текста, версии
+// интерпретатора (формат образа, размер и время изменения исполняемого файла)
+// и флагов, влияющих на дерево (-O). Запись — обычный образ .ibc, к которому
+// добавлен текст отчётов оптимизатора: при попадании отчёты печатаются так же,
+// как при полной сборке.
+//
+// Запись сначала пишется во временный файл и переименовывается на место,
+// поэтому параллельные процессы видят либо целую запись, либо никакой.
+// После записи старые файлы (по времени последнего использования) удаляются,
+// пока каталог не станет меньше limit. Любая ошибка кэша не мешает
+// исполнению: запись просто пропускается
+class CompileCache {
+public:
+    CompileCache(std::string dir, uint64_t limit);
+
+    // $INTERPRET_CACHE_DIR, $XDG_CACHE_HOME/interpret или ~/.cache/interpret;
+    // пустая строка — каталог определить нельзя
+    static std::string defaultDir();
+
+    static std::string key(const std::string& source, bool optimize);
+
+    std::optional<ProgramImage> load(const std::string& key);
+    void store(const std::string& key, TranslationUnitNode& program, const std::string& notes);
+
+private:
+    std::string path(const std::string& key) const;
+    void evict();
+
+    std::string dir;
+    uint64_t limit;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ast.hpp"
+#include "token.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Одна компиляция исходного текста: свои лексер, парсер и анализатор, свои
+// токены, дерево и сообщения. Общего изменяемого состояния у компиляций нет,
+// поэтому их можно выполнять одновременно в разных потоках одного процесса
+class Compilation {
+public:
+    explicit Compilation(std::string source);
+
+    // Этапы по порядку. false — этап нашёл ошибки (они в getErrors),
+    // следующий этап запускать нельзя
+    bool lex();
+    bool parse();
+    bool analyze();
+    bool run() { return lex() && parse() && analyze(); }
+
+    const std::vector<Token>& getTokens() const { return tokens; }
+    const std::vector<std::string>& getErrors() const { return errors; }
+    // Счётчики этапов (для --time-report); анализ заполняет их и при ошибках
+    struct Counters {
+        size_t bytes = 0;     // исходного текста
+        size_t tokens = 0;
+        size_t scopes = 0;    // созданных областей видимости
+        size_t symbols = 0;   // объявленных переменных и параметров
+        size_t functions = 0; // сигнатур функций
+        size_t types = 0;     // структур
+    };
+    const Counters& getCounters() const { return counters; }
+    // Проверенное дерево (корень — TranslationUnitNode); компиляция его больше не хранит
+    std::unique_ptr<ASTNode> takeProgram() { return std::move(ast); }
+
+private:
+    std::string source;
+    std::vector<Token> tokens;
+    std::unique_ptr<ASTNode> ast;
+    std::vector<std::string> errors;
+    Counters counters;
+};
+
+// Подготовка проверенного дерева к исполнению: оптимизации (optimize), раскладка
+// кадров и пул констант. Отчёты оптимизаций пишутся в report, если он задан
+void prepareProgram(TranslationUnitNode& unit, bool optimize, std::ostream* report);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ast.hpp"
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+// Свёртка константных выражений и распространение констант внутри функций.
+// Целочисленная арифметика повторяет семантику int (32 бита, переполнение по модулю).
+class ConstantFolder {
+public:
+    void run(ASTNode& root);
+    void collectGlobals(ASTNode& root);
+    void runOnFunction(FuncDeclNode& func);
+    size_t getFolded() const { return folded; }
+    size_t getPropagated() const { return propagated; }
+
+private:
+    size_t folded = 0;
+    size_t propagated = 0;
+    std::unordered_set<std::string> globals;   // имена глобальных переменных
+
+    void foldSlot(std::unique_ptr<ASTNode>& slot);
+    bool propagate(FuncDeclNode& func);
+};
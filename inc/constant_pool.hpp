@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ast.hpp"
+#include "value.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Пул констант программы. Каждый литерал разбирается один раз в машинное
+// значение, одинаковые константы (вид и биты) и одинаковые строки хранятся
+// один раз; литерал ссылается на пул номером LiteralExprNode::constant.
+// Байты всех строк лежат подряд в одном блоке, значения-строки указывают
+// в него, поэтому исполнение строку не копирует. После run пул не меняется
+class ConstantPool {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // Собирает литералы программы и записывает номера в узлы
+    void run(ASTNode& root);
+    // Пул из образа программы: строки (номер значения, текст) указывают
+    // в memory, которая живёт вместе с пулом
+    void adopt(std::vector<Value> constants, const std::vector<std::pair<uint32_t, std::string_view>>& texts,
+               std::shared_ptr<const void> memory);
+
+    const Value& at(uint32_t index) const { return values[index]; }
+    size_t size() const { return values.size(); }
+    void printReport(std::ostream& out) const;
+
+    // Значение числового или символьного литерала; nullopt — строка
+    // или текст, который не разбирается
+    static std::optional<Value> parse(const LiteralExprNode& lit);
+
+private:
+    std::vector<Value> values;
+    std::string blob;                      // байты строк подряд
+    std::vector<std::string_view> strings; // строки-константы внутри blob или storage
+    std::shared_ptr<const void> storage;   // отображение образа, если пул загружен из него
+    size_t literals = 0;
+};
+
+// Пул программы; если его ещё нет, строится по текущему дереву
+const ConstantPool& constantsOf(TranslationUnitNode& program);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ast.hpp"
+#include "bytecode.hpp"
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Счётчики исполнения. Узлы дерева считает интерпретатор по дереву (каждое
+// eval/exec и каждый вызов функции), поэтому точные счёты строк получаются
+// только без байт-кода (--no-tier). Инструкции байт-кода и пары соседних
+// инструкций считает исполнитель байт-кода, если он собран с
+// INTERPRET_COUNTERS (make COUNTERS=1): счётчик в цикле диспетчеризации
+// иначе стоил бы каждой программе
+class ExecutionCounters {
+public:
+    // Исполнение узла деревом
+    void node(const ASTNode& n) { ++nodes[&n]; }
+
+    // Исполнение инструкции байт-кода; previous — предыдущая исполненная в том же
+    // вызове (kOpCount — нет такой). Возвращает previous для следующей
+    size_t instruction(size_t previous, Op op) {
+        size_t k = static_cast<size_t>(op);
+        ++ops[k];
+        if (previous < kOpCount) ++pairs[previous * kOpCount + k];
+        return k;
+    }
+
+    static constexpr bool countsBytecode() {
+#ifdef INTERPRET_COUNTERS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Сводка: узлы по видам, самые частые узлы, инструкции и пары инструкций
+    void print(TranslationUnitNode& program, std::ostream& out, size_t top = 20) const;
+    // Исходный текст с числом исполнений каждой строки в формате gcov:
+    // "count:line:text"; "#####" — строка с кодом, который не исполнялся,
+    // "-" — строка без кода. Строка узла без номера — строка ближайшего предка
+    void annotate(TranslationUnitNode& program, const std::string& source, const std::string& name,
+                  std::ostream& out) const;
+
+private:
+    std::unordered_map<const ASTNode*, uint64_t> nodes;
+    std::array<uint64_t, kOpCount> ops{};
+    std::vector<uint64_t> pairs = std::vector<uint64_t>(kOpCount * kOpCount);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <ucontext.h>
+
+// Волокно: функция со своим стеком, которую можно приостановить (yield)
+// и продолжить (resume) с того же места, в том числе в другом потоке.
+// Стек — отображение с MAP_NORESERVE и защитной страницей снизу: память
+// занимают только затронутые страницы, переполнение — SIGSEGV, а не порча
+// чужой памяти. Исключение, вылетевшее из тела, resume бросает дальше
+class Fiber {
+public:
+    static constexpr size_t kStackSize = 8u << 20; // как у главного потока
+
+    explicit Fiber(std::function<void()> body, size_t stackSize = kStackSize);
+    ~Fiber();
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    // Исполняет волокно до yield или конца тела; true — тело завершилось
+    bool resume();
+    bool isFinished() const { return finished; }
+
+    // Возвращает управление тому, кто вызвал resume; вне волокна ничего не делает
+    static void yield();
+    // Волокно, исполняемое этим потоком; nullptr — поток не в волокне
+    static Fiber* current();
+
+private:
+    static void entry(unsigned high, unsigned low);
+
+    std::function<void()> body;
+    ucontext_t context;
+    ucontext_t caller;
+    char* stack = nullptr;
+    size_t mapped = 0;
+    bool finished = false;
+    std::exception_ptr error;
+    Fiber* outer = nullptr; // волокно, из которого вызван resume
+    void* sanitizerFiber = nullptr;
+    void* sanitizerCaller = nullptr;
+};
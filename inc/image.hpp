@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ast.hpp"
+#include "bytecode.hpp"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class ImageError : public std::runtime_error {
+public:
+    explicit ImageError(const std::string& message) : std::runtime_error("Image Error: " + message) {}
+};
+
+// Образ программы (.ibc): проверенное и оптимизированное дерево со всеми
+// аннотациями (типы, слоты, номера констант, раскладки структур, планы
+// векторных циклов), пул констант и байт-код функций, которые компилируются.
+// Загрузка не запускает лексер, парсер и анализ: файл отображается в память,
+// узлы восстанавливаются из записей, указатели (поля структур, узлы планов,
+// вызываемые функции байт-кода) связываются по номерам, а строки пула указывают
+// прямо в отображение.
+//
+// Формат: заголовок ImageHeader, затем секции по смещениям из заголовка, каждая
+// выровнена на 8 байт. Числа — в порядке байтов машины, которая писала образ
+// (проверяется по kByteOrder). Несовпадение версии или контрольной суммы
+// (FNV-1a всех байтов после заголовка) — ошибка загрузки: содержимое образа
+// дальше не перепроверяется
+struct ImageHeader {
+    static constexpr char kMagic[4] = {'I', 'B', 'C', '\0'};
+    static constexpr uint32_t kVersion = 4;
+    static constexpr uint32_t kByteOrder = 0x01020304;
+
+    enum Section { Constants, Types, Nodes, Functions, Notes, kSectionCount };
+
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t reserved = 0;
+    uint64_t size; // длина всего файла
+    uint64_t checksum;
+    uint64_t offsets[kSectionCount];
+    uint64_t lengths[kSectionCount];
+};
+
+// Загруженная программа. Отображение файла живёт, пока жив пул констант
+struct ProgramImage {
+    std::unique_ptr<TranslationUnitNode> program;
+    std::vector<std::unique_ptr<BytecodeFunction>> bytecode; // ещё не связаны
+    std::string notes; // отчёты, напечатанные при сборке образа
+};
+
+// true — файл начинается с сигнатуры образа
+bool isImageFile(const std::string& path);
+
+// Пишет образ программы после FrameAllocator и ConstantPool::run; notes —
+// текст отчётов оптимизатора, который сохраняется вместе с программой
+void writeImage(TranslationUnitNode& program, const std::string& path, const std::string& notes = "");
+
+ProgramImage loadImage(const std::string& path);
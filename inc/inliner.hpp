@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ast.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Решение, принятое для одного места вызова
+struct InlineDecision {
+    std::string caller;
+    std::string callee;
+    int loop_depth = 0;
+    bool inlined = false;
+    std::string reason;
+};
+
+// Встраивание небольших функций вида `T f(params) { return expr; }`.
+// Граф вызовов строится по FuncDeclNode/CallExprNode; функции из циклов графа
+// (рекурсия) не встраиваются. Порог стоимости растёт с глубиной цикла в месте вызова.
+class Inliner {
+public:
+    void run(TranslationUnitNode& root);
+    const std::vector<InlineDecision>& getDecisions() const { return decisions; }
+    void printReport(std::ostream& out) const;
+
+    static constexpr size_t kBaseThreshold = 12;   // размер тела в узлах AST
+    static constexpr size_t kHotLoopBonus = 16;    // прибавка за каждый уровень вложенности цикла
+
+private:
+    std::unordered_map<std::string, FuncDeclNode*> functions;
+    std::unordered_map<std::string, std::unordered_set<std::string>> callGraph;
+    std::unordered_set<std::string> recursive;
+    std::vector<InlineDecision> decisions;
+    std::string currentFunction;
+
+    void buildCallGraph();
+    std::vector<std::string> bottomUpOrder();
+    void inlineCalls(std::unique_ptr<ASTNode>& slot, int loopDepth);
+    ASTNode* inlinableBody(FuncDeclNode& func, std::string& reason);
+    bool argumentsUsedOnce(FuncDeclNode& func, ASTNode& body, CallExprNode& call);
+};
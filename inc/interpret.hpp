@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class FiberScheduler;
+
+// Встраиваемый интерфейс интерпретатора (build/lib/libinterpret.a).
+// compile один раз проводит программу через лексер, парсер, анализ,
+// оптимизации и байт-код; готовая Program неизменяема, её можно копировать
+// и исполнять одновременно из многих потоков: у каждого run свои
+// интерпретатор, профили, байт-код после связывания и JIT
+namespace interpret {
+
+// Ошибки лексера, парсера или анализа; what() — первая из них
+class CompileError : public std::runtime_error {
+public:
+    explicit CompileError(std::vector<std::string> errors);
+    const std::vector<std::string>& errors() const { return messages; }
+
+private:
+    std::vector<std::string> messages;
+};
+
+struct CompileOptions {
+    bool optimize = true;   // как -O
+    bool tier = true;       // горячие функции и циклы переходят в байт-код
+    bool jit = false;       // и дальше в машинный код
+    int tierCalls = 100;    // вызовов до компиляции
+    int tierLoops = 10000;  // обратных переходов до компиляции цикла
+};
+
+// Чем закончилось исполнение: программа завершилась сама (Exit, код — её),
+// ошибка исполнения или превышен один из пределов Limits
+enum class Termination { Exit, Error, Steps, Time, Depth, Memory, Output };
+
+const char* toString(Termination termination);
+
+// Ввод и вывод одного исполнения
+struct IO {
+    std::string input;  // то, что программа читает через read
+    std::string output; // то, что она печатает через print
+    std::string errors; // сообщение об ошибке исполнения
+    // Если задан, напечатанное передаётся сюда кусками по мере сброса буфера
+    // вместо output; false — получатель закрыт, дальнейший вывод теряется
+    std::function<bool(std::string_view)> write;
+    // Если задан, ввод читается отсюда по мере надобности вместо input:
+    // дописать до size байт в buffer и вернуть их число, 0 — конец ввода
+    std::function<size_t(char* buffer, size_t size)> read;
+    // Причина завершения; подробности — в errors
+    Termination termination = Termination::Exit;
+};
+
+// Ограничения одного исполнения; 0 — без предела. Проверки стоят только на
+// обратных переходах циклов и вызовах (шаги — каждый раз, время — раз в квант
+// шагов), при создании структур и массивов и при сбросе буфера вывода.
+// С пределами шагов, времени или глубины JIT не используется
+struct Limits {
+    uint64_t steps = 0;    // шагов: обратных переходов циклов и вызовов
+    double seconds = 0;    // времени с начала исполнения
+    int callDepth = 0;     // глубины вызовов; общий предел — 2000
+    uint64_t memory = 0;   // байтов в живых структурах и массивах
+    uint64_t output = 0;   // байтов вывода; лишнее не доходит до получателя
+};
+
+class Program {
+public:
+    // Исполняет main; возвращает код завершения программы (1 — ошибка исполнения).
+    // В задаче Scheduler исполнение уступает поток каждые quantum шагов
+    // (обратный переход цикла или вызов); JIT там не используется: машинный
+    // код шаги не считает
+    int run(IO& io, const Limits& limits = {}) const;
+    // Отчёты оптимизаций, напечатанные при компиляции
+    const std::string& report() const;
+
+private:
+    struct State;
+    explicit Program(std::shared_ptr<const State> state) : state(std::move(state)) {}
+    friend Program compile(const std::string& source, const CompileOptions& options);
+
+    std::shared_ptr<const State> state;
+};
+
+Program compile(const std::string& source, const CompileOptions& options = {});
+
+// Исполняет много программ на нескольких потоках без потока на программу:
+// каждая задача — волокно, долгая программа уступает поток остальным
+// после кванта шагов, поэтому бесконечный цикл не задерживает соседей.
+// Задача может ждать сокет или ввод, но блокировать поток надолго не должна
+class Scheduler {
+public:
+    static constexpr int64_t kDefaultQuantum = 10000;
+
+    // threads == 0 — по числу процессоров; quantum — шагов до уступки потока
+    explicit Scheduler(unsigned threads = 0, int64_t quantum = kDefaultQuantum);
+    // Дожидается всех задач
+    ~Scheduler();
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Произвольная задача в новом волокне; исключение из неё завершает процесс
+    void spawn(std::function<void()> task);
+    // Исполняет program с io (io должен жить до вызова done); done получает код завершения
+    void submit(Program program, IO& io, std::function<void(int)> done = {});
+    // Ждёт завершения всех задач
+    void wait();
+
+private:
+    std::unique_ptr<FiberScheduler> fibers;
+};
+
+} // namespace interpret
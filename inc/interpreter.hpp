@@ -0,0 +1,171 @@
+#pragma once
+
+#include "ast.hpp"
+#include "budget.hpp"
+#include "counters.hpp"
+#include "constant_pool.hpp"
+#include "io.hpp"
+#include "limits.hpp"
+#include "profiler.hpp"
+#include "tiering.hpp"
+#include "value.hpp"
+#include "visitor.hpp"
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Досрочное завершение программы через exit(...)
+struct ProgramExit {
+    int code;
+};
+
+// Исполнитель по дереву: обходит проверенный AST, локальные переменные лежат
+// в плоском кадре по слотам FrameAllocator
+class Interpreter : public Visitor {
+public:
+    static constexpr int kMaxCallDepth = ::kMaxCallDepth;
+
+    // print и read программы идут через out и in
+    Interpreter(TranslationUnitNode& program, OutputBuffer& out, InputBuffer& in);
+
+    // Запускает main; возвращает код завершения программы
+    int run();
+    Value call(FuncDeclNode& func, std::vector<Value>& args);
+
+    // Горячие функции переходят на уровни tiers; verify — каждый результат
+    // байт-кода и машинного кода сверяется с интерпретатором
+    void setTiers(TierManager* tiers, bool verify);
+    // Каждая итерация цикла и каждый вызов расходуют шаг budget; вызывать после setTiers
+    void setBudget(Budget* budget);
+    // Пределы исполнения (вызывать после setTiers). Шаги и время считает свой
+    // Budget, на границе кванта он вызывает yield (если задан) — так же
+    // волокно уступает поток каждые quantum шагов
+    void setLimits(const ExecutionLimits& limits, std::function<void()> yield = {},
+                   int64_t quantum = Budget::kDefaultQuantum);
+    // Выборки профиля (вызывать после setTiers и setLimits); квант бюджета
+    // становится квантом профиля, без бюджета заводится свой
+    void setProfiler(Profiler* profiler);
+    // Счётчики исполнения узлов (и инструкций байт-кода, см. ExecutionCounters);
+    // вызывать после setTiers
+    void setCounters(ExecutionCounters* counters);
+    const MemoryMeter& getMemory() const { return memory; }
+    uint64_t getSteps() const { return budget ? budget->getSteps() : 0; }
+    int getVerifiedCalls() const { return verifiedCalls; }
+    int getMismatches() const { return mismatches; }
+
+    void visit(TranslationUnitNode& node) override;
+    void visit(TypeNode& node) override;
+    void visit(DeclaratorNode& node) override;
+    void visit(InitDeclaratorNode& node) override;
+    void visit(VarDeclNode& node) override;
+    void visit(ParamDeclNode& node) override;
+    void visit(FuncDeclNode& node) override;
+    void visit(StructDeclNode& node) override;
+
+    void visit(BlockStatementNode& node) override;
+    void visit(IfStatementNode& node) override;
+    void visit(WhileLoopNode& node) override;
+    void visit(DoWhileLoopNode& node) override;
+    void visit(ForLoopNode& node) override;
+    void visit(ReturnStatementNode& node) override;
+
+    void visit(BinaryExprNode& node) override;
+    void visit(UnaryExprNode& node) override;
+    void visit(TernaryExprNode& node) override;
+    void visit(CastExprNode& node) override;
+    void visit(SubscriptExprNode& node) override;
+    void visit(CallExprNode& node) override;
+    void visit(LiteralExprNode& node) override;
+    void visit(IdentifierExprNode& node) override;
+    void visit(GroupExprNode& node) override;
+    void visit(PostfixExprNode& node) override;
+    void visit(InitListNode& node) override;
+    void visit(BreakStmtNode& node) override;
+    void visit(ContinueStmtNode& node) override;
+    void visit(SizeofExprNode& node) override;
+    void visit(StaticAssertNode& node) override;
+    void visit(ExitExprNode& node) override;
+    void visit(AssertExprNode& node) override;
+    void visit(ReadStmtNode& node) override;
+    void visit(PrintStmtNode& node) override;
+    void visit(AssignmentExprNode& node) override;
+    void visit(MemberAccessExprNode& node) override;
+    void visit(NamespaceDeclNode& node) override;
+    void visit(ScopedIdentifierExprNode& node) override;
+
+private:
+    // Как завершился последний оператор
+    enum class Flow { Normal, Break, Continue, Return };
+    // Итог обратного перехода: цикл продолжается как обычно, завершён в байт-коде
+    // или возобновлён интерпретатором после деоптимизации (тело итерации выполнено)
+    enum class Osr { None, Finished, Resumed };
+
+    TranslationUnitNode& program;
+    OutputBuffer& out;
+    InputBuffer& in;
+    // Раньше всех значений: агрегаты возвращают байты счётчику при разрушении
+    MemoryMeter memory;
+    MemoryMeter* meter = nullptr; // &memory, если память ограничена
+    int maxDepth = kMaxCallDepth;
+    const ConstantPool& constants;
+    std::unordered_map<std::string, FuncDeclNode*> functions;
+    std::unordered_map<std::string, const StructType*> structs;
+    std::unordered_map<std::string, Value> globals;
+    // Пул констант: байты списков инициализации из одних литералов (пусто — не константа)
+    std::unordered_map<const InitListNode*, std::vector<unsigned char>> constantLists;
+
+    std::vector<Value>* frame = nullptr;
+    Value result;
+    Value returnValue;
+    Flow flow = Flow::Normal;
+    int depth = 0;
+
+    TierManager* tiers = nullptr;
+    Budget* budget = nullptr;
+    std::unique_ptr<Budget> ownBudget; // бюджет setLimits
+    TierManager::Profile* profile = nullptr; // профиль исполняемой функции
+    bool verify = false;
+    int verifiedCalls = 0;
+    int mismatches = 0;
+    int traceCalls;          // записывать каждый traceCalls-й вызов (Trace); 0 — нет
+    int callsSinceTrace = 0;
+    Profiler* profiler = nullptr;
+    ExecutionCounters* counters = nullptr;
+
+    // Место записи: переменная с тегом или байты в памяти структуры или массива
+    struct Place {
+        Value* value = nullptr;
+        const std::shared_ptr<Aggregate>* memory = nullptr; // владелец лежит в переменной
+        size_t offset = 0;
+        Storage what;
+        Value get() const { return value ? *value : loadRaw(*memory, offset, what); }
+    };
+
+    Value eval(ASTNode& node);
+    void exec(ASTNode& node);
+    Value* lvalue(ASTNode& node);
+    Place place(ASTNode& node);
+    void store(Value* target, const Value& v);
+    void store(const Place& target, const Value& v);
+    Value interpretCall(FuncDeclNode& func, std::vector<Value>& args);
+    // Вызов на текущем уровне функции (без счёта шагов и трассировки)
+    Value dispatch(FuncDeclNode& func, std::vector<Value>& args);
+    Value arithmetic(const std::string& op, const Value& l, const Value& r);
+    Value defaultValue(TypeNode& type);
+    Value declare(TypeNode& type, InitDeclaratorNode& decl);
+    // element(k) — смещение и вид k-го элемента списка
+    void initialize(Aggregate& memory, InitListNode& list,
+                    const std::function<std::pair<size_t, Storage>(size_t)>& element);
+    bool loopFlow();
+    // Выборка профиля; at — цикл, на котором она снята (nullptr — место вызова)
+    void sample(const ASTNode* at);
+    TierManager::LoopProfile* loopProfile(ASTNode& loop) {
+        return profile ? &tiers->loopProfile(*profile->func, loop) : nullptr;
+    }
+    Osr backEdge(TierManager::LoopProfile* loop);
+    Osr enterLoop(TierManager::LoopProfile& loop);
+    bool runVector(const VectorLoop& plan);
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Вывод программы: байты копятся в большом буфере и уходят одним write, когда
+// буфер заполнен, по flush и при разрушении. В построчном режиме (интерактивная
+// работа) буфер сбрасывается после каждой строки. Числа печатаются to_chars
+// прямо в буфер, без промежуточных строк
+class OutputBuffer {
+public:
+    static constexpr size_t kCapacity = 1 << 16;
+
+    explicit OutputBuffer(int fd, bool lineBuffered = false);
+    // Вывод без дескриптора (встраивание): при сбросе накопленные байты
+    // передаются sink; false от sink — вывод больше не принимается
+    explicit OutputBuffer(std::function<bool(std::string_view)> sink);
+    ~OutputBuffer();
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void setLineBuffered(bool on) { lineBuffered = on; }
+    bool isLineBuffered() const { return lineBuffered; }
+    // Предел вывода в байтах (0 — без предела). Проверяется при сбросе буфера:
+    // лишнее отбрасывается, а следующая запись бросает LimitError
+    void setLimit(uint64_t bytes) { limit = bytes; }
+    // Часть вывода отброшена из-за предела
+    bool isTruncated() const { return truncated; }
+
+    void put(char c);
+    void write(std::string_view text);
+    void writeInt(int64_t v);
+    void writeUInt(uint64_t v);
+    // Как printf("%g") и operator<< по умолчанию: 6 значащих цифр
+    void writeDouble(double v);
+    // Конец строки; в построчном режиме — и сброс
+    void endLine();
+    // false — write не удался (например, закрытый канал)
+    bool flush();
+
+private:
+    int fd;
+    std::function<bool(std::string_view)> sink;
+    bool lineBuffered;
+    std::vector<char> buffer;
+    size_t used = 0;
+    uint64_t limit = 0;
+    uint64_t written = 0;
+    bool truncated = false;
+
+    // Место под n байт в конце буфера
+    char* reserve(size_t n);
+    // Отдаёт байты дескриптору или sink с учётом предела
+    bool send(const char* data, size_t size);
+    void checkLimit();
+};
+
+// Ввод программы: дескриптор читается блоками по kBlock байт, числа разбираются
+// from_chars прямо из буфера. Как и operator>>, пропускает пробельные символы
+// перед значением
+class InputBuffer {
+public:
+    static constexpr size_t kBlock = 1 << 16;
+
+    explicit InputBuffer(int fd);
+    // Ввод из готового текста (встраивание)
+    explicit InputBuffer(std::string_view text);
+    // Ввод без дескриптора: source дописывает до size байт и возвращает их число, 0 — конец
+    explicit InputBuffer(std::function<size_t(char*, size_t)> source);
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+
+    // false — конец ввода или не число
+    bool readInt(long long& v);
+    bool readDouble(double& v);
+    // Первый непробельный символ
+    bool readChar(char& c);
+
+private:
+    int fd;
+    std::function<size_t(char*, size_t)> source;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t end = 0;
+    bool eof = false;
+
+    // Дочитывает следующий блок, сдвигая непрочитанный хвост в начало
+    bool fill();
+    bool skipSpace();
+    // Длина слова с позиции pos; слово целиком оказывается в буфере
+    size_t word();
+};
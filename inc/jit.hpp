@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ast.hpp"
+#include "bytecode.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Шаблонный JIT для x86-64: байт-код функции переводится в машинный код склейкой
+// готовых шаблонов на каждую инструкцию. Код размещается в памяти из mmap,
+// которая после записи становится только исполняемой.
+//
+// Соглашение вызова сгенерированного кода: rdi указывает на аргументы, лежащие
+// в обратном порядке (последний аргумент по младшему адресу), результат в rax.
+// Стек вычислений — машинный стек, локальные переменные — слоты [rbp - 16 - 8*slot].
+// Деление на ноль, переполнение при делении и слишком глубокая рекурсия приводят
+// к выходу через общий обработчик: invoke возвращает nullopt, и вызов повторяется
+// интерпретатором. Компилируются только чистые функции над int, так что повтор безопасен.
+// compile можно вызывать из фонового потока, пока другой поток исполняет уже готовый код;
+// сам машинный код исполняется одним потоком за раз.
+class Jit {
+public:
+    static constexpr int kMaxDepth = 2000;
+
+    explicit Jit(TranslationUnitNode& program);
+    ~Jit();
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    // Компилирует функцию вместе со всеми, кого она вызывает; false — не поддерживается
+    bool compile(FuncDeclNode& func);
+    bool isCompiled(const FuncDeclNode& func) const;
+    std::optional<int64_t> invoke(const FuncDeclNode& func, const std::vector<int64_t>& args);
+
+    static bool isSupported();
+    void printReport(std::ostream& out) const;
+
+private:
+    // Ячейка с адресом кода: вызовы идут через неё, поэтому рекурсия
+    // и взаимная рекурсия не требуют исправления адресов
+    struct Compiled {
+        void* code = nullptr;
+        size_t size = 0;
+        BytecodeFunction bytecode;
+    };
+    struct Region {
+        void* base;
+        size_t size;
+    };
+
+    std::unordered_map<std::string, FuncDeclNode*> functions;
+    const ConstantPool& constants;
+    std::unordered_map<std::string, std::unique_ptr<Compiled>> compiled;
+    std::unordered_map<std::string, std::string> rejected;
+    std::vector<Region> regions;
+    mutable std::mutex lock; // таблицы выше
+
+    using Entry = int64_t (*)(void* code, const int64_t* args);
+    Entry entry = nullptr;
+    // Состояние, к которому обращается машинный код по абсолютным адресам
+    uint64_t savedStack = 0;
+    uint64_t depth = 0;
+    uint8_t bailed = 0;
+
+    void* install(const std::vector<uint8_t>& code);
+    void emitEntry();
+    std::vector<uint8_t> translate(const BytecodeFunction& func);
+};
@@ -1,19 +1,32 @@
 #pragma once
 #include "token.hpp"
 
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <vector>
 #include <unordered_map>
 
+// Лексическая ошибка; внутри лексера, наружу она попадает через getErrors
+class LexerError : public std::runtime_error {
+public:
+    explicit LexerError(const std::string& message) : std::runtime_error(message) {}
+};
+
 class Lexer {
 public:
     Lexer(const std::string&);
 
+    // После ошибки разбор останавливается: токены до неё и END
     std::vector<Token> tokenize();
+    bool hasErrors() const { return !errors.empty(); }
+    const std::vector<std::string>& getErrors() const { return errors; }
 private:
     std::string input;
     std::size_t index = 0;
+    std::vector<std::string> errors;
+
+    // Таблицы только для чтения, общие для всех лексеров
 
     static const std::string metachars;
     static const std::unordered_map<std::string, TokenType> operators;
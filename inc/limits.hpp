@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+class RuntimeError : public std::runtime_error {
+public:
+    explicit RuntimeError(const std::string& message)
+        : std::runtime_error("Runtime Error: " + message) {}
+};
+
+// Общий предел глубины вызовов: его выдерживает стек потока и волокна
+constexpr int kMaxCallDepth = 2000;
+
+// Предел исполнения, который превысила программа
+enum class Limit : uint8_t { Steps, Time, Depth, Memory, Output };
+
+const char* limitName(Limit limit);
+
+// Превышен предел: исполнение прерывается, как при ошибке, но причина известна
+class LimitError : public RuntimeError {
+public:
+    LimitError(Limit limit, const std::string& message) : RuntimeError(message), limit(limit) {}
+    Limit limit;
+};
+
+// Пределы одного исполнения; 0 — без предела. Шаги и время проверяются
+// на границах квантов Budget (обратные переходы и вызовы), глубина — при
+// вызове, память — при создании структуры или массива, вывод — при сбросе
+// буфера вывода, поэтому без пределов исполнение ничего не проверяет
+struct ExecutionLimits {
+    uint64_t steps = 0;    // шагов Budget
+    double seconds = 0;    // астрономическое время с начала исполнения
+    int callDepth = 0;     // глубина вызовов (не больше kMaxCallDepth)
+    uint64_t memory = 0;   // байтов в живых структурах и массивах
+    uint64_t output = 0;   // байтов вывода
+
+    // Пределы, которые машинный код JIT соблюдать не умеет
+    bool needsInterpreter() const { return steps || seconds > 0 || callDepth; }
+};
+
+// Живые байты структур и массивов одного исполнения. Агрегат запоминает
+// счётчик и при разрушении возвращает свои байты
+struct MemoryMeter {
+    uint64_t used = 0;
+    uint64_t peak = 0;
+    uint64_t limit = 0;
+
+    // Перед выделением: превышение предела — LimitError, память не выделяется
+    void allocate(size_t bytes);
+    void release(size_t bytes) { used -= bytes; }
+};
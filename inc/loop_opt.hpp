@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ast.hpp"
+#include "type.hpp"
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Что оптимизатор узнал и сделал с одним циклом
+struct LoopReport {
+    std::string function;
+    std::string kind;                      // for / while / do-while
+    int depth = 1;                         // глубина вложенности
+    std::string induction;                 // описание индуктивной переменной
+    std::optional<long long> trip_count;
+    std::vector<std::string> applied;
+};
+
+// Оптимизации циклов над проверенным AST: поиск индуктивных переменных,
+// снятие проверок границ, вынос инвариантов, снижение стоимости индексной
+// арифметики, векторизация поэлементных циклов и сумм, раскрутка.
+// Циклы AST структурны, поэтому каждый из них — естественный цикл
+// с заголовком в условии и обратной дугой из конца тела.
+class LoopOptimizer {
+public:
+    void optimize(ASTNode& root);
+    const std::vector<LoopReport>& getReports() const { return reports; }
+    void printReport(std::ostream& out) const;
+
+    static constexpr long long kFullUnrollMaxTrips = 16;
+    static constexpr size_t kFullUnrollMaxNodes = 256;    // суммарный размер раскрученного тела
+    static constexpr long long kPartialUnrollFactor = 4;
+    static constexpr size_t kPartialUnrollMaxBody = 48;
+
+private:
+    struct InductionVar {
+        std::string name;
+        long long step = 0;
+        std::optional<long long> start;
+        std::unique_ptr<ASTNode>* startExpr = nullptr; // инициализатор, если он не константа
+        bool declaredInInit = false;
+        std::optional<long long> trip_count;
+        IdentifierExprNode* counter = nullptr; // счётчик в условии
+        ASTNode* bound = nullptr;              // граница в условии
+        std::string op;                        // сравнение счётчика с границей
+    };
+
+    std::vector<LoopReport> reports;
+    std::string currentFunction;
+    int depth = 0;
+    int tempCounter = 0;
+
+    void optimizeSlot(std::unique_ptr<ASTNode>& slot);
+    void optimizeLoop(std::unique_ptr<ASTNode>& slot, LoopReport& report);
+
+    std::optional<InductionVar> findInductionVar(ForLoopNode& loop);
+    std::optional<std::pair<std::string, long long>> matchStep(ASTNode& expr);
+    std::optional<InductionVar> findTrailingIncrement(ASTNode& body, ASTNode& condition);
+
+    void hoistInvariants(std::unique_ptr<ASTNode>& slot, const std::unordered_set<std::string>& variant,
+                         std::vector<std::unique_ptr<ASTNode>>& prelude,
+                         std::unordered_map<std::string, std::string>& hoisted, LoopReport& report);
+    bool isHoistable(ASTNode& expr, const std::unordered_set<std::string>& variant);
+
+    void eliminateBoundsChecks(ForLoopNode& loop, const InductionVar& iv, LoopReport& report);
+    bool vectorize(ForLoopNode& loop, const InductionVar& iv, const std::unordered_set<std::string>& variant,
+                   LoopReport& report);
+
+    void strengthReduce(ForLoopNode& loop, const InductionVar& iv, const std::unordered_set<std::string>& variant,
+                        std::vector<std::unique_ptr<ASTNode>>& prelude, LoopReport& report);
+
+    std::unique_ptr<ASTNode> unrollFully(ForLoopNode& loop, const InductionVar& iv);
+    std::unique_ptr<ASTNode> unrollPartially(std::unique_ptr<ASTNode> loop, const InductionVar& iv);
+
+    std::string newTemp(const std::string& prefix);
+};
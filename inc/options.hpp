@@ -0,0 +1,47 @@
+#pragma once
+
+#include "limits.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Параметры командной строки
+struct Options {
+    std::string input;          // путь к исходному файлу
+    bool optimize = false;      // -O: оптимизации над проверенным AST
+    bool run = false;           // --run: исполнить программу вместо печати AST
+    bool jit = false;           // --jit: компилировать горячие функции в машинный код
+    bool jit_verify = false;    // --jit-verify: сверять результаты JIT с интерпретатором
+    bool tier = true;           // --no-tier: исполнять всё интерпретатором по дереву
+    int tier_calls = 100;       // --tier-calls=N (--jit-threshold=N): вызовов до компиляции
+    int tier_loops = 10000;     // --tier-loops=N: обратных переходов циклов до компиляции
+    bool tier_log = false;      // --tier-log: печатать повышения уровня и отчёт
+    bool line_buffered = false; // --line-buffered: сбрасывать вывод программы после каждой строки
+    std::string emit_c;         // --emit-c=FILE: записать программу на C
+    std::string native;         // --native=FILE: собрать исполняемый файл компилятором C
+    std::string emit_image;     // --emit-image=FILE: записать образ программы (.ibc)
+    bool cache = true;          // --no-cache: не использовать кэш результатов front-end
+    std::string cache_dir;      // --cache-dir=DIR: каталог кэша вместо каталога по умолчанию
+    int cache_size = 64;        // --cache-size=MB: предел размера кэша
+    bool batch = false;         // --batch: проверить все файлы (лексер, парсер, анализ) параллельно
+    std::string files_from;     // --files-from=FILE: список файлов для --batch ("-" — stdin)
+    int jobs = 0;               // --jobs=N: потоков для --batch, 0 — по числу процессоров
+    std::vector<std::string> inputs; // все файлы из командной строки (для --batch)
+    std::string serve;          // --serve=SOCKET: постоянный сервер исполнения (потоков — --jobs)
+    int quantum = 10000;        // --quantum=N: шагов исполнения до уступки потока в --serve
+    std::string connect;        // --connect=SOCKET: исполнить файл на сервере, как --run
+    // --max-steps=N, --max-time=SEC, --max-depth=N, --max-memory=BYTES, --max-output=BYTES:
+    // пределы исполнения; для --serve — верхние границы пределов клиентов
+    ExecutionLimits limits;
+    std::string trace;          // --trace=FILE: события Chrome trace (этапы, задачи --batch, исполнение)
+    int trace_calls = 0;        // --trace-calls=N: записывать каждый N-й вызов функции программы
+    std::string profile;        // --profile[=time|steps]: выборочный профиль исполнения в stderr
+    int64_t profile_period = 0; // --profile-period=N: мкс процессорного времени (time, 1000) или шагов (steps, 10000)
+    std::string profile_out;    // --profile-out=FILE: свёрнутые стеки профиля для flamegraph
+    bool counters = false;      // --counters: счётчики исполнения узлов (и инструкций, make COUNTERS=1) в stderr
+    std::string annotate;       // --annotate=FILE: исходный текст со счётом исполнений строк (как gcov), без байт-кода
+    std::string time_report;    // --time-report[=json]: время и память по фазам в stderr ("text" или "json")
+};
+
+// Возвращает false, если аргументы не удалось разобрать
+bool parseOptions(int argc, char* argv[], Options& opts);
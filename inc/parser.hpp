@@ -5,12 +5,17 @@
 #include <vector>
 #include <memory>
 #include <initializer_list>
+#include <string>
+#include <unordered_set>
 
 class Parser {
 public:
     Parser(const std::vector<Token>& tokens);
     
     std::unique_ptr<ASTNode> parse();
+    // Синтаксические ошибки; после ошибки разбор продолжается со следующего оператора
+    bool hasErrors() const { return hadError; }
+    const std::vector<std::string>& getErrors() const { return errors; }
 
 private:
     // === Вспомогательные методы для навигации по токенам ===
@@ -40,7 +45,8 @@ private:
     
     // === Операторы (Statements) ===
     std::unique_ptr<ASTNode> parseAssignment();
-    std::unique_ptr<ASTNode> parseStatement();
+    std::unique_ptr<ASTNode> parseStatement(); // с номером строки
+    std::unique_ptr<ASTNode> parseStatementBody();
     std::unique_ptr<ASTNode> parseExpressionStatement();
     std::unique_ptr<ASTNode> parseBlockStatement();
     std::unique_ptr<ASTNode> parseIfStatement();
@@ -75,6 +81,8 @@ private:
     std::vector<Token> tokens;
     size_t current = 0;
     bool hadError = false;
+    std::vector<std::string> errors;
+    std::unordered_set<std::string> knownTypes; // встроенные типы и объявленные структуры
 };
 
 
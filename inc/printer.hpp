@@ -5,6 +5,7 @@
 
 class PrintVisitor : public Visitor {
 public:
+    explicit PrintVisitor(std::ostream& out = std::cout) : out(out) {}
     int indent_level = 0;
     void indent() const ;
     void print(class ASTNode&);
@@ -54,6 +55,8 @@ private:
     // Вспомогательные методы для печати или форматирования
     void printIndentation(int level);
     void printNodeName(const std::string& name);
+
+    std::ostream& out;
 };
 
 
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Выборочный профиль исполняемой программы. Выборки снимаются там, где
+// исполнители считают шаги бюджета (обратные переходы циклов и вызовы, см. Budget):
+// в режиме Steps — каждые period шагов, в режиме Timer — на первой границе кванта
+// после сигнала SIGPROF (таймер процессорного времени, period микросекунд);
+// выборка получает вес — число сигналов с прошлой. Поэтому время без шагов
+// (ввод, векторные циклы) достаётся следующему шагу. Машинный код JIT шагов
+// не считает: с профилем он не используется.
+// Выборка — стек кадров (функция, строка): у внутреннего кадра строка цикла
+// или вызова, на котором снята выборка, у остальных — места вызова
+class Profiler {
+public:
+    enum class Mode { Timer, Steps };
+
+    struct Frame {
+        const std::string* function;
+        int line;
+        bool operator<(const Frame& other) const {
+            return function != other.function ? function < other.function : line < other.line;
+        }
+    };
+
+    // Кадр исполнителя по дереву на время вызова; profiler == nullptr — ничего
+    class Call {
+    public:
+        Call(Profiler* profiler, const std::string& function, int line) : profiler(profiler) {
+            if (profiler) profiler->frames.push_back({&function, line});
+        }
+        ~Call() {
+            if (profiler) profiler->frames.pop_back();
+        }
+        Call(const Call&) = delete;
+        Call& operator=(const Call&) = delete;
+
+    private:
+        Profiler* profiler;
+    };
+
+    // Квант бюджета в режиме Timer: столько шагов между проверками сигнала
+    static constexpr int64_t kTimerQuantum = 256;
+
+    Profiler(Mode mode, int64_t period);
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Таймер работает только между start и stop, один профиль на процесс
+    void start();
+    void stop();
+
+    // Квант бюджета исполнителя
+    int64_t getQuantum() const { return mode == Mode::Steps ? period : kTimerQuantum; }
+    // На границе кванта: true — снять выборку
+    bool due();
+    // Выборка: кадры исполнителя по дереву; если inner не пуст, последний из них
+    // заменяется кадрами байт-кода inner (от внешнего к внутреннему)
+    void sample(const std::vector<Frame>& inner = {});
+
+    // Кадры исполнителя по дереву; строку верхнего кадра исполнитель обновляет
+    // перед выборкой и вызовом
+    std::vector<Frame> frames;
+
+    uint64_t getSamples() const { return samples; }
+    // Плоский профиль: функции (собственные и полные выборки) и горячие строки
+    void printFlat(std::ostream& out) const;
+    // Свёрнутые стеки для flamegraph.pl и совместимых: "main:3;fib:7 42"
+    void printFolded(std::ostream& out) const;
+
+private:
+    Mode mode;
+    int64_t period;
+    uint64_t weight = 0; // вес следующей выборки
+    uint64_t samples = 0;
+    bool running = false;
+    std::map<std::vector<Frame>, uint64_t> stacks;
+
+    // Стеки с именами функций вместо указателей: одна функция приходит из разных
+    // исполнителей (дерево, байт-код, цикл OSR) под разными строками имени
+    std::map<std::vector<std::pair<std::string, int>>, uint64_t> resolve() const;
+};
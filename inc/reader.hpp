@@ -6,3 +6,4 @@
 #define CHAR_BUFF 100  
 
 std::string readfile(int argc, char* argv[]);
+std::string readfile(const std::string& filename);
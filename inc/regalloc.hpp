@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ast.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Итог распределения для одной функции
+struct FrameLayout {
+    std::string function;
+    int slot_count = 0;        // выбранный размер кадра
+    int variable_count = 0;    // сколько слотов понадобилось бы без переиспользования
+};
+
+// Анализ живости и линейное сканирование: каждой локальной переменной назначается
+// слот кадра (регистр машины), слоты освобождаются, как только переменная умирает.
+// Параметры всегда занимают слоты 0..n-1 в порядке объявления.
+// Результат записывается в DeclaratorNode::slot, IdentifierExprNode::slot и FuncDeclNode::frame_size.
+class FrameAllocator {
+public:
+    void run(ASTNode& root);
+    FrameLayout allocate(FuncDeclNode& func);
+    const std::vector<FrameLayout>& getLayouts() const { return layouts; }
+    void printReport(std::ostream& out) const;
+
+private:
+    // Интервал жизни: от определения до последнего обращения
+    struct Interval {
+        DeclaratorNode* decl = nullptr;
+        int start = 0;
+        int end = 0;
+        int slot = -1;
+        std::vector<IdentifierExprNode*> refs;
+    };
+    struct LoopRange {
+        int start;
+        int end;
+    };
+
+    std::vector<FrameLayout> layouts;
+    std::vector<Interval> intervals;
+    std::vector<LoopRange> loops;
+    std::vector<std::vector<std::pair<std::string, size_t>>> scopes;
+    int position = 0;
+
+    void scan(ASTNode& node);
+    void declare(DeclaratorNode& decl);
+    void use(IdentifierExprNode& id);
+};
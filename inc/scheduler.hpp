@@ -0,0 +1,61 @@
+#pragma once
+
+#include "budget.hpp"
+#include "fiber.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Планировщик волокон: много задач на нескольких потоках. У каждого потока
+// своя очередь готовых волокон; поток берёт волокна с её начала, а уступившее
+// (Fiber::yield) ставит в конец, поэтому свои волокна идут по кругу. Когда
+// очередь пуста, поток крадёт с конца чужой, а если пусто везде — засыпает.
+// Волокно не вытесняется силой: исполнение само уступает поток, когда
+// израсходован квант шагов (Budget, см. quantum)
+class FiberScheduler {
+public:
+    static constexpr int64_t kDefaultQuantum = Budget::kDefaultQuantum;
+
+    // threads == 0 — по числу процессоров
+    explicit FiberScheduler(unsigned threads, int64_t quantum = kDefaultQuantum);
+    // Дожидается всех волокон
+    ~FiberScheduler();
+
+    // Тело исполняется в новом волокне; исключение из тела завершает процесс
+    void spawn(std::function<void()> body);
+    // Ждёт, пока не завершатся все запущенные волокна
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(threads.size()); }
+    int64_t getQuantum() const { return quantum; }
+    // Планировщик, волокно которого исполняет этот поток; nullptr — вне планировщика
+    static FiberScheduler* current();
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::unique_ptr<Fiber>> fibers;
+    };
+
+    void work(unsigned self);
+    void push(unsigned worker, std::unique_ptr<Fiber> fiber);
+    std::unique_ptr<Fiber> take(unsigned self);
+
+    int64_t quantum;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};  // волокон в очередях
+    std::atomic<unsigned> sleeping{0};
+    std::atomic<unsigned> nextWorker{0};
+    std::mutex mutex;
+    std::condition_variable wake;   // появилось волокно или пора завершаться
+    std::condition_variable idle;   // завершились все волокна
+    size_t live = 0;                // запущено и не завершилось, под mutex
+    bool stopping = false;
+};
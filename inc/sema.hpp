@@ -28,6 +28,7 @@ public:
 
 class SemanticAnalyzer : public Visitor {
 public:
+    // Ошибки не выбрасываются наружу: они в getErrors
     void analyze(ASTNode& root); // check
     void visit( TranslationUnitNode& node) override;// check
     void visit( TypeNode& node) override;
@@ -70,6 +71,12 @@ public:
     void visit( ScopedIdentifierExprNode& node) override;
     bool hasErrors() const { return !errors.empty(); }
     const std::vector<std::string>& getErrors() const { return errors; }
+    // Счётчики для --time-report: созданные области видимости, объявленные
+    // переменные и параметры, сигнатуры функций, структуры
+    size_t getScopeCount() const { return scopes; }
+    size_t getSymbolCount() const { return symbols; }
+    size_t getFunctionCount() const { return functionTable.size(); }
+    size_t getTypeCount() const { return typeTable.size(); }
     template<typename T>
     void safeVisit(std::unique_ptr<T>& node) {
     if (!node) return;
@@ -86,9 +93,12 @@ private:
     std::unordered_map<std::string, FunctionSignature> functionTable;
     std::unordered_map<std::string, std::shared_ptr<Type>> typeTable;
     std::vector<std::shared_ptr<Type>> expectedReturnTypes;
+    size_t scopes = 0;
+    size_t symbols = 0;
 
     void enterScope() {
         currentScope = std::make_shared<Scope>(currentScope);
+        ++scopes;
     }
 
     void exitScope() {
@@ -96,7 +106,9 @@ private:
     }
 
     bool declareVariable(const std::string& name, const std::shared_ptr<Type>& type) {
-        return currentScope && currentScope->declare(name, type);
+        if (!currentScope || !currentScope->declare(name, type)) return false;
+        ++symbols;
+        return true;
     }
 
     std::optional<std::shared_ptr<Type>> lookupVariable(const std::string& name) const {
@@ -113,5 +125,14 @@ private:
         return result;
     }
     std::shared_ptr<Type> getType(ASTNode& expr);
+    std::shared_ptr<Type> inferType(ASTNode& expr);
+    // Оператор тела; выражение-оператор тоже получает тип: его используют исполнители
+    void statement(ASTNode& stmt);
+    // Размер и выравнивание значения типа в памяти; false — тип не раскладывается
+    bool storageOf(const std::string& typeName, bool isUnsigned, Storage& storage, size_t& align) const;
+    int64_t sizeOf(ASTNode& operand);
+    // Тип объявленной переменной: для int a[N] — ArrayType с длиной, свёрнутой из N
+    std::shared_ptr<Type> declaredType(const std::shared_ptr<Type>& base, DeclaratorNode& declarator);
+    void checkInitList(InitListNode& list, const std::shared_ptr<Type>& type, const std::string& name);
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "limits.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Постоянный процесс (--serve=SOCKET): принимает запросы «скомпилировать
+// и исполнить» через Unix-сокет, держит кэш готовых программ (interpret::Program)
+// и пул рабочих потоков, на которых соединения исполняются волокнами
+// (interpret::Scheduler): долгая программа уступает поток после кванта шагов,
+// поэтому бесконечный цикл не задерживает остальные запросы. Клиент
+// (--connect=SOCKET) — тот же исполняемый файл: он заменяет `main --run файл`
+// без запуска нового процесса интерпретатора.
+//
+// Протокол: кадры [тип u8][длина u32][данные], порядок байтов машины (сокет
+// локальный). Запрос: Hash (ключ CompileCache::key), Flags, Run. Если программы
+// с таким ключом нет в кэше, сервер отвечает NeedSource, и клиент досылает
+// Source. Ответ: кадры Output и Diagnostics по мере появления, в конце Exit
+// (код завершения, i32). Когда программе нужен ввод, сервер шлёт NeedInput
+// (не больше u32 байт), клиент отвечает Input с очередным куском своего stdin;
+// пустой Input — конец ввода. Поэтому ввод читается только по мере надобности,
+// как при обычном --run. Необязательный кадр Limits в запросе задаёт пределы
+// исполнения (шаги u64, секунды f64, глубина i32, память u64, вывод u64);
+// пределы сервера — верхние границы для них. Exit несёт и причину завершения
+// (u8, interpret::Termination). Одно соединение — один запрос
+enum class Message : uint8_t {
+    Source = 1,
+    Hash,
+    Flags,
+    Input,
+    Run,
+    NeedSource,
+    NeedInput,
+    Output,
+    Diagnostics,
+    Exit,
+    Limits,
+};
+
+// Биты кадра Flags
+constexpr uint32_t kServeOptimize = 1;
+
+// Предел длины одного кадра: больше — ошибка протокола
+constexpr uint32_t kMaxMessage = 64u << 20;
+
+bool sendMessage(int fd, Message type, std::string_view payload);
+// false — соединение закрыто или кадр некорректен
+bool readMessage(int fd, Message& type, std::string& payload);
+
+// workers == 0 — по числу процессоров; quantum — шагов исполнения до уступки
+// потока; caps — пределы каждого исполнения. Возвращает код завершения процесса
+int serve(const std::string& socketPath, unsigned workers, int64_t quantum, const ExecutionLimits& caps);
+
+// Отправляет файл и весь stdin серверу, печатает ответ;
+// возвращает код завершения программы
+int runClient(const std::string& socketPath, const std::string& file, bool optimize, const ExecutionLimits& limits);
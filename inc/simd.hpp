@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ast.hpp"
+#include "value.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Операция векторного ядра; Copy — только первый операнд
+enum class VectorOp : uint8_t { Copy, Add, Sub, Mul, Div };
+
+// Операнд ядра: массив (элемент k лежит в data + k * размер) или одно значение для всех k
+struct VectorOperand {
+    const unsigned char* data = nullptr;
+    bool scalar = false;
+};
+
+// Цикл вида for (i = s; i < n; i++) a[i] = x op y или sum += x op y, где x и y —
+// элементы массивов с индексом i или инварианты цикла. Все обращения к массивам
+// идут по одному индексу i, поэтому зависимостей между итерациями нет.
+// Назначается LoopOptimizer; узлы указывают в тело цикла, поэтому копия цикла
+// (AstCloner) план не получает и исполняется как обычно
+struct VectorLoop {
+    enum class Shape { Map, Sum };
+    Shape shape = Shape::Map;
+    VectorOp op = VectorOp::Copy;
+    Value::Kind kind = Value::Kind::Int;
+    IdentifierExprNode* counter = nullptr;
+    ASTNode* bound = nullptr;
+    bool inclusive = false;    // i <= bound
+    ASTNode* target = nullptr; // Map: массив-приёмник, Sum: переменная суммы
+    ASTNode* x = nullptr;      // массив, если xArray, иначе выражение-инвариант
+    ASTNode* y = nullptr;
+    bool xArray = false;
+    bool yArray = false;
+};
+
+// dst[k] = x[k] op y[k] для k < n. Целые складываются и умножаются по модулю,
+// вещественные — как скалярный код (одинарная точность округляется на каждом шаге)
+void vectorMap(VectorOp op, Value::Kind kind, unsigned char* dst, VectorOperand x, VectorOperand y, size_t n);
+
+// Сумма x[k] op y[k] для k < n по модулю 2^64; только целые виды, иначе порядок
+// сложения менял бы результат
+int64_t vectorSum(VectorOp op, Value::Kind kind, VectorOperand x, VectorOperand y, size_t n);
+
+// Набор команд, которым работают ядра на этой машине: "avx2" или "sse2"
+const char* vectorIsa();
+
+// Виды элементов, для которых есть ядра
+bool vectorKind(Value::Kind kind);
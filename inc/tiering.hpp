@@ -0,0 +1,162 @@
+#pragma once
+
+#include "ast.hpp"
+#include "bytecode.hpp"
+#include "vm.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Jit;
+
+// Уровень исполнения функции
+enum class Tier : uint8_t { Tree, Bytecode, Native };
+
+struct TierOptions {
+    int callThreshold = 100;    // вызовов до компиляции
+    int loopThreshold = 10000;  // обратных переходов циклов до компиляции
+    bool log = false;           // печатать повышения уровня в stderr
+    bool background = true;     // false — компилировать в потоке исполнения, без фонового потока
+};
+
+// Многоуровневое исполнение. Все функции начинают в интерпретаторе по дереву,
+// который считает вызовы и обратные переходы циклов. Функция, перешедшая порог,
+// компилируется в фоновом потоке в оптимизированный байт-код (и машинный код,
+// если подключён JIT) вместе со всеми, кого она вызывает. Готовый код подменяет
+// интерпретатор при следующем вызове: poll забирает результаты фонового потока.
+// Циклы считаются и по отдельности: горячий цикл переводится в байт-код сам по себе,
+// и исполняемый кадр переходит в него посреди цикла (замена на стеке, OSR).
+// Профили и подмена кода — только в потоке интерпретатора.
+class TierManager {
+public:
+    struct Profile {
+        FuncDeclNode* func = nullptr;
+        int calls = 0;
+        int backEdges = 0;
+        Tier tier = Tier::Tree;
+        bool queued = false;
+        const BytecodeFunction* code = nullptr;
+    };
+
+    // Цикл для замены на стеке
+    struct LoopProfile {
+        FuncDeclNode* func = nullptr;
+        ASTNode* loop = nullptr;
+        int backEdges = 0;
+        bool queued = false;
+        const BytecodeFunction* code = nullptr;
+        std::vector<int> stores;  // слоты, которые код цикла изменяет
+        int entries = 0;
+        int deopts = 0;
+        uint64_t iterations = 0;  // обратные переходы в байт-коде
+        bool discarded = false;
+    };
+
+    // Деоптимизаций, после которых частый возврат в интерпретатор отменяет OSR
+    static constexpr int kDeoptLimit = 16;
+
+    TierManager(TranslationUnitNode& program, Jit* jit, TierOptions options);
+    ~TierManager();
+    TierManager(const TierManager&) = delete;
+    TierManager& operator=(const TierManager&) = delete;
+
+    Profile& profile(FuncDeclNode& func) { return profiles[&func]; }
+
+    // Байт-код, скомпилированный заранее (из образа программы): горячая функция
+    // получает его без компиляции. Вызывать до начала исполнения
+    void preload(std::vector<std::unique_ptr<BytecodeFunction>> code);
+
+    void countCall(Profile& p) {
+        if (++p.calls >= options.callThreshold) promote(p);
+    }
+    void countBackEdge(Profile& p) {
+        if (++p.backEdges >= options.loopThreshold) promote(p);
+    }
+
+    LoopProfile& loopProfile(FuncDeclNode& func, ASTNode& loop);
+
+    // Обратный переход цикла; true — готов код для замены на стеке
+    bool countLoop(LoopProfile& lp) {
+        if (lp.code) return true;
+        if (lp.queued) {
+            poll();
+            return lp.code != nullptr;
+        }
+        if (++lp.backEdges >= options.loopThreshold) promoteLoop(lp);
+        return false;
+    }
+
+    // Подменяет код функций, скомпилированных в фоне с прошлого опроса
+    void poll() {
+        if (ready.load(std::memory_order_acquire)) install();
+    }
+
+    // Аргументы уже приведены к типам параметров; результат — вида типа функции
+    Value runBytecode(const Profile& p, const std::vector<Value>& args, int depth);
+    std::optional<int64_t> runNative(const Profile& p, const std::vector<int64_t>& args);
+    BytecodeVM::LoopExit runLoop(LoopProfile& lp, std::vector<Slot>& slots, int depth);
+
+    void printReport(std::ostream& out) const;
+    // Бюджет шагов для байт-кода (см. BytecodeVM::setBudget)
+    void setBudget(Budget* budget) { vm.setBudget(budget); }
+    void setMaxDepth(int depth) { vm.setMaxDepth(depth); }
+    void setProfiler(Profiler* profiler) { vm.setProfiler(profiler); }
+    void setCounters(ExecutionCounters* counters) { vm.setCounters(counters); }
+
+private:
+    // Задание фоновому потоку: функция или её цикл
+    struct Job {
+        FuncDeclNode* func;
+        ASTNode* loop = nullptr;
+    };
+    // Результат фоновой компиляции вместе со всеми вызываемыми функциями
+    struct Result {
+        FuncDeclNode* func;
+        ASTNode* loop = nullptr;
+        std::unique_ptr<BytecodeFunction> loopCode;
+        std::vector<std::pair<FuncDeclNode*, const BytecodeFunction*>> group;
+        bool native = false;
+        std::string error;
+    };
+
+    TierOptions options;
+    Jit* jit;
+    const ConstantPool& constants;
+    std::unordered_map<std::string, FuncDeclNode*> functions;
+    std::unordered_map<FuncDeclNode*, Profile> profiles;
+    std::unordered_map<ASTNode*, LoopProfile> loops;
+    std::vector<std::unique_ptr<BytecodeFunction>> loopCode;
+    std::unordered_map<std::string, std::string> rejected;
+    BytecodeVM vm;
+
+    // Принадлежит фоновому потоку; функции не изменяются после публикации
+    std::unordered_map<std::string, std::unique_ptr<BytecodeFunction>> bytecode;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> queue;
+    std::vector<Result> finished;
+    std::atomic<bool> ready{false};
+    bool stopping = false;
+    std::thread worker;
+
+    void promote(Profile& p);
+    void promoteLoop(LoopProfile& lp);
+    void submit(Job job);
+    void install();
+    void installLoop(Result& r);
+    void work();
+    Result compile(const Job& job);
+    bool compileGroup(std::vector<std::string> pending, Result& r);
+};
+
+const char* tierName(Tier tier);
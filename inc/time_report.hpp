@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Замеры одного запуска (--time-report). Для каждой фазы — астрономическое
+// и процессорное время процесса (вместе с фоновой компиляцией), изменение
+// занятой кучи (mallinfo2 после фазы минус до неё) и пиковый RSS после фазы.
+// Фазу отмечает Phase на время своей жизни; при выключенном отчёте (nullptr)
+// Phase ничего не замеряет, поэтому без --time-report затрат нет
+class TimeReport {
+public:
+    class Phase {
+    public:
+        Phase(TimeReport* report, const char* name);
+        ~Phase();
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+    private:
+        TimeReport* report;
+        const char* name;
+        std::chrono::steady_clock::time_point wall;
+        double cpu = 0;
+        int64_t heap = 0;
+    };
+
+    explicit TimeReport(std::string file);
+
+    // Счётчик (токены, узлы и т. п.) в порядке добавления; повтор имени заменяет значение
+    void count(const std::string& name, uint64_t value);
+
+    void print(std::ostream& out) const;
+    void printJson(std::ostream& out) const;
+
+private:
+    struct Measure {
+        std::string name;
+        double wall = 0;  // мс
+        double cpu = 0;   // мс
+        int64_t heap = 0; // байт
+        long peakRss = 0; // КБ
+        int calls = 0;
+    };
+
+    // Повторная фаза с тем же именем складывается с предыдущей
+    void add(const char* name, double wall, double cpu, int64_t heap);
+
+    std::string file;
+    std::chrono::steady_clock::time_point start;
+    double startCpu;
+    std::vector<Measure> phases;
+    std::vector<std::pair<std::string, uint64_t>> counters;
+};
@@ -169,6 +169,7 @@ static std::string tokenTypeToString(TokenType type) {
 struct Token {
     TokenType type;
     std::string value;
+    int line = 0; // строка исходного текста, с 1
     
     Token(TokenType type , std::string value = ""):
     type(type), value(std::move(value)){}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Трассировка в формате Chrome trace events (--trace=FILE): открывается
+// в chrome://tracing и Perfetto. Интервалы — этапы компиляции, задачи
+// пакетной проверки, исполнение, фоновая компиляция уровней и, если задано
+// calls, каждый calls-й вызов функции интерпретируемой программы.
+//
+// У каждого потока свой буфер событий: запись не берёт блокировок, мьютекс
+// нужен только при первом событии потока, чтобы внести буфер в список.
+// finish сливает буферы и пишет файл; к этому моменту потоки, которые
+// писали события, должны завершиться или остановиться. Выключенная
+// трассировка стоит одной проверки флага на интервал
+class Trace {
+public:
+    // Не больше событий вызовов в одном потоке: дальше вызовы не записываются
+    static constexpr size_t kMaxCallEvents = 1 << 20;
+
+    static void start(const std::string& path, int calls);
+    // false — файл не записан
+    static bool finish();
+    static bool isEnabled() { return enabled.load(std::memory_order_acquire); }
+    // Каждый какой вызов записывать; 0 — вызовы не записываются
+    static int getCallSampling() { return callSampling; }
+    // Имя потока в просмотрщике
+    static void nameThread(const std::string& name);
+
+    // Интервал от конструктора до деструктора в буфере текущего потока
+    class Span {
+    public:
+        Span(const char* category, const char* name, std::string detail = {});
+        // Вызов функции программы: считается в пределе kMaxCallEvents
+        Span(const std::string& function);
+        ~Span();
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* category = nullptr; // nullptr — трассировка была выключена
+        std::string name;
+        std::string detail;
+        std::chrono::steady_clock::time_point begin;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+    static int callSampling;
+};
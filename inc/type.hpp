@@ -1,7 +1,11 @@
 #pragma once
 
+#include "value.hpp"
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 
 
@@ -33,9 +37,39 @@ struct BuiltinType : public Type {
     }
 };
 
+// Массив фиксированной длины; элементы лежат подряд. length == 0 — длина
+// неизвестна при проверке: параметр int a[] или размер из переменной
+struct ArrayType : public Type {
+    std::shared_ptr<Type> element;
+    size_t length;
+
+    ArrayType(std::shared_ptr<Type> element, size_t length) : element(std::move(element)), length(length) {}
+
+    bool equals(const Type& other) const override {
+        const auto* o = dynamic_cast<const ArrayType*>(&other);
+        return o && element->equals(*o->element) && (length == o->length || !length || !o->length);
+    }
+
+    std::string toString() const override {
+        return element->toString() + "[" + (length ? std::to_string(length) : "") + "]";
+    }
+};
+
+// Поле в памяти структуры
+struct FieldLayout {
+    std::string name;
+    Storage storage;
+    size_t offset = 0;
+};
+
 struct StructType : public Type {
     std::string name;
     std::unordered_map<std::string, std::shared_ptr<Type>> fields;
+    // Раскладка как у C: поля в порядке объявления, каждое выровнено по своему
+    // выравниванию, размер кратен выравниванию структуры
+    std::vector<FieldLayout> layout;
+    size_t size = 0;
+    size_t align = 1;
 
     StructType(std::string name) : name(std::move(name)) {}
 
@@ -48,6 +82,23 @@ struct StructType : public Type {
         return it != fields.end() ? it->second : nullptr;
     }
 
+    // Добавляет поле в конец раскладки
+    void place(const std::string& fieldName, const Storage& storage, size_t fieldAlign) {
+        size_t offset = (size + fieldAlign - 1) / fieldAlign * fieldAlign;
+        layout.push_back({fieldName, storage, offset});
+        size = offset + storage.size();
+        align = std::max(align, fieldAlign);
+    }
+    // Завершает раскладку: хвостовое выравнивание, как в массиве структур
+    void finishLayout() { size = (size + align - 1) / align * align; }
+
+    const FieldLayout* findField(const std::string& fieldName) const {
+        for (const auto& f : layout) {
+            if (f.name == fieldName) return &f;
+        }
+        return nullptr;
+    }
+
     bool equals(const Type& other) const override {
         auto* o = dynamic_cast<const StructType*>(&other);
         return o && o->name == name;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "limits.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Aggregate;
+struct StructType;
+
+// Значение времени исполнения; вид повторяет статический тип из BuiltinType
+struct Value {
+    enum class Kind : uint8_t {
+        Void, Bool, Char, UChar, Short, UShort, Int, UInt, Long, ULong, Float, Double,
+        String, Struct, Array
+    };
+
+    Kind kind = Kind::Void;
+    Kind element = Kind::Void; // массив: вид элементов
+    uint32_t offset = 0;       // структура и массив: начало в agg->raw
+    union {
+        int64_t i;             // массив скаляров: число элементов
+        double f;
+        const std::string_view* s; // строка из пула констант
+        const StructType* layout; // структура и массив структур
+    };
+    std::shared_ptr<Aggregate> agg; // память структуры или массива
+
+    Value() : i(0) {}
+
+    // Целое приводится к разрядности вида (переполнение — по модулю)
+    static Value integer(Kind kind, int64_t v);
+    static Value floating(Kind kind, double v);
+    static Value string(const std::string_view& text);
+
+    bool isInteger() const { return kind >= Kind::Bool && kind <= Kind::ULong; }
+    bool isFloating() const { return kind == Kind::Float || kind == Kind::Double; }
+    bool isUnsigned() const {
+        return kind == Kind::UChar || kind == Kind::UShort || kind == Kind::UInt || kind == Kind::ULong;
+    }
+    int64_t asInt() const { return isFloating() ? static_cast<int64_t>(f) : i; }
+    double asDouble() const;
+    bool truthy() const { return isFloating() ? f != 0 : i != 0; }
+    // Число элементов массива
+    size_t length() const;
+};
+
+// Что лежит в памяти агрегата по некоторому смещению: скаляр, структура
+// или массив, встроенный в структуру
+struct Storage {
+    Value::Kind kind = Value::Kind::Void;
+    Value::Kind element = Value::Kind::Void; // массив: вид элементов
+    uint32_t count = 0;                      // массив: число элементов
+    const StructType* layout = nullptr;      // структура или элемент-структура
+
+    size_t size() const;
+};
+
+// Память структур и массивов: сырые машинные значения без тегов, разложенные
+// по раскладке StructType (поля) или подряд (элементы массива). Структура
+// внутри структуры и массив внутри структуры лежат в памяти объемлющей
+// структуры, поэтому копирование структуры — одно копирование байтов
+struct Aggregate {
+    std::vector<unsigned char> raw;
+    MemoryMeter* meter = nullptr; // счётчик, которому учтены байты raw
+
+    Aggregate() = default;
+    Aggregate(const Aggregate&) = delete;
+    Aggregate& operator=(const Aggregate&) = delete;
+    ~Aggregate() {
+        if (meter) meter->release(raw.size());
+    }
+
+    static size_t kindSize(Value::Kind kind);
+};
+
+// Чтение по смещению. Структура и массив читаются как ссылка на ту же память
+Value loadRaw(const std::shared_ptr<Aggregate>& agg, size_t offset, const Storage& what);
+// Запись по смещению: скаляр приводится к виду, структура и массив копируются байтами
+void storeRaw(Aggregate& agg, size_t offset, const Storage& what, const Value& v);
+// Новая структура или массив из нулевых байтов; память учитывается в meter
+Value makeStruct(const StructType* layout, MemoryMeter* meter = nullptr);
+Value makeArray(const Storage& element, size_t count, MemoryMeter* meter = nullptr);
+
+// Вид значения по имени встроенного типа; Void для неизвестных имён
+Value::Kind kindOf(const std::string& typeName, bool isUnsigned = false);
+// Приведение числового значения к другому виду, как при неявном преобразовании в C
+Value convertTo(const Value& v, Value::Kind kind);
+// Структура копируется целиком, массив разделяется
+Value copyValue(const Value& v, MemoryMeter* meter = nullptr);
+// Текстовое представление для print
+std::string toString(const Value& v);
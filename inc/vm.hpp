@@ -0,0 +1,68 @@
+#pragma once
+
+#include "bytecode.hpp"
+#include "budget.hpp"
+#include "counters.hpp"
+#include "profiler.hpp"
+#include <cstdint>
+#include <vector>
+
+// Исполнитель байт-кода. Семантика совпадает с интерпретатором по дереву:
+// переполнение целых по модулю, деление на ноль и слишком глубокая рекурсия —
+// RuntimeError с теми же сообщениями. Вызываемые функции должны быть связаны
+// (BytecodeFunction::targets).
+// Ячейки не хранят вид значения: операции выбраны по статическим типам. В отладочной
+// сборке (без NDEBUG) параллельно стеку ведутся теги видов, и каждая инструкция
+// проверяет, что операнды целые или вещественные, как она ожидает; нарушение —
+// std::logic_error, то есть ошибка компилятора байт-кода, а не программы
+class BytecodeVM {
+public:
+    // depth — глубина вызовов на момент входа, продолжает счёт интерпретатора
+    Slot call(const BytecodeFunction& func, const std::vector<Slot>& args, int depth);
+
+    // Чем закончился цикл для замены на стеке
+    struct LoopExit {
+        Op op;          // Exit — цикл завершён, Ret — возврат из функции, Deopt
+        Slot value;     // результат Ret
+        int32_t point;  // операнд Deopt
+    };
+    // Исполняет цикл в кадре slots; новые значения переменных остаются в нём.
+    // depth — глубина функции, которой принадлежит цикл
+    LoopExit enterLoop(const BytecodeFunction& loop, std::vector<Slot>& slots, int depth);
+    // Обратные переходы, выполненные в циклах для замены на стеке
+    uint64_t getIterations() const { return iterations; }
+    // Обратные переходы циклов и вызовы расходуют budget (nullptr — не считать)
+    void setBudget(Budget* budget) { this->budget = budget; }
+    // Предел глубины вызовов, не больше kMaxCallDepth
+    void setMaxDepth(int depth) { maxDepth = depth; }
+    // Выборки профиля на границах кванта budget (см. Budget::setSampler)
+    void setProfiler(Profiler* profiler) { this->profiler = profiler; }
+    // Счёт инструкций и пар; без INTERPRET_COUNTERS не считает ничего
+    void setCounters(ExecutionCounters* counters) { this->counters = counters; }
+
+private:
+    // Активный вызов; цепочка от внутреннего к внешнему нужна только выборкам профиля
+    struct Active {
+        const BytecodeFunction* func;
+        size_t pc; // инструкция вызова или выборки
+        const Active* caller;
+    };
+
+    // Кадры и стеки вычислений всех активных вызовов лежат подряд
+    std::vector<Slot> stack;
+    Op exitOp = Op::Ret;
+    int32_t exitPoint = 0;
+    uint64_t iterations = 0;
+    Budget* budget = nullptr;
+    int maxDepth = kMaxCallDepth;
+    Profiler* profiler = nullptr;
+    ExecutionCounters* counters = nullptr;
+#ifndef NDEBUG
+    std::vector<Value::Kind> tags; // вид каждой ячейки stack
+    void checkTags(const BytecodeFunction& func, size_t pc, size_t base, size_t sp);
+#endif
+
+    void enter(const BytecodeFunction& func, const Slot* args, size_t count, const std::vector<Value::Kind>& kinds);
+    Slot execute(const BytecodeFunction& func, size_t base, int depth, const Active* caller = nullptr);
+    void sample(Active& top, const Instr* at);
+};
@@ -0,0 +1,215 @@
+#include "../inc/ast_clone.hpp"
+
+std::unique_ptr<ASTNode> AstCloner::clone(ASTNode& node) {
+    node.accept(*this);
+    result->line = node.line;
+    return std::move(result);
+}
+
+std::vector<std::unique_ptr<ASTNode>> AstCloner::cloneList(const std::vector<std::unique_ptr<ASTNode>>& nodes) {
+    std::vector<std::unique_ptr<ASTNode>> copies;
+    for (auto& n : nodes) {
+        copies.push_back(cloneOpt(n));
+    }
+    return copies;
+}
+
+// Копирует аннотации семантического анализа
+void AstCloner::finishExpr(ExprNode& from, std::unique_ptr<ASTNode> copy) {
+    static_cast<ExprNode*>(copy.get())->resolved_type = from.resolved_type;
+    result = std::move(copy);
+}
+
+void AstCloner::visit(TranslationUnitNode& node) {
+    result = std::make_unique<TranslationUnitNode>(cloneList(node.declarations));
+}
+
+void AstCloner::visit(TypeNode& node) {
+    result = std::make_unique<TypeNode>(node.type_name, node.is_const, node.is_unsigned);
+}
+
+void AstCloner::visit(DeclaratorNode& node) {
+    auto copy = std::make_unique<DeclaratorNode>(node.name, cloneOpt(node.array_size));
+    copy->is_array = node.is_array;
+    copy->slot = node.slot;
+    result = std::move(copy);
+}
+
+void AstCloner::visit(InitDeclaratorNode& node) {
+    auto decl = cloneAs(*node.declarator);
+    result = std::make_unique<InitDeclaratorNode>(std::move(decl), cloneOpt(node.initializer));
+}
+
+void AstCloner::visit(VarDeclNode& node) {
+    std::vector<std::unique_ptr<InitDeclaratorNode>> decls;
+    for (auto& d : node.declarators) {
+        decls.push_back(cloneAs(*d));
+    }
+    result = std::make_unique<VarDeclNode>(cloneOpt(node.type), std::move(decls), node.is_const);
+}
+
+void AstCloner::visit(ParamDeclNode& node) {
+    auto decl = cloneAs(*node.declarator);
+    result = std::make_unique<ParamDeclNode>(cloneOpt(node.type), std::move(decl), node.is_const);
+}
+
+void AstCloner::visit(FuncDeclNode& node) {
+    std::vector<std::unique_ptr<ParamDeclNode>> params;
+    for (auto& p : node.params) {
+        params.push_back(cloneAs(*p));
+    }
+    auto copy = std::make_unique<FuncDeclNode>(cloneOpt(node.return_type), node.name, std::move(params),
+                                               cloneOpt(node.body), node.is_const);
+    copy->frame_size = node.frame_size;
+    result = std::move(copy);
+}
+
+void AstCloner::visit(StructDeclNode& node) {
+    std::vector<std::unique_ptr<VarDeclNode>> members;
+    for (auto& m : node.members) {
+        members.push_back(cloneAs(*m));
+    }
+    auto copy = std::make_unique<StructDeclNode>(node.name, std::move(members));
+    copy->type = node.type;
+    result = std::move(copy);
+}
+
+void AstCloner::visit(BlockStatementNode& node) {
+    result = std::make_unique<BlockStatementNode>(cloneList(node.statements));
+}
+
+void AstCloner::visit(IfStatementNode& node) {
+    auto cond = cloneOpt(node.condition);
+    auto then_b = cloneOpt(node.then_branch);
+    result = std::make_unique<IfStatementNode>(std::move(cond), std::move(then_b), cloneOpt(node.else_branch));
+}
+
+void AstCloner::visit(WhileLoopNode& node) {
+    auto cond = cloneOpt(node.condition);
+    result = std::make_unique<WhileLoopNode>(std::move(cond), cloneOpt(node.body));
+}
+
+void AstCloner::visit(DoWhileLoopNode& node) {
+    auto body = cloneOpt(node.body);
+    result = std::make_unique<DoWhileLoopNode>(std::move(body), cloneOpt(node.condition));
+}
+
+void AstCloner::visit(ForLoopNode& node) {
+    auto init = cloneOpt(node.init);
+    auto cond = cloneOpt(node.condition);
+    auto inc = cloneOpt(node.increment);
+    result = std::make_unique<ForLoopNode>(std::move(init), std::move(cond), std::move(inc), cloneOpt(node.body));
+}
+
+void AstCloner::visit(ReturnStatementNode& node) {
+    result = std::make_unique<ReturnStatementNode>(cloneOpt(node.expression));
+}
+
+void AstCloner::visit(BinaryExprNode& node) {
+    auto lhs = cloneOpt(node.left);
+    finishExpr(node, std::make_unique<BinaryExprNode>(node.op, std::move(lhs), cloneOpt(node.right)));
+}
+
+void AstCloner::visit(UnaryExprNode& node) {
+    finishExpr(node, std::make_unique<UnaryExprNode>(node.op, cloneOpt(node.operand)));
+}
+
+void AstCloner::visit(TernaryExprNode& node) {
+    auto cond = cloneOpt(node.condition);
+    auto then_e = cloneOpt(node.then_expr);
+    finishExpr(node, std::make_unique<TernaryExprNode>(std::move(cond), std::move(then_e), cloneOpt(node.else_expr)));
+}
+
+void AstCloner::visit(CastExprNode& node) {
+    auto type = cloneOpt(node.type);
+    finishExpr(node, std::make_unique<CastExprNode>(std::move(type), cloneOpt(node.expression)));
+}
+
+void AstCloner::visit(SubscriptExprNode& node) {
+    auto array = cloneOpt(node.array);
+    auto copy = std::make_unique<SubscriptExprNode>(std::move(array), cloneOpt(node.index));
+    copy->checked = node.checked;
+    finishExpr(node, std::move(copy));
+}
+
+void AstCloner::visit(CallExprNode& node) {
+    auto callee = cloneOpt(node.callee);
+    finishExpr(node, std::make_unique<CallExprNode>(std::move(callee), cloneList(node.arguments)));
+}
+
+void AstCloner::visit(LiteralExprNode& node) {
+    auto copy = std::make_unique<LiteralExprNode>(cloneOpt(node.type), node.value);
+    copy->constant = node.constant;
+    finishExpr(node, std::move(copy));
+}
+
+void AstCloner::visit(IdentifierExprNode& node) {
+    auto copy = std::make_unique<IdentifierExprNode>(node.name);
+    copy->slot = node.slot;
+    finishExpr(node, std::move(copy));
+}
+
+void AstCloner::visit(GroupExprNode& node) {
+    finishExpr(node, std::make_unique<GroupExprNode>(cloneOpt(node.expression)));
+}
+
+void AstCloner::visit(PostfixExprNode& node) {
+    finishExpr(node, std::make_unique<PostfixExprNode>(cloneOpt(node.expr), node.op));
+}
+
+void AstCloner::visit(InitListNode& node) {
+    finishExpr(node, std::make_unique<InitListNode>(cloneList(node.elements)));
+}
+
+void AstCloner::visit(BreakStmtNode& node) {
+    result = std::make_unique<BreakStmtNode>();
+}
+
+void AstCloner::visit(ContinueStmtNode& node) {
+    result = std::make_unique<ContinueStmtNode>();
+}
+
+void AstCloner::visit(SizeofExprNode& node) {
+    auto copy = std::make_unique<SizeofExprNode>(cloneOpt(node.operand), node.isType);
+    copy->size = node.size;
+    finishExpr(node, std::move(copy));
+}
+
+void AstCloner::visit(StaticAssertNode& node) {
+    result = std::make_unique<StaticAssertNode>(cloneOpt(node.condition), node.message);
+}
+
+void AstCloner::visit(ExitExprNode& node) {
+    finishExpr(node, std::make_unique<ExitExprNode>(cloneList(node.arguments)));
+}
+
+void AstCloner::visit(AssertExprNode& node) {
+    finishExpr(node, std::make_unique<AssertExprNode>(cloneList(node.arguments)));
+}
+
+void AstCloner::visit(ReadStmtNode& node) {
+    result = std::make_unique<ReadStmtNode>(cloneOpt(node.argument));
+}
+
+void AstCloner::visit(PrintStmtNode& node) {
+    result = std::make_unique<PrintStmtNode>(cloneOpt(node.argument));
+}
+
+void AstCloner::visit(AssignmentExprNode& node) {
+    auto lhs = cloneOpt(node.left);
+    finishExpr(node, std::make_unique<AssignmentExprNode>(std::move(lhs), cloneOpt(node.right), node.op));
+}
+
+void AstCloner::visit(MemberAccessExprNode& node) {
+    auto copy = std::make_unique<MemberAccessExprNode>(cloneOpt(node.object), node.member, node.op);
+    copy->field = node.field;
+    finishExpr(node, std::move(copy));
+}
+
+void AstCloner::visit(NamespaceDeclNode& node) {
+    result = std::make_unique<NamespaceDeclNode>(node.name, cloneList(node.declarations));
+}
+
+void AstCloner::visit(ScopedIdentifierExprNode& node) {
+    finishExpr(node, std::make_unique<ScopedIdentifierExprNode>(node.path));
+}
@@ -0,0 +1,271 @@
+#include "../inc/ast_utils.hpp"
+#include "../inc/ast_clone.hpp"
+
+namespace {
+
+// Операнды свёртки constantIntValue: произведение двух таких чисел не переполняет long long
+constexpr long long kConstantLimit = 1LL << 30;
+
+} // namespace
+
+void forEachSlot(ASTNode& node, const std::function<void(std::unique_ptr<ASTNode>&)>& fn) {
+    auto opt = [&](std::unique_ptr<ASTNode>& slot) { if (slot) fn(slot); };
+    auto list = [&](std::vector<std::unique_ptr<ASTNode>>& slots) { for (auto& s : slots) opt(s); };
+
+    if (auto n = dynamic_cast<TranslationUnitNode*>(&node)) return list(n->declarations);
+    if (auto n = dynamic_cast<NamespaceDeclNode*>(&node)) return list(n->declarations);
+    if (auto n = dynamic_cast<FuncDeclNode*>(&node)) return opt(n->body);
+    if (auto n = dynamic_cast<VarDeclNode*>(&node)) {
+        for (auto& d : n->declarators) {
+            opt(d->declarator->array_size);
+            opt(d->initializer);
+        }
+        return;
+    }
+    if (auto n = dynamic_cast<BlockStatementNode*>(&node)) return list(n->statements);
+    if (auto n = dynamic_cast<IfStatementNode*>(&node)) {
+        opt(n->condition); opt(n->then_branch); opt(n->else_branch);
+        return;
+    }
+    if (auto n = dynamic_cast<WhileLoopNode*>(&node)) { opt(n->condition); opt(n->body); return; }
+    if (auto n = dynamic_cast<DoWhileLoopNode*>(&node)) { opt(n->body); opt(n->condition); return; }
+    if (auto n = dynamic_cast<ForLoopNode*>(&node)) {
+        opt(n->init); opt(n->condition); opt(n->increment); opt(n->body);
+        return;
+    }
+    if (auto n = dynamic_cast<ReturnStatementNode*>(&node)) return opt(n->expression);
+    if (auto n = dynamic_cast<ReadStmtNode*>(&node)) return opt(n->argument);
+    if (auto n = dynamic_cast<PrintStmtNode*>(&node)) return opt(n->argument);
+    if (auto n = dynamic_cast<StaticAssertNode*>(&node)) return opt(n->condition);
+    if (auto n = dynamic_cast<BinaryExprNode*>(&node)) { opt(n->left); opt(n->right); return; }
+    if (auto n = dynamic_cast<UnaryExprNode*>(&node)) return opt(n->operand);
+    if (auto n = dynamic_cast<TernaryExprNode*>(&node)) {
+        opt(n->condition); opt(n->then_expr); opt(n->else_expr);
+        return;
+    }
+    if (auto n = dynamic_cast<CastExprNode*>(&node)) return opt(n->expression);
+    if (auto n = dynamic_cast<SubscriptExprNode*>(&node)) { opt(n->array); opt(n->index); return; }
+    if (auto n = dynamic_cast<CallExprNode*>(&node)) { opt(n->callee); list(n->arguments); return; }
+    if (auto n = dynamic_cast<GroupExprNode*>(&node)) return opt(n->expression);
+    if (auto n = dynamic_cast<PostfixExprNode*>(&node)) return opt(n->expr);
+    if (auto n = dynamic_cast<InitListNode*>(&node)) return list(n->elements);
+    if (auto n = dynamic_cast<SizeofExprNode*>(&node)) {
+        if (!n->isType) opt(n->operand);
+        return;
+    }
+    if (auto n = dynamic_cast<ExitExprNode*>(&node)) return list(n->arguments);
+    if (auto n = dynamic_cast<AssertExprNode*>(&node)) return list(n->arguments);
+    if (auto n = dynamic_cast<AssignmentExprNode*>(&node)) { opt(n->left); opt(n->right); return; }
+    if (auto n = dynamic_cast<MemberAccessExprNode*>(&node)) return opt(n->object);
+}
+
+void walk(ASTNode& node, const std::function<void(ASTNode&)>& fn) {
+    fn(node);
+    forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { walk(*child, fn); });
+}
+
+std::string exprToString(ASTNode& node) {
+    if (auto n = dynamic_cast<LiteralExprNode*>(&node)) {
+        auto type = dynamic_cast<TypeNode*>(n->type.get());
+        if (type && type->type_name == "string") return "\"" + n->value + "\"";
+        if (type && type->type_name == "char") return "'" + n->value + "'";
+        return n->value;
+    }
+    if (auto n = dynamic_cast<IdentifierExprNode*>(&node)) return n->name;
+    if (auto n = dynamic_cast<ScopedIdentifierExprNode*>(&node)) {
+        std::string s;
+        for (size_t i = 0; i < n->path.size(); ++i) s += (i ? "::" : "") + n->path[i];
+        return s;
+    }
+    if (auto n = dynamic_cast<BinaryExprNode*>(&node))
+        return "(" + exprToString(*n->left) + " " + n->op + " " + exprToString(*n->right) + ")";
+    if (auto n = dynamic_cast<UnaryExprNode*>(&node)) return n->op + exprToString(*n->operand);
+    if (auto n = dynamic_cast<PostfixExprNode*>(&node)) return exprToString(*n->expr) + n->op;
+    if (auto n = dynamic_cast<GroupExprNode*>(&node)) return exprToString(*n->expression);
+    if (auto n = dynamic_cast<TernaryExprNode*>(&node))
+        return "(" + exprToString(*n->condition) + " ? " + exprToString(*n->then_expr) + " : " +
+               exprToString(*n->else_expr) + ")";
+    if (auto n = dynamic_cast<CastExprNode*>(&node)) {
+        auto type = dynamic_cast<TypeNode*>(n->type.get());
+        return "(" + (type ? type->type_name : std::string("?")) + ")" + exprToString(*n->expression);
+    }
+    if (auto n = dynamic_cast<SubscriptExprNode*>(&node))
+        return exprToString(*n->array) + "[" + exprToString(*n->index) + "]";
+    if (auto n = dynamic_cast<MemberAccessExprNode*>(&node))
+        return exprToString(*n->object) + n->op + n->member;
+    if (auto n = dynamic_cast<AssignmentExprNode*>(&node))
+        return exprToString(*n->left) + " " + n->op + " " + exprToString(*n->right);
+    if (auto n = dynamic_cast<CallExprNode*>(&node)) {
+        std::string s = exprToString(*n->callee) + "(";
+        for (size_t i = 0; i < n->arguments.size(); ++i) s += (i ? ", " : "") + exprToString(*n->arguments[i]);
+        return s + ")";
+    }
+    return "<?>";
+}
+
+size_t countNodes(ASTNode& node) {
+    size_t count = 0;
+    walk(node, [&](ASTNode&) { ++count; });
+    return count;
+}
+
+std::string rootVariable(ASTNode& lvalue) {
+    if (auto n = dynamic_cast<IdentifierExprNode*>(&lvalue)) return n->name;
+    if (auto n = dynamic_cast<ScopedIdentifierExprNode*>(&lvalue)) return n->getName();
+    if (auto n = dynamic_cast<MemberAccessExprNode*>(&lvalue)) return rootVariable(*n->object);
+    if (auto n = dynamic_cast<SubscriptExprNode*>(&lvalue)) return rootVariable(*n->array);
+    if (auto n = dynamic_cast<GroupExprNode*>(&lvalue)) return rootVariable(*n->expression);
+    return "";
+}
+
+void collectAssigned(ASTNode& node, std::unordered_set<std::string>& names) {
+    walk(node, [&](ASTNode& n) {
+        if (auto a = dynamic_cast<AssignmentExprNode*>(&n)) {
+            names.insert(rootVariable(*a->left));
+        } else if (auto p = dynamic_cast<PostfixExprNode*>(&n)) {
+            names.insert(rootVariable(*p->expr));
+        } else if (auto u = dynamic_cast<UnaryExprNode*>(&n)) {
+            if (u->op == "++" || u->op == "--" || u->op == "&") names.insert(rootVariable(*u->operand));
+        } else if (auto r = dynamic_cast<ReadStmtNode*>(&n)) {
+            if (r->argument) names.insert(rootVariable(*r->argument));
+        } else if (auto v = dynamic_cast<VarDeclNode*>(&n)) {
+            for (auto& d : v->declarators) names.insert(d->declarator->name);
+        }
+    });
+}
+
+bool isPure(ASTNode& node) {
+    bool pure = true;
+    walk(node, [&](ASTNode& n) {
+        if (dynamic_cast<AssignmentExprNode*>(&n) || dynamic_cast<PostfixExprNode*>(&n) ||
+            dynamic_cast<CallExprNode*>(&n) || dynamic_cast<ExitExprNode*>(&n) ||
+            dynamic_cast<AssertExprNode*>(&n) || dynamic_cast<StmtNode*>(&n) ||
+            dynamic_cast<DeclNode*>(&n)) {
+            pure = false;
+        } else if (auto u = dynamic_cast<UnaryExprNode*>(&n)) {
+            if (u->op == "++" || u->op == "--" || u->op == "&") pure = false;
+        }
+    });
+    return pure;
+}
+
+bool cannotFail(ASTNode& node) {
+    if (!isPure(node)) return false;
+    bool safe = true;
+    walk(node, [&](ASTNode& n) {
+        if (dynamic_cast<SubscriptExprNode*>(&n)) {
+            safe = false;
+        } else if (auto u = dynamic_cast<UnaryExprNode*>(&n)) {
+            if (u->op == "*") safe = false;
+        } else if (auto m = dynamic_cast<MemberAccessExprNode*>(&n)) {
+            if (m->op == "->") safe = false;
+        } else if (auto bin = dynamic_cast<BinaryExprNode*>(&n); bin && (bin->op == "/" || bin->op == "%")) {
+            auto type = std::dynamic_pointer_cast<BuiltinType>(bin->resolved_type);
+            if (type && (type->name == "float" || type->name == "double")) return;
+            auto divisor = constantIntValue(bin->right.get());
+            if (!divisor || *divisor == 0 || (*divisor == -1 && !(type && type->is_unsigned))) safe = false;
+        }
+    });
+    return safe;
+}
+
+bool hasLoopExit(ASTNode& body) {
+    if (dynamic_cast<BreakStmtNode*>(&body) || dynamic_cast<ContinueStmtNode*>(&body)) return true;
+    if (dynamic_cast<WhileLoopNode*>(&body) || dynamic_cast<DoWhileLoopNode*>(&body) ||
+        dynamic_cast<ForLoopNode*>(&body)) {
+        return false;
+    }
+    bool found = false;
+    forEachSlot(body, [&](std::unique_ptr<ASTNode>& child) {
+        if (!found) found = hasLoopExit(*child);
+    });
+    return found;
+}
+
+std::optional<long long> intLiteralValue(ASTNode* node) {
+    if (auto g = dynamic_cast<GroupExprNode*>(node)) return intLiteralValue(g->expression.get());
+    auto lit = dynamic_cast<LiteralExprNode*>(node);
+    if (!lit) return std::nullopt;
+    auto type = dynamic_cast<TypeNode*>(lit->type.get());
+    if (!type || type->type_name != "int") return std::nullopt;
+    try {
+        return std::stoll(lit->value);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<long long> constantIntValue(ASTNode* node) {
+    if (auto g = dynamic_cast<GroupExprNode*>(node)) return constantIntValue(g->expression.get());
+    if (auto size = dynamic_cast<SizeofExprNode*>(node)) {
+        return size->size >= 0 ? std::optional<long long>(size->size) : std::nullopt;
+    }
+    if (auto un = dynamic_cast<UnaryExprNode*>(node)) {
+        auto v = constantIntValue(un->operand.get());
+        if (!v || (un->op != "-" && un->op != "+")) return std::nullopt;
+        return un->op == "-" ? -*v : *v;
+    }
+    if (auto bin = dynamic_cast<BinaryExprNode*>(node)) {
+        auto l = constantIntValue(bin->left.get());
+        auto r = constantIntValue(bin->right.get());
+        if (!l || !r) return std::nullopt;
+        // Только то, что не переполняется: размеры массивов невелики
+        if (*l < -kConstantLimit || *l > kConstantLimit || *r < -kConstantLimit || *r > kConstantLimit) {
+            return std::nullopt;
+        }
+        if (bin->op == "+") return *l + *r;
+        if (bin->op == "-") return *l - *r;
+        if (bin->op == "*") return *l * *r;
+        if ((bin->op == "/" || bin->op == "%") && *r != 0) return bin->op == "/" ? *l / *r : *l % *r;
+        return std::nullopt;
+    }
+    return intLiteralValue(node);
+}
+
+bool isBuiltin(const std::shared_ptr<Type>& type, const std::string& name) {
+    auto builtin = std::dynamic_pointer_cast<BuiltinType>(type);
+    return builtin && builtin->name == name;
+}
+
+std::unique_ptr<ASTNode> makeIntLiteral(long long value) {
+    auto lit = std::make_unique<LiteralExprNode>(std::make_unique<TypeNode>("int"), std::to_string(value));
+    lit->resolved_type = std::make_shared<BuiltinType>("int");
+    return lit;
+}
+
+std::unique_ptr<ASTNode> makeIdentifier(const std::string& name, std::shared_ptr<Type> type) {
+    auto id = std::make_unique<IdentifierExprNode>(name);
+    id->resolved_type = std::move(type);
+    return id;
+}
+
+std::unique_ptr<VarDeclNode> makeVarDecl(const std::string& name, const std::shared_ptr<Type>& type,
+                                         std::unique_ptr<ASTNode> init) {
+    std::string typeName = "int";
+    bool isUnsigned = false;
+    if (auto builtin = std::dynamic_pointer_cast<BuiltinType>(type)) {
+        typeName = builtin->name;
+        isUnsigned = builtin->is_unsigned;
+    } else if (auto structType = std::dynamic_pointer_cast<StructType>(type)) {
+        typeName = structType->name;
+    }
+    std::vector<std::unique_ptr<InitDeclaratorNode>> decls;
+    decls.push_back(std::make_unique<InitDeclaratorNode>(std::make_unique<DeclaratorNode>(name), std::move(init)));
+    return std::make_unique<VarDeclNode>(std::make_unique<TypeNode>(typeName, false, isUnsigned), std::move(decls));
+}
+
+void substituteIdentifier(std::unique_ptr<ASTNode>& slot, const std::string& name, ASTNode& value) {
+    if (auto id = dynamic_cast<IdentifierExprNode*>(slot.get())) {
+        if (id->name == name) {
+            AstCloner cloner;
+            slot = cloner.clone(value);
+        }
+        return;
+    }
+    if (auto call = dynamic_cast<CallExprNode*>(slot.get())) {
+        // Имя вызываемой функции не подставляем
+        for (auto& arg : call->arguments) substituteIdentifier(arg, name, value);
+        return;
+    }
+    forEachSlot(*slot, [&](std::unique_ptr<ASTNode>& child) { substituteIdentifier(child, name, value); });
+}
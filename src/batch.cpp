@@ -0,0 +1,137 @@
+#include "../inc/batch.hpp"
+#include "../inc/compilation.hpp"
+#include "../inc/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+struct WorkQueue {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+};
+
+bool takeOwn(WorkQueue& queue, size_t& task) {
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool steal(WorkQueue& queue, size_t& task) {
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool readText(const std::string& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t)>& task) {
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(threads, count));
+    if (workers <= 1) {
+        for (size_t k = 0; k < count; ++k) task(k);
+        return;
+    }
+    std::vector<WorkQueue> queues(workers);
+    for (unsigned w = 0; w < workers; ++w) {
+        // Очередь хранится в обратном порядке: свои задачи берутся с конца по возрастанию
+        for (size_t k = (w + 1) * count / workers; k-- > w * count / workers;) queues[w].tasks.push_back(k);
+    }
+    auto work = [&](unsigned self) {
+        size_t next;
+        for (;;) {
+            if (takeOwn(queues[self], next)) {
+                task(next);
+                continue;
+            }
+            bool found = false;
+            for (unsigned k = 1; k < workers && !found; ++k) found = steal(queues[(self + k) % workers], next);
+            if (!found) return;
+            task(next);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < workers; ++w) {
+        pool.emplace_back([&, w] {
+            Trace::nameThread("batch worker " + std::to_string(w));
+            work(w);
+        });
+    }
+    work(0);
+    for (auto& t : pool) t.join();
+}
+
+FileReport checkFile(const std::string& path) {
+    Trace::Span span("batch", "check", path);
+    FileReport report;
+    std::string source;
+    if (!readText(path, source)) {
+        report.diagnostics = "cannot open file\n";
+        return report;
+    }
+    Compilation compilation(std::move(source));
+    report.ok = compilation.run();
+    for (const auto& error : compilation.getErrors()) report.diagnostics += error + '\n';
+    return report;
+}
+
+int runBatch(const std::vector<std::string>& files, unsigned jobs, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<FileReport> reports(files.size());
+    WorkStealingPool pool(jobs);
+    pool.run(files.size(), [&](size_t k) { reports[k] = checkFile(files[k]); });
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Сообщения печатаются после проверки всех файлов, поэтому их порядок
+    // не зависит от числа потоков
+    size_t failed = 0;
+    for (size_t k = 0; k < files.size(); ++k) {
+        const FileReport& report = reports[k];
+        if (!report.ok) ++failed;
+        std::istringstream lines(report.diagnostics);
+        std::string line;
+        while (std::getline(lines, line)) out << files[k] << ": " << line << '\n';
+        if (!report.ok && report.diagnostics.empty()) out << files[k] << ": failed\n";
+    }
+    out << "Checked " << files.size() << " files: " << files.size() - failed << " ok, " << failed << " failed ("
+        << pool.size() << " threads, " << static_cast<long long>(elapsed) << " ms)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+bool readFileList(const std::string& list, std::vector<std::string>& files) {
+    std::ifstream file;
+    if (list != "-") {
+        file.open(list);
+        if (!file) return false;
+    }
+    std::istream& in = list == "-" ? std::cin : file;
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        files.push_back(line);
+    }
+    return true;
+}
@@ -0,0 +1,13 @@
+#include "../inc/budget.hpp"
+#include <string>
+
+bool Budget::nextQuantum() {
+    spent += static_cast<uint64_t>(period - left);
+    left = period = 0;
+    if (limit && spent >= limit) {
+        throw LimitError(Limit::Steps, "Step limit of " + std::to_string(limit) + " exceeded");
+    }
+    if (expire) expire();
+    start();
+    return sample && sample();
+}
@@ -0,0 +1,858 @@
+#include "../inc/bytecode.hpp"
+#include "../inc/ast_utils.hpp"
+#include "../inc/trace.hpp"
+#include "../inc/type.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using K = Value::Kind;
+
+bool isJump(Op op) {
+    return op == Op::Jmp || op == Op::Jz || op == Op::Jnz || op == Op::CmpJz;
+}
+
+// Есть ли у инструкции следующая по порядку
+bool fallsThrough(Op op) {
+    return op != Op::Jmp && op != Op::Ret && op != Op::Exit && op != Op::Deopt;
+}
+
+bool isNumeric(K kind) {
+    return kind >= K::Bool && kind <= K::Double;
+}
+
+bool isFloating(K kind) {
+    return kind == K::Float || kind == K::Double;
+}
+
+K kindOfType(const std::shared_ptr<Type>& type) {
+    auto builtin = std::dynamic_pointer_cast<BuiltinType>(type);
+    return builtin ? kindOf(builtin->name, builtin->is_unsigned) : K::Void;
+}
+
+bool isCompare(Op op) {
+    return (op >= Op::Lt && op <= Op::Ne) || (op >= Op::LtU && op <= Op::NeD);
+}
+
+int32_t wrap(int64_t v) {
+    return static_cast<int32_t>(static_cast<uint32_t>(v));
+}
+
+// Диапазон значений целого вида в представлении int64
+std::pair<int64_t, int64_t> range(K kind) {
+    switch (kind) {
+    case K::Bool: return {0, 1};
+    case K::Char: return {INT8_MIN, INT8_MAX};
+    case K::UChar: return {0, UINT8_MAX};
+    case K::Short: return {INT16_MIN, INT16_MAX};
+    case K::UShort: return {0, UINT16_MAX};
+    case K::Int: return {INT32_MIN, INT32_MAX};
+    case K::UInt: return {0, UINT32_MAX};
+    default: return {INT64_MIN, INT64_MAX};
+    }
+}
+
+// Приведение не меняет представления: все значения вида from уже допустимы в to
+bool fits(K from, K to) {
+    if (from == to) return true;
+    if (isFloating(from) || isFloating(to)) return from == K::Float && to == K::Double;
+    if (to == K::Bool) return false;
+    auto [fromLo, fromHi] = range(from);
+    auto [toLo, toHi] = range(to);
+    return toLo <= fromLo && fromHi <= toHi;
+}
+
+// Изменение глубины стека вычислений после инструкции
+int stackEffect(const Instr& in) {
+    switch (in.op) {
+    case Op::Const: case Op::ConstK: case Op::Load: case Op::Dup:
+        return 1;
+    case Op::Neg: case Op::NegU: case Op::NegL: case Op::NegD: case Op::Not: case Op::Convert:
+    case Op::Jmp: case Op::Inc: case Op::Exit: case Op::Deopt:
+        return 0;
+    case Op::Call:
+        return 1 - in.b;
+    case Op::CmpJz:
+        return -2;
+    default:
+        return -1;
+    }
+}
+
+// Наибольшая глубина стека по всем путям исполнения
+int maxStack(const BytecodeFunction& func) {
+    std::vector<int> depth(func.code.size(), -1);
+    std::vector<size_t> work{0};
+    if (!func.code.empty()) depth[0] = 0;
+    int result = 0;
+    auto reach = [&](size_t pc, int d) {
+        if (pc < depth.size() && depth[pc] < 0) {
+            depth[pc] = d;
+            work.push_back(pc);
+        }
+    };
+    while (!work.empty()) {
+        size_t pc = work.back();
+        work.pop_back();
+        const Instr& in = func.code[pc];
+        int d = depth[pc] + stackEffect(in);
+        result = std::max({result, depth[pc], d});
+        if (isJump(in.op)) reach(in.a, d);
+        if (fallsThrough(in.op)) reach(pc + 1, d);
+    }
+    return result;
+}
+
+// Значение операции над константами; nullopt — свёртка невозможна (деление на ноль)
+std::optional<int32_t> fold(Op op, int32_t l, int32_t r) {
+    switch (op) {
+    case Op::Add: return wrap(int64_t(l) + r);
+    case Op::Sub: return wrap(int64_t(l) - r);
+    case Op::Mul: return wrap(int64_t(l) * r);
+    case Op::Div: if (r == 0) return std::nullopt; return r == -1 ? wrap(-int64_t(l)) : l / r;
+    case Op::Mod: if (r == 0) return std::nullopt; return r == -1 ? 0 : l % r;
+    case Op::Lt: return l < r;
+    case Op::Le: return l <= r;
+    case Op::Gt: return l > r;
+    case Op::Ge: return l >= r;
+    case Op::Eq: return l == r;
+    case Op::Ne: return l != r;
+    default: return std::nullopt;
+    }
+}
+
+// Один проход шаблонов; удалённые инструкции отмечаются в removed
+bool peephole(std::vector<Instr>& code, std::vector<bool>& removed) {
+    std::vector<bool> target(code.size() + 1, false);
+    for (const Instr& in : code) {
+        if (isJump(in.op)) target[in.a] = true;
+    }
+    // Следующая живая инструкция, не являющаяся целью перехода
+    auto next = [&](size_t pc) -> size_t {
+        do ++pc;
+        while (pc < code.size() && removed[pc] && !target[pc]);
+        return pc < code.size() && !removed[pc] && !target[pc] ? pc : SIZE_MAX;
+    };
+
+    bool changed = false;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (removed[pc]) continue;
+        Instr& in = code[pc];
+
+        // Цепочки переходов
+        if (isJump(in.op)) {
+            for (int hops = 0; hops < 8 && code[in.a].op == Op::Jmp && code[in.a].a != in.a; ++hops) {
+                in.a = code[in.a].a;
+                changed = true;
+            }
+        }
+        size_t second = next(pc);
+        if (second == SIZE_MAX) continue;
+        Instr& in2 = code[second];
+        size_t third = next(second);
+
+        if (in.op == Op::Const && in2.op == Op::Const && third != SIZE_MAX) {
+            if (auto v = fold(code[third].op, in.a, in2.a)) {
+                in.a = *v;
+                removed[second] = removed[third] = true;
+                changed = true;
+                continue;
+            }
+        }
+        if (in.op == Op::Const && (in2.op == Op::Neg || in2.op == Op::Not)) {
+            in.a = in2.op == Op::Neg ? wrap(-int64_t(in.a)) : in.a == 0;
+            removed[second] = true;
+            changed = true;
+            continue;
+        }
+        if (in.op == Op::Const && (in2.op == Op::Jz || in2.op == Op::Jnz)) {
+            // Ветвление по константе: безусловный переход или ничего
+            if ((in.a == 0) == (in2.op == Op::Jz)) {
+                in = {Op::Jmp, in2.a};
+            } else {
+                removed[pc] = true;
+            }
+            removed[second] = true;
+            changed = true;
+            continue;
+        }
+        if (in.op == Op::Not && (in2.op == Op::Jz || in2.op == Op::Jnz)) {
+            in = {in2.op == Op::Jz ? Op::Jnz : Op::Jz, in2.a};
+            removed[second] = true;
+            changed = true;
+            continue;
+        }
+        if (isCompare(in.op) && in2.op == Op::Jz) {
+            in = {Op::CmpJz, in2.a, static_cast<int32_t>(in.op)};
+            removed[second] = true;
+            changed = true;
+            continue;
+        }
+        if (in.op == Op::Load && in2.op == Op::Const && third != SIZE_MAX) {
+            // i = i + c, i++ и i -= c
+            size_t fourth = next(third);
+            Op op = code[third].op;
+            if (fourth != SIZE_MAX && (op == Op::Add || op == Op::Sub) && code[fourth].op == Op::Store &&
+                code[fourth].a == in.a) {
+                in = {Op::Inc, in.a, op == Op::Add ? in2.a : wrap(-int64_t(in2.a))};
+                removed[second] = removed[third] = removed[fourth] = true;
+                changed = true;
+                continue;
+            }
+        }
+        if (in.op == Op::Jmp && next(pc) == static_cast<size_t>(in.a)) {
+            removed[pc] = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Недостижимые инструкции
+bool removeUnreachable(const std::vector<Instr>& code, std::vector<bool>& removed) {
+    std::vector<bool> seen(code.size(), false);
+    std::vector<size_t> work{0};
+    while (!work.empty()) {
+        size_t pc = work.back();
+        work.pop_back();
+        // Удалённые инструкции пропускаются как пустые
+        while (pc < code.size() && removed[pc] && !seen[pc]) seen[pc++] = true;
+        if (pc >= code.size() || seen[pc]) continue;
+        seen[pc] = true;
+        const Instr& in = code[pc];
+        if (isJump(in.op)) work.push_back(in.a);
+        if (fallsThrough(in.op)) work.push_back(pc + 1);
+    }
+    bool changed = false;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (!seen[pc] && !removed[pc]) {
+            removed[pc] = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+} // namespace
+
+std::vector<BytecodeFunction> compileProgram(TranslationUnitNode& program, const ConstantPool& constants) {
+    Trace::Span span("compile", "bytecode");
+    std::unordered_map<std::string, FuncDeclNode*> functions;
+    for (auto& decl : program.declarations) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(decl.get()); func && func->body) functions[func->name] = func;
+    }
+    std::vector<BytecodeFunction> compiled;
+    for (auto& decl : program.declarations) {
+        auto func = dynamic_cast<FuncDeclNode*>(decl.get());
+        if (!func || !func->body) continue;
+        BytecodeCompiler compiler(functions, constants);
+        if (auto code = compiler.compile(*func)) {
+            optimizeBytecode(*code);
+            compiled.push_back(std::move(*code));
+        }
+    }
+    // Функция, вызывающая некомпилируемую, остаётся интерпретатору
+    for (bool changed = true; changed;) {
+        changed = false;
+        std::unordered_set<std::string> names;
+        for (auto& f : compiled) names.insert(f.name);
+        auto dropped = std::remove_if(compiled.begin(), compiled.end(), [&](const BytecodeFunction& f) {
+            return std::any_of(f.callees.begin(), f.callees.end(), [&](auto& c) { return !names.count(c); });
+        });
+        changed = dropped != compiled.end();
+        compiled.erase(dropped, compiled.end());
+    }
+    return compiled;
+}
+
+std::optional<BytecodeFunction> BytecodeCompiler::compile(FuncDeclNode& func) {
+    out = BytecodeFunction{func.name, static_cast<int>(func.params.size()), func.frame_size};
+    out.slot_kinds.assign(std::max(func.frame_size, out.param_count), K::Void);
+    function = &func;
+    loops.clear();
+    blocks.clear();
+    osr = false;
+    line = func.line;
+    error.clear();
+    try {
+        if (!func.body) throw Unsupported{"no body"};
+        out.return_kind = requireNumeric(func.return_type.get(), "return type", true);
+        for (size_t i = 0; i < func.params.size(); ++i) {
+            auto& p = func.params[i];
+            if (p->declarator->is_array) throw Unsupported{"array parameter " + p->declarator->name};
+            K kind = requireNumeric(p->type.get(), "parameter " + p->declarator->name);
+            out.param_kinds.push_back(kind);
+            useSlot(static_cast<int>(i), kind);
+        }
+        statement(*func.body);
+        constant(out.return_kind, Slot{});
+        emit(Op::Ret);
+    } catch (const Unsupported& e) {
+        error = e.reason;
+        return std::nullopt;
+    }
+    out.max_stack = maxStack(out);
+    return std::move(out);
+}
+
+std::optional<BytecodeFunction> BytecodeCompiler::compileLoop(FuncDeclNode& func, ASTNode& loop, int frameSize) {
+    // Все слоты считаются параметрами: кадр приходит от интерпретатора целиком
+    out = BytecodeFunction{func.name + ":loop", frameSize, frameSize};
+    out.slot_kinds.assign(frameSize, K::Void);
+    function = &func;
+    loops.clear();
+    blocks.clear();
+    osr = true;
+    line = loop.line;
+    error.clear();
+    try {
+        auto whileLoop = dynamic_cast<WhileLoopNode*>(&loop);
+        auto forLoop = dynamic_cast<ForLoopNode*>(&loop);
+        auto doLoop = dynamic_cast<DoWhileLoopNode*>(&loop);
+        ASTNode* cond = whileLoop ? whileLoop->condition.get()
+                      : forLoop   ? forLoop->condition.get()
+                      : doLoop    ? doLoop->condition.get()
+                                  : throw Unsupported{"not a loop"};
+        ASTNode* body = whileLoop ? whileLoop->body.get() : forLoop ? forLoop->body.get() : doLoop->body.get();
+        ASTNode* increment = forLoop ? forLoop->increment.get() : nullptr;
+
+        // Вход — проверка условия; у do-while тело идёт перед ней
+        size_t toCondition = doLoop ? emit(Op::Jmp) : SIZE_MAX;
+        size_t top = out.code.size();
+        size_t toEnd = SIZE_MAX;
+        if (!doLoop && cond) {
+            condition(*cond);
+            toEnd = emit(Op::Jz);
+        }
+        loops.emplace_back();
+        statement(*body);
+        size_t step = out.code.size();
+        if (increment) effect(*increment);
+        if (doLoop) {
+            patch(toCondition, step);
+            condition(*cond);
+            toEnd = emit(Op::Jz);
+        }
+        emit(Op::Jmp, static_cast<int32_t>(top), 1);
+        if (toEnd != SIZE_MAX) patch(toEnd, out.code.size());
+        patchLoop(loops.back(), out.code.size(), step);
+        loops.pop_back();
+        emit(Op::Exit);
+    } catch (const Unsupported& e) {
+        error = e.reason;
+        return std::nullopt;
+    }
+    out.param_kinds = out.slot_kinds;
+    out.max_stack = maxStack(out);
+    return std::move(out);
+}
+
+size_t BytecodeCompiler::emit(Op op, int32_t a, int32_t b) {
+    out.code.push_back({op, a, b});
+    out.lines.push_back(line);
+    return out.code.size() - 1;
+}
+
+// Вставка внутрь уже сгенерированного выражения: переходы за точку вставки сдвигаются
+void BytecodeCompiler::insert(size_t at, Instr in) {
+    out.code.insert(out.code.begin() + at, in);
+    out.lines.insert(out.lines.begin() + at, line);
+    for (Instr& other : out.code) {
+        if (isJump(other.op) && other.a > static_cast<int32_t>(at)) ++other.a;
+    }
+}
+
+void BytecodeCompiler::patch(size_t at, size_t target) {
+    out.code[at].a = static_cast<int32_t>(target);
+}
+
+void BytecodeCompiler::patchLoop(LoopLabels& labels, size_t breakTarget, size_t continueTarget) {
+    for (size_t at : labels.breaks) patch(at, breakTarget);
+    for (size_t at : labels.continues) patch(at, continueTarget);
+}
+
+Value::Kind BytecodeCompiler::requireNumeric(ASTNode* type, const std::string& what, bool allowVoid) {
+    auto t = dynamic_cast<TypeNode*>(type);
+    if (t && allowVoid && t->type_name == "void") return K::Void;
+    K kind = t ? kindOf(t->type_name, t->is_unsigned) : K::Void;
+    if (!isNumeric(kind)) throw Unsupported{what + " is not a number"};
+    return kind;
+}
+
+void BytecodeCompiler::useSlot(int slot, Value::Kind kind) {
+    K& known = out.slot_kinds[slot];
+    // Кадр для замены на стеке переносится по видам слотов, поэтому слот — одного вида
+    if (osr && known != K::Void && known != kind) throw Unsupported{"slot reused with different types"};
+    known = kind;
+}
+
+int BytecodeCompiler::slotOf(ASTNode& node, Value::Kind& kind) {
+    auto id = dynamic_cast<IdentifierExprNode*>(&node);
+    if (!id) throw Unsupported{"assignment to " + exprToString(node)};
+    if (id->slot < 0) throw Unsupported{"non-local variable " + id->name};
+    kind = id->resolved_type ? kindOfType(id->resolved_type) : out.slot_kinds[id->slot];
+    if (!isNumeric(kind)) throw Unsupported{"variable " + id->name + " is not a number"};
+    useSlot(id->slot, kind);
+    return id->slot;
+}
+
+void BytecodeCompiler::constant(Value::Kind kind, Slot value) {
+    if (!isFloating(kind) && value.i >= INT32_MIN && value.i <= INT32_MAX) {
+        emit(Op::Const, static_cast<int32_t>(value.i));
+        return;
+    }
+    emit(Op::ConstK, static_cast<int32_t>(out.constants.size()), static_cast<int32_t>(kind));
+    out.constants.push_back(value);
+}
+
+void BytecodeCompiler::convert(Value::Kind from, Value::Kind to) {
+    if (!isNumeric(from) || !isNumeric(to)) throw Unsupported{"conversion of a non-number"};
+    if (!fits(from, to)) emit(Op::Convert, static_cast<int32_t>(from), static_cast<int32_t>(to));
+}
+
+// Операнды уже на стеке, правый начинается с rightStart. Продвижение как в
+// Interpreter::arithmetic: вещественные считаются в double, целые — не уже int
+Value::Kind BytecodeCompiler::arithmetic(const std::string& op, Value::Kind left, Value::Kind right,
+                                         size_t rightStart) {
+    if (!isNumeric(left) || !isNumeric(right)) throw Unsupported{"operator " + op + " on a non-number"};
+    if (isFloating(left) || isFloating(right)) {
+        static const std::unordered_map<std::string, Op> ops = {
+            {"+", Op::AddD}, {"-", Op::SubD}, {"*", Op::MulD}, {"/", Op::DivD}, {"<", Op::LtD},
+            {"<=", Op::LeD}, {">", Op::GtD},  {">=", Op::GeD}, {"==", Op::EqD}, {"!=", Op::NeD}};
+        auto it = ops.find(op);
+        if (it == ops.end()) throw Unsupported{"operator " + op + " on floating values"};
+        convert(right, K::Double);
+        if (!isFloating(left)) insert(rightStart, {Op::Convert, static_cast<int32_t>(left), static_cast<int32_t>(K::Double)});
+        emit(it->second);
+        if (isCompare(it->second)) return K::Int;
+        K kind = left == K::Double || right == K::Double ? K::Double : K::Float;
+        if (kind == K::Float) emit(Op::Convert, static_cast<int32_t>(K::Double), static_cast<int32_t>(K::Float));
+        return kind;
+    }
+
+    // Целые операнды уже приведены к своей разрядности и в приведении не нуждаются
+    K kind = std::max({left, right, K::Int});
+    bool isUnsigned = kind == K::UInt || kind == K::ULong;
+    static const std::unordered_map<std::string, Op> compares = {
+        {"<", Op::Lt}, {"<=", Op::Le}, {">", Op::Gt}, {">=", Op::Ge}, {"==", Op::Eq}, {"!=", Op::Ne}};
+    static const std::unordered_map<std::string, Op> unsignedCompares = {
+        {"<", Op::LtU}, {"<=", Op::LeU}, {">", Op::GtU}, {">=", Op::GeU}};
+    if (isUnsigned && unsignedCompares.count(op)) {
+        emit(unsignedCompares.at(op));
+        return K::Int;
+    }
+    if (compares.count(op)) {
+        emit(compares.at(op));
+        return K::Int;
+    }
+    static const std::unordered_map<std::string, std::array<Op, 4>> ops = {
+        // int, unsigned int, long, unsigned long
+        {"+", {Op::Add, Op::AddU, Op::AddL, Op::AddL}},
+        {"-", {Op::Sub, Op::SubU, Op::SubL, Op::SubL}},
+        {"*", {Op::Mul, Op::MulU, Op::MulL, Op::MulL}},
+        {"/", {Op::Div, Op::DivU, Op::DivL, Op::DivUL}},
+        {"%", {Op::Mod, Op::ModU, Op::ModL, Op::ModUL}}};
+    auto it = ops.find(op);
+    if (it == ops.end()) throw Unsupported{"operator " + op};
+    emit(it->second[static_cast<int>(kind) - static_cast<int>(K::Int)]);
+    return kind;
+}
+
+// ++ или -- над значением вида kind на вершине стека, с приведением обратно к kind
+void BytecodeCompiler::step(Value::Kind kind, const std::string& op) {
+    size_t one = out.code.size();
+    emit(Op::Const, 1);
+    convert(arithmetic(op == "++" ? "+" : "-", kind, K::Int, one), kind);
+}
+
+void BytecodeCompiler::statement(ASTNode& node) {
+    // Инструкции после вложенного оператора (обратный переход цикла) — снова строки этого
+    int outer = line;
+    if (node.line) line = node.line;
+    if (!osr || loops.size() != 1) {
+        lower(node);
+        line = outer;
+        return;
+    }
+    // Тело цикла OSR вне вложенных циклов: неподдерживаемый оператор отдаётся
+    // интерпретатору целиком, сгенерированное для него отбрасывается
+    size_t code = out.code.size();
+    size_t callees = out.callees.size();
+    size_t breaks = loops.back().breaks.size();
+    size_t continues = loops.back().continues.size();
+    size_t path = blocks.size();
+    try {
+        lower(node);
+    } catch (const Unsupported&) {
+        out.code.resize(code);
+        out.lines.resize(code);
+        out.callees.resize(callees);
+        loops.resize(1);
+        loops.back().breaks.resize(breaks);
+        loops.back().continues.resize(continues);
+        blocks.resize(path);
+        emit(Op::Deopt, static_cast<int32_t>(out.resume.size()));
+        out.resume.push_back({&node, {blocks.rbegin(), blocks.rend()}});
+    }
+    line = outer;
+}
+
+void BytecodeCompiler::lower(ASTNode& node) {
+    if (auto block = dynamic_cast<BlockStatementNode*>(&node)) {
+        for (size_t i = 0; i < block->statements.size(); ++i) {
+            blocks.emplace_back(block, i + 1);
+            statement(*block->statements[i]);
+            blocks.pop_back();
+        }
+        return;
+    }
+    if (auto var = dynamic_cast<VarDeclNode*>(&node)) {
+        K kind = requireNumeric(var->type.get(), "variable type");
+        for (auto& d : var->declarators) {
+            if (d->declarator->array_size) throw Unsupported{"array " + d->declarator->name};
+            if (d->declarator->slot < 0) throw Unsupported{"non-local variable " + d->declarator->name};
+            useSlot(d->declarator->slot, kind);
+            if (d->initializer) convert(expression(*d->initializer), kind);
+            else constant(kind, Slot{});
+            emit(Op::Store, d->declarator->slot);
+        }
+        return;
+    }
+    if (auto branch = dynamic_cast<IfStatementNode*>(&node)) {
+        condition(*branch->condition);
+        size_t toElse = emit(Op::Jz);
+        statement(*branch->then_branch);
+        if (branch->else_branch) {
+            size_t toEnd = emit(Op::Jmp);
+            patch(toElse, out.code.size());
+            statement(*branch->else_branch);
+            patch(toEnd, out.code.size());
+        } else {
+            patch(toElse, out.code.size());
+        }
+        return;
+    }
+    if (auto loop = dynamic_cast<WhileLoopNode*>(&node)) {
+        size_t top = out.code.size();
+        condition(*loop->condition);
+        size_t toEnd = emit(Op::Jz);
+        loops.emplace_back();
+        statement(*loop->body);
+        emit(Op::Jmp, static_cast<int32_t>(top), 1);
+        patch(toEnd, out.code.size());
+        patchLoop(loops.back(), out.code.size(), top);
+        loops.pop_back();
+        return;
+    }
+    if (auto loop = dynamic_cast<DoWhileLoopNode*>(&node)) {
+        size_t top = out.code.size();
+        loops.emplace_back();
+        statement(*loop->body);
+        size_t cond = out.code.size();
+        condition(*loop->condition);
+        // Обратный переход — отмеченный Jmp, как у остальных циклов: его считают счётчики
+        size_t toEnd = emit(Op::Jz);
+        emit(Op::Jmp, static_cast<int32_t>(top), 1);
+        patch(toEnd, out.code.size());
+        patchLoop(loops.back(), out.code.size(), cond);
+        loops.pop_back();
+        return;
+    }
+    if (auto loop = dynamic_cast<ForLoopNode*>(&node)) {
+        if (loop->init) statement(*loop->init);
+        size_t top = out.code.size();
+        size_t toEnd = SIZE_MAX;
+        if (loop->condition) {
+            condition(*loop->condition);
+            toEnd = emit(Op::Jz);
+        }
+        loops.emplace_back();
+        statement(*loop->body);
+        size_t step = out.code.size();
+        if (loop->increment) effect(*loop->increment);
+        emit(Op::Jmp, static_cast<int32_t>(top), 1);
+        if (toEnd != SIZE_MAX) patch(toEnd, out.code.size());
+        patchLoop(loops.back(), out.code.size(), step);
+        loops.pop_back();
+        return;
+    }
+    if (auto ret = dynamic_cast<ReturnStatementNode*>(&node)) {
+        out.return_kind = requireNumeric(function->return_type.get(), "return type", true);
+        if (ret->expression && out.return_kind != K::Void) convert(expression(*ret->expression), out.return_kind);
+        else if (ret->expression) expression(*ret->expression);
+        else constant(out.return_kind, Slot{});
+        emit(Op::Ret);
+        return;
+    }
+    if (dynamic_cast<BreakStmtNode*>(&node) || dynamic_cast<ContinueStmtNode*>(&node)) {
+        if (loops.empty()) throw Unsupported{"break or continue outside of a loop"};
+        size_t at = emit(Op::Jmp);
+        if (dynamic_cast<BreakStmtNode*>(&node)) loops.back().breaks.push_back(at);
+        else loops.back().continues.push_back(at);
+        return;
+    }
+    if (dynamic_cast<ExprNode*>(&node)) {
+        effect(node);
+        return;
+    }
+    throw Unsupported{"unsupported statement"};
+}
+
+// Выражение ради побочного эффекта: результат не остаётся на стеке
+void BytecodeCompiler::effect(ASTNode& node) {
+    if (auto assign = dynamic_cast<AssignmentExprNode*>(&node)) {
+        K kind;
+        int slot = slotOf(*assign->left, kind);
+        if (assign->op == "=") {
+            convert(expression(*assign->right), kind);
+        } else {
+            emit(Op::Load, slot);
+            size_t right = out.code.size();
+            K rightKind = expression(*assign->right);
+            convert(arithmetic(assign->op.substr(0, assign->op.size() - 1), kind, rightKind, right), kind);
+        }
+        emit(Op::Store, slot);
+        return;
+    }
+    auto post = dynamic_cast<PostfixExprNode*>(&node);
+    auto pre = dynamic_cast<UnaryExprNode*>(&node);
+    if (post || (pre && (pre->op == "++" || pre->op == "--"))) {
+        K kind;
+        int slot = slotOf(post ? *post->expr : *pre->operand, kind);
+        emit(Op::Load, slot);
+        step(kind, post ? post->op : pre->op);
+        emit(Op::Store, slot);
+        return;
+    }
+    expression(node);
+    emit(Op::Pop);
+}
+
+// Условие ветвления: на стеке остаётся целое, ноль — ложь
+void BytecodeCompiler::condition(ASTNode& node) {
+    K kind = expression(node);
+    if (!isNumeric(kind)) throw Unsupported{"condition is not a number"};
+    if (isFloating(kind)) {
+        constant(K::Double, Slot{.f = 0});
+        emit(Op::NeD);
+    }
+}
+
+Value::Kind BytecodeCompiler::expression(ASTNode& node) {
+    if (auto lit = dynamic_cast<LiteralExprNode*>(&node)) {
+        // Значение берётся из пула констант, как в Interpreter::visit(LiteralExprNode&)
+        if (lit->constant == ConstantPool::kNone) throw Unsupported{"literal " + lit->value};
+        const Value& v = constants.at(lit->constant);
+        if (!isNumeric(v.kind)) throw Unsupported{"literal " + lit->value};
+        constant(v.kind, toSlot(v, v.kind));
+        return v.kind;
+    }
+    if (auto id = dynamic_cast<IdentifierExprNode*>(&node)) {
+        K kind;
+        emit(Op::Load, slotOf(*id, kind));
+        return kind;
+    }
+    if (auto group = dynamic_cast<GroupExprNode*>(&node)) {
+        return expression(*group->expression);
+    }
+    if (auto bin = dynamic_cast<BinaryExprNode*>(&node)) {
+        if (bin->op == "&&" || bin->op == "||") {
+            // Короткое вычисление: результат 0 или 1
+            Op shortcut = bin->op == "&&" ? Op::Jz : Op::Jnz;
+            condition(*bin->left);
+            size_t first = emit(shortcut);
+            condition(*bin->right);
+            size_t second = emit(shortcut);
+            emit(Op::Const, bin->op == "&&" ? 1 : 0);
+            size_t toEnd = emit(Op::Jmp);
+            patch(first, out.code.size());
+            patch(second, out.code.size());
+            emit(Op::Const, bin->op == "&&" ? 0 : 1);
+            patch(toEnd, out.code.size());
+            return K::Int;
+        }
+        K left = expression(*bin->left);
+        size_t right = out.code.size();
+        return arithmetic(bin->op, left, expression(*bin->right), right);
+    }
+    if (auto un = dynamic_cast<UnaryExprNode*>(&node)) {
+        if (un->op == "++" || un->op == "--") {
+            K kind;
+            int slot = slotOf(*un->operand, kind);
+            emit(Op::Load, slot);
+            step(kind, un->op);
+            emit(Op::Dup);
+            emit(Op::Store, slot);
+            return kind;
+        }
+        if (un->op == "!") {
+            K kind = expression(*un->operand);
+            if (!isNumeric(kind)) throw Unsupported{"operator ! on a non-number"};
+            if (isFloating(kind)) {
+                constant(K::Double, Slot{.f = 0});
+                emit(Op::EqD);
+            } else {
+                emit(Op::Not);
+            }
+            return K::Int;
+        }
+        if (un->op == "-") {
+            // Целое вычитается из нуля с продвижением, вещественное сохраняет вид
+            K kind = expression(*un->operand);
+            if (!isNumeric(kind)) throw Unsupported{"operator - on a non-number"};
+            if (isFloating(kind)) {
+                emit(Op::NegD);
+                return kind;
+            }
+            kind = std::max(kind, K::Int);
+            emit(kind == K::Int ? Op::Neg : kind == K::UInt ? Op::NegU : Op::NegL);
+            return kind;
+        }
+        if (un->op == "+") return expression(*un->operand);
+        throw Unsupported{"operator " + un->op};
+    }
+    if (auto post = dynamic_cast<PostfixExprNode*>(&node)) {
+        K kind;
+        int slot = slotOf(*post->expr, kind);
+        emit(Op::Load, slot);
+        emit(Op::Dup);
+        step(kind, post->op);
+        emit(Op::Store, slot);
+        return kind;
+    }
+    if (auto assign = dynamic_cast<AssignmentExprNode*>(&node)) {
+        effect(*assign);
+        K kind;
+        emit(Op::Load, slotOf(*assign->left, kind));
+        return kind;
+    }
+    if (auto tern = dynamic_cast<TernaryExprNode*>(&node)) {
+        condition(*tern->condition);
+        size_t toElse = emit(Op::Jz);
+        K thenKind = expression(*tern->then_expr);
+        size_t toEnd = emit(Op::Jmp);
+        patch(toElse, out.code.size());
+        K elseKind = expression(*tern->else_expr);
+        patch(toEnd, out.code.size());
+        // Интерпретатор не приводит ветви к общему виду
+        if (thenKind != elseKind) throw Unsupported{"ternary branches of different types"};
+        return thenKind;
+    }
+    if (auto cast = dynamic_cast<CastExprNode*>(&node)) {
+        K kind = requireNumeric(cast->type.get(), "cast type");
+        convert(expression(*cast->expression), kind);
+        return kind;
+    }
+    if (auto call = dynamic_cast<CallExprNode*>(&node)) {
+        auto callee = dynamic_cast<IdentifierExprNode*>(call->callee.get());
+        if (!callee) throw Unsupported{"indirect call"};
+        auto it = functions.find(callee->name);
+        if (it == functions.end()) throw Unsupported{"calls undefined function " + callee->name};
+        FuncDeclNode& target = *it->second;
+        if (target.params.size() != call->arguments.size()) throw Unsupported{"wrong argument count for " + callee->name};
+        for (size_t i = 0; i < call->arguments.size(); ++i) {
+            K kind = requireNumeric(target.params[i]->type.get(), "parameter of " + callee->name);
+            convert(expression(*call->arguments[i]), kind);
+        }
+        int32_t index = 0;
+        while (index < static_cast<int32_t>(out.callees.size()) && out.callees[index] != callee->name) ++index;
+        if (index == static_cast<int32_t>(out.callees.size())) out.callees.push_back(callee->name);
+        emit(Op::Call, index, static_cast<int32_t>(call->arguments.size()));
+        return requireNumeric(target.return_type.get(), "return type of " + callee->name, true);
+    }
+    throw Unsupported{"unsupported expression " + exprToString(node)};
+}
+
+void optimizeBytecode(BytecodeFunction& func) {
+    std::vector<Instr>& code = func.code;
+    std::vector<bool> removed(code.size(), false);
+    bool changed = true;
+    while (changed) {
+        changed = peephole(code, removed);
+        changed = removeUnreachable(code, removed) || changed;
+    }
+
+    // Уплотнение: переход на удалённую инструкцию ведёт к следующей живой
+    std::vector<int32_t> remap(code.size() + 1);
+    std::vector<Instr> compact;
+    std::vector<int32_t> lines;
+    bool hasLines = func.lines.size() == code.size();
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        remap[pc] = static_cast<int32_t>(compact.size());
+        if (removed[pc]) continue;
+        compact.push_back(code[pc]);
+        if (hasLines) lines.push_back(func.lines[pc]);
+    }
+    remap[code.size()] = static_cast<int32_t>(compact.size());
+    for (Instr& in : compact) {
+        if (isJump(in.op)) in.a = remap[in.a];
+    }
+    code = std::move(compact);
+    if (hasLines) func.lines = std::move(lines);
+    func.max_stack = maxStack(func);
+}
+
+const char* opName(Op op) {
+    static const char* names[kOpCount] = {"const", "load", "store", "dup", "pop", "add", "sub", "mul",
+                                            "div",   "mod",  "neg",   "not", "lt",  "le",  "gt",  "ge",
+                                            "eq",    "ne",   "jmp",   "jz",  "jnz", "call", "ret", "inc",
+                                            "cmpjz", "exit", "deopt", "constk", "convert",
+                                            "addu", "subu", "mulu", "divu", "modu", "negu",
+                                            "addl", "subl", "mull", "divl", "modl", "negl", "divul", "modul",
+                                            "addd", "subd", "muld", "divd", "negd",
+                                            "ltu", "leu", "gtu", "geu", "ltd", "led", "gtd", "ged", "eqd", "ned"};
+    return names[static_cast<size_t>(op)];
+}
+
+void disassemble(const BytecodeFunction& func, std::ostream& out) {
+    static const char* kinds[] = {"void", "bool", "char", "uchar", "short", "ushort", "int",
+                                  "uint", "long", "ulong", "float", "double"};
+    out << func.name << " (" << func.param_count << " params, frame " << func.frame_size << "):" << std::endl;
+    for (size_t pc = 0; pc < func.code.size(); ++pc) {
+        const Instr& in = func.code[pc];
+        out << "  " << pc << ": " << opName(in.op);
+        switch (in.op) {
+        case Op::Const: case Op::Load: case Op::Store: case Op::Jmp: case Op::Jz: case Op::Jnz:
+        case Op::Deopt:
+            out << " " << in.a;
+            break;
+        case Op::Call:
+            out << " " << func.callees[in.a] << "/" << in.b;
+            break;
+        case Op::Inc:
+            out << " " << in.a << ", " << in.b;
+            break;
+        case Op::CmpJz:
+            out << " " << opName(static_cast<Op>(in.b)) << " " << in.a;
+            break;
+        case Op::ConstK:
+            if (isFloating(static_cast<K>(in.b))) out << " " << func.constants[in.a].f;
+            else out << " " << func.constants[in.a].i;
+            break;
+        case Op::Convert:
+            out << " " << kinds[in.a] << " -> " << kinds[in.b];
+            break;
+        default:
+            break;
+        }
+        out << std::endl;
+    }
+}
+
+Slot toSlot(const Value& v, Value::Kind kind) {
+    Value c = convertTo(v, kind);
+    Slot r;
+    if (c.isFloating()) r.f = c.f;
+    else r.i = c.i;
+    return r;
+}
+
+Value fromSlot(Slot v, Value::Kind kind) {
+    if (isFloating(kind)) return Value::floating(kind, v.f);
+    if (isNumeric(kind)) return Value::integer(kind, v.i);
+    return Value();
+}
@@ -0,0 +1,693 @@
+#include "../inc/c_emit.hpp"
+#include "../inc/ast_utils.hpp"
+#include "../inc/value.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+std::string quote(const std::string& text) {
+    std::string r = "\"";
+    for (unsigned char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            r += '\\';
+            r += static_cast<char>(ch);
+        } else if (ch == '\n') {
+            r += "\\n";
+        } else if (ch == '\t') {
+            r += "\\t";
+        } else if (ch < 0x20 || ch >= 0x7F) {
+            char buf[8];
+            std::snprintf(buf, sizeof buf, "\\%03o", ch);
+            r += buf;
+        } else {
+            r += static_cast<char>(ch);
+        }
+    }
+    return r + "\"";
+}
+
+Value::Kind kindOfType(const std::shared_ptr<Type>& type) {
+    auto builtin = std::dynamic_pointer_cast<BuiltinType>(type);
+    return builtin ? kindOf(builtin->name, builtin->is_unsigned) : Value::Kind::Void;
+}
+
+Value::Kind kindOfNode(ASTNode& node) {
+    auto expr = dynamic_cast<ExprNode*>(&node);
+    if (!expr || !expr->resolved_type) throw CEmitError("expression without a type: " + exprToString(node));
+    return kindOfType(expr->resolved_type);
+}
+
+std::string cScalar(Value::Kind kind) {
+    using K = Value::Kind;
+    switch (kind) {
+    case K::Bool: return "bool";
+    case K::Char: return "int8_t";
+    case K::UChar: return "uint8_t";
+    case K::Short: return "int16_t";
+    case K::UShort: return "uint16_t";
+    case K::Int: return "int32_t";
+    case K::UInt: return "uint32_t";
+    case K::Long: return "int64_t";
+    case K::ULong: return "uint64_t";
+    case K::Float: return "float";
+    case K::Double: return "double";
+    case K::String: return "const char*";
+    default: return "";
+    }
+}
+
+} // namespace
+
+std::string CEmitVisitor::emit(TranslationUnitNode& unit) {
+    out.str("");
+    globalInit.str("");
+    for (auto& decl : unit.declarations) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(decl.get()); func && func->body) functions[func->name] = func;
+        else if (auto st = dynamic_cast<StructDeclNode*>(decl.get())) structs[st->name] = st;
+    }
+    if (!functions.count("main")) throw CEmitError("Function main is not defined");
+
+    out << cRuntimeHeader() << "\n";
+    unit.accept(*this);
+
+    out << "static void rt_init_globals(void) {\n" << globalInit.str() << "}\n\n";
+    auto mainType = dynamic_cast<TypeNode*>(functions["main"]->return_type.get());
+    Value::Kind mainKind = kindOf(mainType->type_name, mainType->is_unsigned);
+    bool integerMain = mainKind >= Value::Kind::Bool && mainKind <= Value::Kind::ULong;
+    out << "int main(void) {\n";
+    out << "    rt_init_globals();\n";
+    out << (integerMain ? "    int code = (int)fn_main();\n" : "    fn_main();\n    int code = 0;\n");
+    out << "    fflush(stdout);\n";
+    out << "    return code;\n";
+    out << "}\n";
+    return out.str();
+}
+
+void CEmitVisitor::indent() {
+    for (int i = 0; i < indentLevel; ++i) code() << "    ";
+}
+
+void CEmitVisitor::expr(ASTNode& node) {
+    node.accept(*this);
+}
+
+// Оператор с отступом и переводом строки
+void CEmitVisitor::statement(ASTNode& node) {
+    if (dynamic_cast<ExprNode*>(&node)) {
+        indent();
+        expr(node);
+        code() << ";\n";
+        return;
+    }
+    if (dynamic_cast<BlockStatementNode*>(&node)) {
+        indent();
+        node.accept(*this);
+        code() << "\n";
+        return;
+    }
+    node.accept(*this);
+}
+
+// Тело ветки или цикла всегда оформляется блоком
+void CEmitVisitor::nested(ASTNode& node) {
+    if (dynamic_cast<BlockStatementNode*>(&node)) {
+        node.accept(*this);
+        return;
+    }
+    code() << "{\n";
+    ++indentLevel;
+    arrays.emplace_back();
+    statement(node);
+    arrays.pop_back();
+    --indentLevel;
+    indent();
+    code() << "}";
+}
+
+bool CEmitVisitor::isArray(const std::string& name) const {
+    for (auto scope = arrays.rbegin(); scope != arrays.rend(); ++scope) {
+        if (scope->count(name)) return true;
+        if (scope->count("!" + name)) return false; // скаляр перекрывает внешний массив
+    }
+    return false;
+}
+
+std::string CEmitVisitor::cType(TypeNode& type) {
+    if (structs.count(type.type_name)) return "struct s_" + type.type_name;
+    if (type.type_name == "void") return "void";
+    std::string t = cScalar(kindOf(type.type_name, type.is_unsigned));
+    if (t.empty()) throw CEmitError("unknown type " + type.type_name);
+    return t;
+}
+
+std::string CEmitVisitor::cType(const std::shared_ptr<Type>& type) {
+    if (auto st = std::dynamic_pointer_cast<StructType>(type)) return "struct s_" + st->name;
+    std::string t = cScalar(kindOfType(type));
+    if (t.empty()) throw CEmitError("unsupported type " + (type ? type->toString() : std::string("<none>")));
+    return t;
+}
+
+std::string CEmitVisitor::signature(FuncDeclNode& func) {
+    std::string r = cType(*dynamic_cast<TypeNode*>(func.return_type.get())) + " fn_" + func.name + "(";
+    if (func.params.empty()) r += "void";
+    for (size_t i = 0; i < func.params.size(); ++i) {
+        auto& p = func.params[i];
+        if (p->declarator->is_array) throw CEmitError("array parameter " + p->declarator->name + " is not supported");
+        r += (i ? ", " : "") + cType(*dynamic_cast<TypeNode*>(p->type.get())) + " v_" + p->declarator->name;
+    }
+    return r + ")";
+}
+
+// Целочисленное деление идёт через runtime: проверка нуля и INT_MIN / -1
+std::string CEmitVisitor::divide(const std::string& op, ASTNode& left, ASTNode& right) {
+    using K = Value::Kind;
+    K kind = std::max({kindOfNode(left), kindOfNode(right), K::Int});
+    if (kind == K::Float || kind == K::Double) {
+        if (op == "%") throw CEmitError("operator % is not defined for floating values");
+        return "";
+    }
+    std::string suffix = kind == K::Int ? "i32" : kind == K::UInt ? "u32" : kind == K::Long ? "i64" : "u64";
+    return std::string(op == "/" ? "rt_div_" : "rt_mod_") + suffix;
+}
+
+void CEmitVisitor::visit(TranslationUnitNode& node) {
+    arrays.assign(1, {});
+    for (auto& decl : node.declarations) {
+        if (dynamic_cast<StructDeclNode*>(decl.get())) decl->accept(*this);
+    }
+    // Прототипы в порядке исходного текста: допускают взаимную рекурсию
+    for (auto& decl : node.declarations) {
+        auto func = dynamic_cast<FuncDeclNode*>(decl.get());
+        if (!func || !func->body) continue;
+        out << signature(*func) << ";\n";
+    }
+    out << "\n";
+    for (auto& decl : node.declarations) {
+        if (dynamic_cast<VarDeclNode*>(decl.get())) decl->accept(*this);
+    }
+    out << "\n";
+    for (auto& decl : node.declarations) {
+        if (dynamic_cast<FuncDeclNode*>(decl.get())) decl->accept(*this);
+    }
+}
+
+void CEmitVisitor::visit(TypeNode& node) {}
+void CEmitVisitor::visit(DeclaratorNode& node) {}
+void CEmitVisitor::visit(InitDeclaratorNode& node) {}
+void CEmitVisitor::visit(ParamDeclNode& node) {}
+
+void CEmitVisitor::visit(NamespaceDeclNode& node) {
+    // Как и интерпретатор, содержимое пространств имён не исполняется
+    out << "/* namespace " << node.name << " is not emitted */\n";
+}
+
+void CEmitVisitor::visit(StructDeclNode& node) {
+    out << "struct s_" << node.name << " {\n";
+    if (node.members.empty()) out << "    char unused_;\n";
+    for (auto& member : node.members) {
+        std::string t = cType(*dynamic_cast<TypeNode*>(member->type.get()));
+        for (auto& d : member->declarators) {
+            out << "    " << t << " m_" << d->declarator->name;
+            if (d->declarator->array_size) {
+                auto size = intLiteralValue(d->declarator->array_size.get());
+                if (!size) throw CEmitError("array member " + d->declarator->name + " needs a constant size");
+                out << "[" << *size << "]";
+            }
+            out << ";\n";
+        }
+    }
+    out << "};\n\n";
+}
+
+void CEmitVisitor::visit(FuncDeclNode& node) {
+    if (!node.body) return;
+    currentFunction = &node;
+    auto retType = dynamic_cast<TypeNode*>(node.return_type.get());
+    out << signature(node) << " {\n";
+    indentLevel = 1;
+    arrays.emplace_back();
+    for (auto& p : node.params) arrays.back().insert("!" + p->declarator->name);
+
+    // В C тело функции — та же область видимости, что и параметры;
+    // если тело перекрывает параметр, оно оформляется вложенным блоком
+    auto body = dynamic_cast<BlockStatementNode*>(node.body.get());
+    bool shadows = false;
+    for (auto& stmt : body->statements) {
+        if (auto var = dynamic_cast<VarDeclNode*>(stmt.get())) {
+            for (auto& d : var->declarators) {
+                for (auto& p : node.params) shadows = shadows || p->declarator->name == d->declarator->name;
+            }
+        }
+    }
+    if (shadows) {
+        statement(*body);
+    } else {
+        for (auto& stmt : body->statements) statement(*stmt);
+    }
+
+    // Функция без return возвращает нулевое значение, как в интерпретаторе
+    if (structs.count(retType->type_name)) out << "    return (" << cType(*retType) << "){0};\n";
+    else if (retType->type_name != "void") out << "    return 0;\n";
+    arrays.pop_back();
+    indentLevel = 0;
+    out << "}\n\n";
+    currentFunction = nullptr;
+}
+
+void CEmitVisitor::visit(VarDeclNode& node) {
+    auto type = dynamic_cast<TypeNode*>(node.type.get());
+    for (auto& d : node.declarators) declare(*type, *d);
+}
+
+// Объявление всегда обнуляет переменную; глобальные инициализируются в rt_init_globals
+void CEmitVisitor::declare(TypeNode& type, InitDeclaratorNode& decl) {
+    std::string t = cType(type);
+    std::string name = "v_" + decl.declarator->name;
+    bool global = currentFunction == nullptr;
+    bool isStruct = structs.count(type.type_name) != 0;
+    auto list = dynamic_cast<InitListNode*>(decl.initializer.get());
+
+    if (global) {
+        out << "static " << t << " " << name;
+        if (decl.declarator->array_size) {
+            auto size = intLiteralValue(decl.declarator->array_size.get());
+            if (!size) throw CEmitError("global array " + decl.declarator->name + " needs a constant size");
+            out << "[" << *size << "]";
+        }
+        out << ";\n";
+        inGlobalInit = true;
+        indentLevel = 1;
+    } else {
+        indent();
+        code() << t << " " << name;
+        if (decl.declarator->array_size) {
+            code() << "[rt_size(";
+            expr(*decl.declarator->array_size);
+            code() << ")];\n";
+        } else if (decl.initializer && !list) {
+            code() << " = ";
+            expr(*decl.initializer);
+            code() << ";\n";
+        } else if (!isStruct) {
+            code() << " = 0;\n";
+        } else {
+            code() << ";\n";
+        }
+        if (decl.declarator->array_size || (isStruct && (!decl.initializer || list))) {
+            indent();
+            code() << "memset(&" << name << ", 0, sizeof " << name << ");\n";
+        }
+    }
+
+    if (decl.declarator->array_size) {
+        arrays.back().insert(decl.declarator->name);
+        arrays.back().erase("!" + decl.declarator->name);
+        if (list) {
+            for (size_t k = 0; k < list->elements.size(); ++k) {
+                indent();
+                code() << name << "[rt_index(" << k << ", RT_LEN(" << name << "))] = ";
+                expr(*list->elements[k]);
+                code() << ";\n";
+            }
+        }
+    } else {
+        arrays.back().insert("!" + decl.declarator->name);
+        arrays.back().erase(decl.declarator->name);
+        if (list) {
+            // Инициализация структуры по порядку полей
+            if (!isStruct) throw CEmitError("initializer list for scalar " + decl.declarator->name);
+            size_t k = 0;
+            for (auto& member : structs[type.type_name]->members) {
+                for (auto& d : member->declarators) {
+                    if (k >= list->elements.size()) break;
+                    indent();
+                    code() << name << ".m_" << d->declarator->name << " = ";
+                    expr(*list->elements[k++]);
+                    code() << ";\n";
+                }
+            }
+        } else if (global && decl.initializer) {
+            indent();
+            code() << name << " = ";
+            expr(*decl.initializer);
+            code() << ";\n";
+        }
+    }
+
+    if (global) {
+        inGlobalInit = false;
+        indentLevel = 0;
+    }
+}
+
+void CEmitVisitor::visit(BlockStatementNode& node) {
+    code() << "{\n";
+    ++indentLevel;
+    arrays.emplace_back();
+    for (auto& stmt : node.statements) statement(*stmt);
+    arrays.pop_back();
+    --indentLevel;
+    indent();
+    code() << "}";
+}
+
+void CEmitVisitor::visit(IfStatementNode& node) {
+    indent();
+    code() << "if (";
+    expr(*node.condition);
+    code() << ") ";
+    nested(*node.then_branch);
+    if (node.else_branch) {
+        code() << " else ";
+        nested(*node.else_branch);
+    }
+    code() << "\n";
+}
+
+void CEmitVisitor::visit(WhileLoopNode& node) {
+    indent();
+    code() << "while (";
+    expr(*node.condition);
+    code() << ") ";
+    nested(*node.body);
+    code() << "\n";
+}
+
+void CEmitVisitor::visit(DoWhileLoopNode& node) {
+    indent();
+    code() << "do ";
+    nested(*node.body);
+    code() << " while (";
+    expr(*node.condition);
+    code() << ");\n";
+}
+
+void CEmitVisitor::visit(ForLoopNode& node) {
+    // Объявление в заголовке выносится в объемлющий блок
+    bool declInit = node.init && !dynamic_cast<ExprNode*>(node.init.get());
+    if (declInit) {
+        indent();
+        code() << "{\n";
+        ++indentLevel;
+        arrays.emplace_back();
+        statement(*node.init);
+    }
+    indent();
+    code() << "for (";
+    if (node.init && !declInit) expr(*node.init);
+    code() << "; ";
+    if (node.condition) expr(*node.condition);
+    code() << "; ";
+    if (node.increment) expr(*node.increment);
+    code() << ") ";
+    nested(*node.body);
+    code() << "\n";
+    if (declInit) {
+        arrays.pop_back();
+        --indentLevel;
+        indent();
+        code() << "}\n";
+    }
+}
+
+void CEmitVisitor::visit(ReturnStatementNode& node) {
+    indent();
+    code() << "return";
+    if (node.expression) {
+        code() << " ";
+        expr(*node.expression);
+    }
+    code() << ";\n";
+}
+
+void CEmitVisitor::visit(BreakStmtNode& node) {
+    indent();
+    code() << "break;\n";
+}
+
+void CEmitVisitor::visit(ContinueStmtNode& node) {
+    indent();
+    code() << "continue;\n";
+}
+
+void CEmitVisitor::visit(StaticAssertNode& node) {
+    indent();
+    code() << "if (!(";
+    expr(*node.condition);
+    code() << ")) rt_fail(" << quote("Static assertion failed: " + node.message) << ");\n";
+}
+
+void CEmitVisitor::visit(ReadStmtNode& node) {
+    ASTNode* target = node.argument.get();
+    if (auto un = dynamic_cast<UnaryExprNode*>(target); un && un->op == "&") target = un->operand.get();
+    Value::Kind kind = kindOfNode(*target);
+    const char* reader = kind == Value::Kind::Float || kind == Value::Kind::Double ? "rt_read_float()"
+                         : kind == Value::Kind::Char || kind == Value::Kind::UChar ? "rt_read_char()"
+                         : "rt_read_int()";
+    if (!cScalar(kind).size() || kind == Value::Kind::String) throw CEmitError("read() expects a scalar variable");
+    indent();
+    expr(*target);
+    code() << " = " << reader << ";\n";
+}
+
+void CEmitVisitor::visit(PrintStmtNode& node) {
+    using K = Value::Kind;
+    auto arg = dynamic_cast<ExprNode*>(node.argument.get());
+    indent();
+    if (auto st = std::dynamic_pointer_cast<StructType>(arg ? arg->resolved_type : nullptr)) {
+        code() << "rt_print_str(" << quote("<struct " + st->name + ">") << ");\n";
+        return;
+    }
+    K kind = kindOfNode(*node.argument);
+    const char* printer = kind == K::Bool ? "rt_print_bool"
+                          : kind == K::Char || kind == K::UChar ? "rt_print_char"
+                          : kind == K::ULong ? "rt_print_uint"
+                          : kind == K::Float || kind == K::Double ? "rt_print_float"
+                          : kind == K::String ? "rt_print_str"
+                          : "rt_print_int";
+    if (kind == K::Void) throw CEmitError("print() of a value without type");
+    code() << printer << "(";
+    expr(*node.argument);
+    code() << ");\n";
+}
+
+void CEmitVisitor::visit(BinaryExprNode& node) {
+    if (node.op == "/" || node.op == "%") {
+        std::string fn = divide(node.op, *node.left, *node.right);
+        if (!fn.empty()) {
+            code() << fn << "(";
+            expr(*node.left);
+            code() << ", ";
+            expr(*node.right);
+            code() << ")";
+            return;
+        }
+    }
+    code() << "(";
+    expr(*node.left);
+    code() << " " << node.op << " ";
+    expr(*node.right);
+    code() << ")";
+}
+
+void CEmitVisitor::visit(UnaryExprNode& node) {
+    if (node.op == "&") {
+        expr(*node.operand);
+        return;
+    }
+    if (node.op != "-" && node.op != "+" && node.op != "!" && node.op != "++" && node.op != "--") {
+        throw CEmitError("unsupported unary operator " + node.op);
+    }
+    code() << "(" << node.op;
+    expr(*node.operand);
+    code() << ")";
+}
+
+void CEmitVisitor::visit(TernaryExprNode& node) {
+    code() << "(";
+    expr(*node.condition);
+    code() << " ? ";
+    expr(*node.then_expr);
+    code() << " : ";
+    expr(*node.else_expr);
+    code() << ")";
+}
+
+void CEmitVisitor::visit(CastExprNode& node) {
+    code() << "((" << cType(*dynamic_cast<TypeNode*>(node.type.get())) << ")";
+    expr(*node.expression);
+    code() << ")";
+}
+
+void CEmitVisitor::visit(SubscriptExprNode& node) {
+    expr(*node.array);
+    if (!node.checked) {
+        // Оптимизатор доказал, что индекс в границах
+        code() << "[";
+        expr(*node.index);
+        code() << "]";
+        return;
+    }
+    // Массив повторяется внутри sizeof, где он не вычисляется
+    code() << "[rt_index(";
+    expr(*node.index);
+    code() << ", RT_LEN(";
+    expr(*node.array);
+    code() << "))]";
+}
+
+void CEmitVisitor::visit(CallExprNode& node) {
+    auto callee = dynamic_cast<IdentifierExprNode*>(node.callee.get());
+    if (!callee || !functions.count(callee->name)) {
+        throw CEmitError("Call to undefined function " + (callee ? callee->name : exprToString(*node.callee)));
+    }
+    code() << "fn_" << callee->name << "(";
+    for (size_t i = 0; i < node.arguments.size(); ++i) {
+        auto id = dynamic_cast<IdentifierExprNode*>(node.arguments[i].get());
+        if (id && isArray(id->name)) throw CEmitError("array " + id->name + " cannot be passed to a function");
+        if (i) code() << ", ";
+        expr(*node.arguments[i]);
+    }
+    code() << ")";
+}
+
+void CEmitVisitor::visit(LiteralExprNode& node) {
+    auto type = dynamic_cast<TypeNode*>(node.type.get());
+    if (type->type_name == "int") {
+        auto value = intLiteralValue(&node);
+        if (value && *value > INT32_MAX) code() << "INT64_C(" << node.value << ")";
+        else code() << node.value;
+    } else if (type->type_name == "float") {
+        code() << "((float)" << node.value << ")";
+    } else if (type->type_name == "char") {
+        code() << "((int8_t)" << static_cast<int>(static_cast<signed char>(node.value.empty() ? 0 : node.value[0])) << ")";
+    } else {
+        code() << quote(node.value);
+    }
+}
+
+void CEmitVisitor::visit(IdentifierExprNode& node) {
+    code() << "v_" << node.name;
+}
+
+void CEmitVisitor::visit(ScopedIdentifierExprNode& node) {
+    code() << "v_" << node.getName();
+}
+
+void CEmitVisitor::visit(GroupExprNode& node) {
+    code() << "(";
+    expr(*node.expression);
+    code() << ")";
+}
+
+void CEmitVisitor::visit(PostfixExprNode& node) {
+    code() << "(";
+    expr(*node.expr);
+    code() << node.op << ")";
+}
+
+void CEmitVisitor::visit(InitListNode& node) {
+    throw CEmitError("initializer list outside of a declaration");
+}
+
+void CEmitVisitor::visit(SizeofExprNode& node) {
+    // Размер посчитан семантическим анализом по той же раскладке, что у C
+    if (node.size < 0) throw CEmitError("sizeof of unchecked expression");
+    code() << node.size;
+}
+
+void CEmitVisitor::visit(ExitExprNode& node) {
+    code() << "rt_exit(";
+    if (node.arguments.empty()) {
+        code() << "0";
+    } else {
+        code() << "(int)";
+        expr(*node.arguments[0]);
+    }
+    code() << ")";
+}
+
+void CEmitVisitor::visit(AssertExprNode& node) {
+    code() << "rt_assert(";
+    if (node.arguments.empty()) {
+        code() << "1";
+    } else {
+        code() << "(";
+        expr(*node.arguments[0]);
+        code() << ") != 0";
+    }
+    code() << ")";
+}
+
+void CEmitVisitor::visit(AssignmentExprNode& node) {
+    if (node.op == "/=" || node.op == "%=") {
+        std::string fn = divide(node.op.substr(0, 1), *node.left, *node.right);
+        if (!fn.empty()) {
+            // Левая часть вычисляется один раз
+            code() << "({ __typeof__(";
+            expr(*node.left);
+            code() << ")* p_ = &(";
+            expr(*node.left);
+            code() << "); *p_ = " << fn << "(*p_, ";
+            expr(*node.right);
+            code() << "); })";
+            return;
+        }
+    }
+    code() << "(";
+    expr(*node.left);
+    code() << " " << node.op << " ";
+    expr(*node.right);
+    code() << ")";
+}
+
+void CEmitVisitor::visit(MemberAccessExprNode& node) {
+    code() << "(";
+    expr(*node.object);
+    code() << ").m_" << node.member;
+}
+
+bool compileNative(const std::string& source, const std::string& output, std::string& error) {
+    char path[] = "/tmp/interpret-XXXXXX.c";
+    int fd = mkstemps(path, 2);
+    if (fd < 0) {
+        error = "cannot create a temporary file";
+        return false;
+    }
+    bool written = write(fd, source.data(), source.size()) == static_cast<ssize_t>(source.size());
+    close(fd);
+    if (!written) {
+        unlink(path);
+        error = "cannot write " + std::string(path);
+        return false;
+    }
+
+    const char* cc = std::getenv("CC");
+    if (!cc || !*cc) cc = "cc";
+    std::vector<std::string> args = {cc, "-std=gnu11", "-O2", "-fwrapv", "-o", output, path};
+    std::vector<char*> argv;
+    for (auto& a : args) argv.push_back(a.data());
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    int status = 0;
+    if (posix_spawnp(&pid, cc, nullptr, nullptr, argv.data(), environ) != 0) {
+        unlink(path);
+        error = std::string("cannot run C compiler ") + cc;
+        return false;
+    }
+    waitpid(pid, &status, 0);
+    unlink(path);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        error = std::string("C compiler ") + cc + " failed";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,109 @@
+#include "../inc/c_emit.hpp"
+
+// Runtime сгенерированного C: сообщения об ошибках совпадают с интерпретатором
+const char* cRuntimeHeader() {
+    return R"RT(/* interpret C runtime */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline void rt_fail(const char* msg) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime Error: %s\n", msg);
+    exit(1);
+}
+
+static inline void rt_exit(int code) {
+    fflush(stdout);
+    exit(code);
+}
+
+static inline void rt_assert(int cond) {
+    if (!cond) rt_fail("Assertion failed");
+}
+
+static inline int32_t rt_div_i32(int32_t a, int32_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return b == -1 ? (int32_t)(0u - (uint32_t)a) : a / b;
+}
+
+static inline int32_t rt_mod_i32(int32_t a, int32_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return b == -1 ? 0 : a % b;
+}
+
+static inline int64_t rt_div_i64(int64_t a, int64_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return b == -1 ? (int64_t)(0u - (uint64_t)a) : a / b;
+}
+
+static inline int64_t rt_mod_i64(int64_t a, int64_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return b == -1 ? 0 : a % b;
+}
+
+static inline uint32_t rt_div_u32(uint32_t a, uint32_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return a / b;
+}
+
+static inline uint32_t rt_mod_u32(uint32_t a, uint32_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return a % b;
+}
+
+static inline uint64_t rt_div_u64(uint64_t a, uint64_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return a / b;
+}
+
+static inline uint64_t rt_mod_u64(uint64_t a, uint64_t b) {
+    if (b == 0) rt_fail("Division by zero");
+    return a % b;
+}
+
+#define RT_LEN(a) ((int64_t)(sizeof(a) / sizeof((a)[0])))
+
+static inline int64_t rt_index(int64_t i, int64_t n) {
+    if (i < 0 || i >= n) {
+        char msg[96];
+        snprintf(msg, sizeof msg, "Array index %lld out of bounds [0, %lld)", (long long)i, (long long)n);
+        rt_fail(msg);
+    }
+    return i;
+}
+
+static inline int64_t rt_size(int64_t n) {
+    if (n < 0) rt_fail("Invalid array size");
+    return n;
+}
+
+static inline void rt_print_int(int64_t v) { printf("%lld\n", (long long)v); }
+static inline void rt_print_uint(uint64_t v) { printf("%llu\n", (unsigned long long)v); }
+static inline void rt_print_char(int v) { printf("%c\n", (char)v); }
+static inline void rt_print_bool(int v) { puts(v ? "true" : "false"); }
+static inline void rt_print_float(double v) { printf("%g\n", v); }
+static inline void rt_print_str(const char* s) { puts(s); }
+
+static inline int64_t rt_read_int(void) {
+    long long v;
+    if (scanf("%lld", &v) != 1) rt_fail("Failed to read input");
+    return v;
+}
+
+static inline double rt_read_float(void) {
+    double v;
+    if (scanf("%lf", &v) != 1) rt_fail("Failed to read input");
+    return v;
+}
+
+static inline char rt_read_char(void) {
+    char c;
+    if (scanf(" %c", &c) != 1) rt_fail("Failed to read input");
+    return c;
+}
+/* end of runtime */
+)RT";
+}
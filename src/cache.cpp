@@ -0,0 +1,147 @@
+#include "../inc/cache.hpp"
+#include "../inc/trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Два независимых 64-битных хеша FNV-1a дают 128-битный ключ
+struct Hash {
+    uint64_t a = 14695981039346656037ull;
+    uint64_t b = 0x6c62272e07bb0142ull;
+
+    void add(std::string_view text) {
+        for (unsigned char c : text) {
+            a = (a ^ c) * 1099511628211ull;
+            b = (b ^ c) * 0x100000001b3ull + 0x9e3779b97f4a7c15ull;
+        }
+    }
+    void add(uint64_t v) { add(std::string_view(reinterpret_cast<const char*>(&v), sizeof v)); }
+};
+
+// Пересборка интерпретатора меняет исполняемый файл и делает старые записи недействительными
+void addVersion(Hash& h) {
+    h.add(ImageHeader::kVersion);
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        h.add(static_cast<uint64_t>(st.st_size));
+        h.add(static_cast<uint64_t>(st.st_mtim.tv_sec));
+        h.add(static_cast<uint64_t>(st.st_mtim.tv_nsec));
+    }
+}
+
+bool makeDirs(const std::string& dir) {
+    for (size_t k = 1; k <= dir.size(); ++k) {
+        if (k < dir.size() && dir[k] != '/') continue;
+        std::string part = dir.substr(0, k);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+CompileCache::CompileCache(std::string dir, uint64_t limit) : dir(std::move(dir)), limit(limit) {}
+
+std::string CompileCache::defaultDir() {
+    if (const char* dir = std::getenv("INTERPRET_CACHE_DIR"); dir && *dir) return dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) return std::string(xdg) + "/interpret";
+    if (const char* home = std::getenv("HOME"); home && *home) return std::string(home) + "/.cache/interpret";
+    return "";
+}
+
+std::string CompileCache::key(const std::string& source, bool optimize) {
+    Hash h;
+    addVersion(h);
+    h.add(static_cast<uint64_t>(optimize));
+    h.add(static_cast<uint64_t>(source.size()));
+    h.add(source);
+    char text[33];
+    std::snprintf(text, sizeof text, "%016llx%016llx", static_cast<unsigned long long>(h.a),
+                  static_cast<unsigned long long>(h.b));
+    return text;
+}
+
+std::string CompileCache::path(const std::string& key) const {
+    return dir + "/" + key + ".ibc";
+}
+
+std::optional<ProgramImage> CompileCache::load(const std::string& key) {
+    Trace::Span span("cache", "load");
+    if (dir.empty()) return std::nullopt;
+    std::string file = path(key);
+    if (access(file.c_str(), R_OK) != 0) return std::nullopt;
+    try {
+        ProgramImage image = loadImage(file);
+        // Время изменения — время последнего использования для вытеснения
+        utimensat(AT_FDCWD, file.c_str(), nullptr, 0);
+        return image;
+    } catch (const ImageError&) {
+        // Испорченная или чужая запись: удаляется и будет пересобрана
+        unlink(file.c_str());
+        return std::nullopt;
+    }
+}
+
+void CompileCache::store(const std::string& key, TranslationUnitNode& program, const std::string& notes) {
+    Trace::Span span("cache", "store");
+    if (dir.empty() || !makeDirs(dir)) return;
+    std::string file = path(key);
+    std::string tmp = file + ".tmp." + std::to_string(getpid());
+    try {
+        writeImage(program, tmp, notes);
+    } catch (const ImageError&) {
+        unlink(tmp.c_str());
+        return;
+    }
+    if (rename(tmp.c_str(), file.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return;
+    }
+    evict();
+}
+
+void CompileCache::evict() {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        timespec used;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    while (dirent* e = readdir(d)) {
+        std::string_view name = e->d_name;
+        std::string file = dir + "/" + e->d_name;
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        // Временный файл живого процесса не трогаем, брошенный упавшим — удаляем
+        if (name.find(".ibc.tmp.") != std::string_view::npos) {
+            if (st.st_mtim.tv_sec + 3600 < time(nullptr)) unlink(file.c_str());
+            continue;
+        }
+        if (!name.ends_with(".ibc")) continue;
+        entries.push_back({file, static_cast<uint64_t>(st.st_size), st.st_mtim});
+        total += static_cast<uint64_t>(st.st_size);
+    }
+    closedir(d);
+    if (total <= limit) return;
+    std::sort(entries.begin(), entries.end(), [](const Entry& x, const Entry& y) {
+        return x.used.tv_sec != y.used.tv_sec ? x.used.tv_sec < y.used.tv_sec : x.used.tv_nsec < y.used.tv_nsec;
+    });
+    // Самая новая запись (только что записанная) остаётся, даже если она больше limit
+    for (size_t k = 0; k + 1 < entries.size() && total > limit; ++k) {
+        if (unlink(entries[k].path.c_str()) == 0) total -= entries[k].size;
+    }
+}
@@ -0,0 +1,68 @@
+#include "../inc/compilation.hpp"
+#include "../inc/lexer.hpp"
+#include "../inc/parser.hpp"
+#include "../inc/sema.hpp"
+#include "../inc/inliner.hpp"
+#include "../inc/loop_opt.hpp"
+#include "../inc/const_fold.hpp"
+#include "../inc/regalloc.hpp"
+#include "../inc/constant_pool.hpp"
+#include "../inc/trace.hpp"
+
+Compilation::Compilation(std::string source) : source(std::move(source)) {}
+
+bool Compilation::lex() {
+    Trace::Span span("compile", "lex");
+    Lexer lexer(source);
+    tokens = lexer.tokenize();
+    counters.bytes = source.size();
+    counters.tokens = tokens.size();
+    errors.insert(errors.end(), lexer.getErrors().begin(), lexer.getErrors().end());
+    return !lexer.hasErrors();
+}
+
+bool Compilation::parse() {
+    Trace::Span span("compile", "parse");
+    Parser parser(tokens);
+    ast = parser.parse();
+    errors.insert(errors.end(), parser.getErrors().begin(), parser.getErrors().end());
+    return !parser.hasErrors();
+}
+
+bool Compilation::analyze() {
+    if (!ast) return false;
+    Trace::Span span("compile", "sema");
+    SemanticAnalyzer sema;
+    sema.analyze(*ast);
+    counters.scopes = sema.getScopeCount();
+    counters.symbols = sema.getSymbolCount();
+    counters.functions = sema.getFunctionCount();
+    counters.types = sema.getTypeCount();
+    errors.insert(errors.end(), sema.getErrors().begin(), sema.getErrors().end());
+    return !sema.hasErrors();
+}
+
+void prepareProgram(TranslationUnitNode& unit, bool optimize, std::ostream* report) {
+    Trace::Span span("compile", "optimize");
+    if (optimize) {
+        Inliner inliner;
+        inliner.run(unit);
+        LoopOptimizer loops;
+        loops.optimize(unit);
+        ConstantFolder folder;
+        folder.run(unit);
+        if (report) {
+            inliner.printReport(*report);
+            loops.printReport(*report);
+        }
+    }
+
+    FrameAllocator frames;
+    frames.run(unit);
+    if (report) frames.printReport(*report);
+
+    // Литералы разбираются один раз, после всех преобразований дерева
+    unit.constants = std::make_shared<ConstantPool>();
+    unit.constants->run(unit);
+    if (report) unit.constants->printReport(*report);
+}
@@ -0,0 +1,173 @@
+#include "../inc/const_fold.hpp"
+#include "../inc/ast_utils.hpp"
+#include <cstdint>
+
+namespace {
+
+std::optional<long long> evalBinary(const std::string& op, long long l, long long r) {
+    auto wrap = [](long long v) { return static_cast<long long>(static_cast<int32_t>(static_cast<uint32_t>(v))); };
+    if (op == "+") return wrap(l + r);
+    if (op == "-") return wrap(l - r);
+    if (op == "*") return wrap(static_cast<long long>(static_cast<uint32_t>(l) * static_cast<uint32_t>(r)));
+    if (op == "/" || op == "%") {
+        if (r == 0 || (l == INT32_MIN && r == -1)) return std::nullopt; // оставляем ошибку до исполнения
+        return op == "/" ? l / r : l % r;
+    }
+    if (op == "<") return l < r;
+    if (op == "<=") return l <= r;
+    if (op == ">") return l > r;
+    if (op == ">=") return l >= r;
+    if (op == "==") return l == r;
+    if (op == "!=") return l != r;
+    if (op == "&&") return l && r;
+    if (op == "||") return l || r;
+    return std::nullopt;
+}
+
+} // namespace
+
+void ConstantFolder::run(ASTNode& root) {
+    collectGlobals(root);
+    walk(root, [&](ASTNode& node) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(&node)) runOnFunction(*func);
+    });
+}
+
+void ConstantFolder::collectGlobals(ASTNode& root) {
+    if (auto tu = dynamic_cast<TranslationUnitNode*>(&root)) {
+        for (auto& decl : tu->declarations) {
+            if (auto var = dynamic_cast<VarDeclNode*>(decl.get())) {
+                for (auto& d : var->declarators) globals.insert(d->declarator->name);
+            }
+        }
+    }
+}
+
+void ConstantFolder::runOnFunction(FuncDeclNode& func) {
+    if (!func.body) return;
+    // Свёртка открывает новые константы для распространения и наоборот
+    for (int round = 0; round < 8; ++round) {
+        foldSlot(func.body);
+        if (!propagate(func)) break;
+    }
+}
+
+void ConstantFolder::foldSlot(std::unique_ptr<ASTNode>& slot) {
+    forEachSlot(*slot, [&](std::unique_ptr<ASTNode>& child) { foldSlot(child); });
+
+    if (auto group = dynamic_cast<GroupExprNode*>(slot.get())) {
+        if (intLiteralValue(group->expression.get())) {
+            slot = std::move(group->expression);
+            return;
+        }
+    }
+
+    if (auto bin = dynamic_cast<BinaryExprNode*>(slot.get())) {
+        auto l = intLiteralValue(bin->left.get());
+        auto r = intLiteralValue(bin->right.get());
+        if (l && r && isBuiltin(bin->resolved_type, "int")) {
+            if (auto value = evalBinary(bin->op, *l, *r)) {
+                slot = makeIntLiteral(*value);
+                ++folded;
+            }
+        }
+        return;
+    }
+
+    if (auto un = dynamic_cast<UnaryExprNode*>(slot.get())) {
+        auto v = intLiteralValue(un->operand.get());
+        if (v && (un->op == "-" || un->op == "!") && isBuiltin(un->resolved_type, "int")) {
+            long long value = un->op == "-" ? -*v : !*v;
+            if (value <= INT32_MAX) {
+                slot = makeIntLiteral(value);
+                ++folded;
+            }
+        }
+        return;
+    }
+
+    if (auto sub = dynamic_cast<SubscriptExprNode*>(slot.get())) {
+        // Константный индекс в пределах известной длины не проверяется
+        auto index = intLiteralValue(sub->index.get());
+        auto array = std::dynamic_pointer_cast<ArrayType>(static_cast<ExprNode*>(sub->array.get())->resolved_type);
+        if (index && array && *index >= 0 && static_cast<size_t>(*index) < array->length) sub->checked = false;
+        return;
+    }
+
+    if (auto tern = dynamic_cast<TernaryExprNode*>(slot.get())) {
+        if (auto cond = intLiteralValue(tern->condition.get())) {
+            slot = std::move(*cond ? tern->then_expr : tern->else_expr);
+            ++folded;
+        }
+        return;
+    }
+
+    if (auto branch = dynamic_cast<IfStatementNode*>(slot.get())) {
+        if (auto cond = intLiteralValue(branch->condition.get())) {
+            // Ветка остаётся в собственном блоке, чтобы не менять области видимости
+            std::vector<std::unique_ptr<ASTNode>> taken;
+            if (*cond) {
+                taken.push_back(std::move(branch->then_branch));
+            } else if (branch->else_branch) {
+                taken.push_back(std::move(branch->else_branch));
+            }
+            slot = std::make_unique<BlockStatementNode>(std::move(taken));
+            ++folded;
+        }
+    }
+}
+
+// Переменная с единственным определением — объявлением с целочисленной константой —
+// заменяется этой константой во всех чтениях
+bool ConstantFolder::propagate(FuncDeclNode& func) {
+    std::unordered_map<std::string, int> definitions;
+    std::unordered_map<std::string, long long> constants;
+
+    for (auto& param : func.params) definitions[param->declarator->name]++;
+    walk(*func.body, [&](ASTNode& node) {
+        if (auto var = dynamic_cast<VarDeclNode*>(&node)) {
+            for (auto& d : var->declarators) {
+                definitions[d->declarator->name]++;
+                auto value = intLiteralValue(d->initializer.get());
+                auto type = dynamic_cast<TypeNode*>(var->type.get());
+                if (value && !d->declarator->array_size && type && type->type_name == "int" && !type->is_unsigned) {
+                    constants[d->declarator->name] = *value;
+                }
+            }
+            return;
+        }
+        std::string written;
+        if (auto a = dynamic_cast<AssignmentExprNode*>(&node)) written = rootVariable(*a->left);
+        else if (auto p = dynamic_cast<PostfixExprNode*>(&node)) written = rootVariable(*p->expr);
+        else if (auto r = dynamic_cast<ReadStmtNode*>(&node); r && r->argument) written = rootVariable(*r->argument);
+        else if (auto u = dynamic_cast<UnaryExprNode*>(&node); u && (u->op == "++" || u->op == "--" || u->op == "&"))
+            written = rootVariable(*u->operand);
+        if (!written.empty()) definitions[written]++;
+    });
+
+    for (auto it = constants.begin(); it != constants.end();) {
+        if (definitions[it->first] != 1 || globals.count(it->first)) it = constants.erase(it);
+        else ++it;
+    }
+    if (constants.empty()) return false;
+
+    bool changed = false;
+    std::function<void(std::unique_ptr<ASTNode>&)> visit = [&](std::unique_ptr<ASTNode>& slot) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(slot.get())) {
+            auto it = constants.find(id->name);
+            if (it != constants.end()) {
+                slot = makeIntLiteral(it->second);
+                ++propagated;
+                changed = true;
+            }
+            return;
+        }
+        if (auto call = dynamic_cast<CallExprNode*>(slot.get())) {
+            for (auto& arg : call->arguments) visit(arg);
+            return;
+        }
+        forEachSlot(*slot, visit);
+    };
+    visit(func.body);
+    return changed;
+}
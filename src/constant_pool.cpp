@@ -0,0 +1,102 @@
+#include "../inc/constant_pool.hpp"
+#include "../inc/ast_utils.hpp"
+#include <charconv>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+std::optional<Value> ConstantPool::parse(const LiteralExprNode& lit) {
+    auto type = dynamic_cast<TypeNode*>(lit.type.get());
+    const std::string& text = lit.value;
+    const char* first = text.data();
+    const char* last = first + text.size();
+    if (!type) return std::nullopt;
+    if (type->type_name == "int") {
+        int64_t v = 0;
+        auto [ptr, ec] = std::from_chars(first, last, v);
+        if (ec != std::errc() || ptr != last) return std::nullopt;
+        return Value::integer(v > INT32_MAX ? Value::Kind::Long : Value::Kind::Int, v);
+    }
+    if (type->type_name == "float") {
+        double v = 0;
+        auto [ptr, ec] = std::from_chars(first, last, v);
+        if (ec != std::errc()) return std::nullopt;
+        return Value::floating(Value::Kind::Float, v);
+    }
+    if (type->type_name == "char") return Value::integer(Value::Kind::Char, text.empty() ? 0 : text[0]);
+    return std::nullopt;
+}
+
+void ConstantPool::run(ASTNode& root) {
+    values.clear();
+    blob.clear();
+    strings.clear();
+    literals = 0;
+
+    // Числа совпадают, если совпадают вид и биты значения
+    std::map<std::pair<Value::Kind, int64_t>, uint32_t> numbers;
+    std::unordered_map<std::string_view, uint32_t> texts;
+    std::vector<std::pair<uint32_t, size_t>> stringValues; // номер в пуле, начало в blob
+    walk(root, [&](ASTNode& n) {
+        auto lit = dynamic_cast<LiteralExprNode*>(&n);
+        if (!lit) return;
+        ++literals;
+        lit->constant = kNone;
+        auto type = dynamic_cast<TypeNode*>(lit->type.get());
+        if (type && type->type_name == "string") {
+            auto [it, added] = texts.emplace(lit->value, static_cast<uint32_t>(values.size()));
+            if (added) {
+                stringValues.emplace_back(it->second, blob.size());
+                blob += lit->value;
+                values.emplace_back();
+            }
+            lit->constant = it->second;
+            return;
+        }
+        auto v = parse(*lit);
+        if (!v) return;
+        int64_t bits = v->i;
+        if (v->isFloating()) std::memcpy(&bits, &v->f, sizeof bits);
+        auto [it, added] = numbers.emplace(std::make_pair(v->kind, bits), static_cast<uint32_t>(values.size()));
+        if (added) values.push_back(*v);
+        lit->constant = it->second;
+    });
+
+    // Блок строк больше не растёт: значения-строки можно направить в него
+    strings.reserve(stringValues.size());
+    for (size_t k = 0; k < stringValues.size(); ++k) {
+        auto [index, start] = stringValues[k];
+        size_t end = k + 1 < stringValues.size() ? stringValues[k + 1].second : blob.size();
+        strings.emplace_back(blob.data() + start, end - start);
+        values[index] = Value::string(strings.back());
+    }
+}
+
+void ConstantPool::adopt(std::vector<Value> constants,
+                         const std::vector<std::pair<uint32_t, std::string_view>>& texts,
+                         std::shared_ptr<const void> memory) {
+    values = std::move(constants);
+    blob.clear();
+    storage = std::move(memory);
+    literals = 0;
+    strings.clear();
+    strings.reserve(texts.size());
+    for (auto [index, text] : texts) {
+        strings.push_back(text);
+        values[index] = Value::string(strings.back());
+    }
+}
+
+const ConstantPool& constantsOf(TranslationUnitNode& program) {
+    if (!program.constants) {
+        program.constants = std::make_shared<ConstantPool>();
+        program.constants->run(program);
+    }
+    return *program.constants;
+}
+
+void ConstantPool::printReport(std::ostream& out) const {
+    out << "Constant pool report:" << std::endl;
+    out << "  " << literals << " literals, " << values.size() << " constants, " << strings.size()
+        << " strings in " << blob.size() << " bytes" << std::endl;
+}
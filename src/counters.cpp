@@ -0,0 +1,155 @@
+#include "../inc/counters.hpp"
+#include "../inc/ast_utils.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <typeinfo>
+
+namespace {
+
+// Вид узла по имени класса: WhileLoopNode -> WhileLoop
+std::string kindOf(const ASTNode& node) {
+    const char* mangled = typeid(node).name();
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(abi::__cxa_demangle(mangled, nullptr, nullptr, &status), std::free);
+    std::string name = status == 0 ? demangled.get() : mangled;
+    if (name.ends_with("Node")) name.resize(name.size() - 4);
+    return name;
+}
+
+// Строка каждого оператора и выражения программы: своя или ближайшего предка
+void assignLines(ASTNode& node, int line, std::unordered_map<const ASTNode*, int>& lines) {
+    if (node.line) line = node.line;
+    lines[&node] = line;
+    forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { assignLines(*child, line, lines); });
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+std::string describe(ASTNode& node) {
+    std::string kind = kindOf(node);
+    if (auto f = dynamic_cast<FuncDeclNode*>(&node)) return kind + " " + f->name;
+    if (!dynamic_cast<ExprNode*>(&node)) return kind;
+    std::string text = exprToString(node);
+    if (text == "<?>") return kind;
+    if (text.size() > 60) text = text.substr(0, 57) + "...";
+    return kind + " " + text;
+}
+
+} // namespace
+
+void ExecutionCounters::print(TranslationUnitNode& program, std::ostream& out, size_t top) const {
+    std::unordered_map<const ASTNode*, int> lines;
+    assignLines(program, 0, lines);
+
+    uint64_t total = 0;
+    std::map<std::string, uint64_t> kinds;
+    for (const auto& [node, count] : nodes) {
+        total += count;
+        kinds[kindOf(*node)] += count;
+    }
+
+    char line[160];
+    out << "Execution counters: " << total << " node executions, " << nodes.size() << " nodes" << std::endl;
+    std::vector<std::pair<std::string, uint64_t>> byKind(kinds.begin(), kinds.end());
+    std::stable_sort(byKind.begin(), byKind.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::snprintf(line, sizeof line, "  %12s %7s  %s", "count", "%", "kind");
+    out << line << std::endl;
+    for (const auto& [kind, count] : byKind) {
+        std::snprintf(line, sizeof line, "  %12llu %7.2f  ", static_cast<unsigned long long>(count), percent(count, total));
+        out << line << kind << std::endl;
+    }
+
+    // При равных счётах — по строке: порядок таблицы узлов зависит от адресов
+    std::vector<std::pair<const ASTNode*, uint64_t>> hot(nodes.begin(), nodes.end());
+    auto lineOf = [&](const ASTNode* n) {
+        auto it = lines.find(n);
+        return it == lines.end() ? n->line : it->second;
+    };
+    std::sort(hot.begin(), hot.end(), [&](const auto& a, const auto& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return lineOf(a.first) < lineOf(b.first);
+    });
+    if (hot.size() > top) hot.resize(top);
+    out << "Hottest nodes:" << std::endl;
+    std::snprintf(line, sizeof line, "  %12s %6s  %s", "count", "line", "node");
+    out << line << std::endl;
+    for (const auto& [node, count] : hot) {
+        std::snprintf(line, sizeof line, "  %12llu %6d  ", static_cast<unsigned long long>(count), lineOf(node));
+        out << line << describe(const_cast<ASTNode&>(*node)) << std::endl;
+    }
+
+    if (!countsBytecode()) {
+        out << "Bytecode instructions are not counted (build with make COUNTERS=1)" << std::endl;
+        return;
+    }
+    uint64_t executed = 0;
+    for (uint64_t c : ops) executed += c;
+    out << "Bytecode: " << executed << " instructions" << std::endl;
+    if (!executed) return;
+    std::vector<std::pair<size_t, uint64_t>> byOp;
+    for (size_t k = 0; k < kOpCount; ++k) {
+        if (ops[k]) byOp.emplace_back(k, ops[k]);
+    }
+    std::stable_sort(byOp.begin(), byOp.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::snprintf(line, sizeof line, "  %12s %7s  %s", "count", "%", "op");
+    out << line << std::endl;
+    for (const auto& [k, count] : byOp) {
+        std::snprintf(line, sizeof line, "  %12llu %7.2f  %s", static_cast<unsigned long long>(count),
+                      percent(count, executed), opName(static_cast<Op>(k)));
+        out << line << std::endl;
+    }
+
+    // Частые пары — кандидаты в составные инструкции (как Inc и CmpJz)
+    std::vector<std::pair<size_t, uint64_t>> byPair;
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        if (pairs[k]) byPair.emplace_back(k, pairs[k]);
+    }
+    std::stable_sort(byPair.begin(), byPair.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (byPair.size() > top) byPair.resize(top);
+    out << "Instruction pairs:" << std::endl;
+    std::snprintf(line, sizeof line, "  %12s %7s  %s", "count", "%", "pair");
+    out << line << std::endl;
+    for (const auto& [k, count] : byPair) {
+        std::snprintf(line, sizeof line, "  %12llu %7.2f  %s %s", static_cast<unsigned long long>(count),
+                      percent(count, executed), opName(static_cast<Op>(k / kOpCount)),
+                      opName(static_cast<Op>(k % kOpCount)));
+        out << line << std::endl;
+    }
+}
+
+void ExecutionCounters::annotate(TranslationUnitNode& program, const std::string& source, const std::string& name,
+                                 std::ostream& out) const {
+    std::unordered_map<const ASTNode*, int> lines;
+    assignLines(program, 0, lines);
+    // Строка с кодом: наибольший счёт её узлов (-1 — не исполнялась)
+    std::map<int, int64_t> counts;
+    for (const auto& [node, line] : lines) {
+        auto func = dynamic_cast<const FuncDeclNode*>(node);
+        if (line <= 0 || (func && !func->body)) continue; // объявление без тела не исполняется
+        auto it = nodes.find(node);
+        int64_t count = it == nodes.end() ? -1 : static_cast<int64_t>(it->second);
+        auto [slot, fresh] = counts.emplace(line, count);
+        if (!fresh) slot->second = std::max(slot->second, count);
+    }
+
+    char prefix[32];
+    out << "        -:    0:Source:" << name << '\n';
+    size_t start = 0;
+    for (int number = 1; start < source.size(); ++number) {
+        size_t end = source.find('\n', start);
+        if (end == std::string::npos) end = source.size();
+        auto it = counts.find(number);
+        if (it == counts.end()) std::snprintf(prefix, sizeof prefix, "%9s:%5d:", "-", number);
+        else if (it->second < 0) std::snprintf(prefix, sizeof prefix, "%9s:%5d:", "#####", number);
+        else std::snprintf(prefix, sizeof prefix, "%9lld:%5d:", static_cast<long long>(it->second), number);
+        out << prefix << std::string_view(source).substr(start, end - start) << '\n';
+        start = end + 1;
+    }
+}
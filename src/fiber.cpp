@@ -0,0 +1,96 @@
+#include "../inc/fiber.hpp"
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__SANITIZE_THREAD__)
+#define FIBER_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define FIBER_TSAN 1
+#endif
+#endif
+#ifdef FIBER_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+namespace {
+
+thread_local Fiber* running = nullptr;
+
+} // namespace
+
+Fiber::Fiber(std::function<void()> body, size_t stackSize) : body(std::move(body)) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    stackSize = (stackSize + page - 1) / page * page;
+    mapped = stackSize + page;
+    void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+                        -1, 0);
+    if (memory == MAP_FAILED) throw std::bad_alloc();
+    stack = static_cast<char*>(memory);
+    mprotect(stack, page, PROT_NONE); // стек растёт вниз: защитная страница — первая
+
+    getcontext(&context);
+    context.uc_stack.ss_sp = stack + page;
+    context.uc_stack.ss_size = stackSize;
+    context.uc_link = nullptr;
+    // makecontext передаёт только int: указатель делится на две половины
+    auto self = reinterpret_cast<uintptr_t>(this);
+    makecontext(&context, reinterpret_cast<void (*)()>(&Fiber::entry), 2, static_cast<unsigned>(self >> 32),
+                static_cast<unsigned>(self & 0xffffffffu));
+#ifdef FIBER_TSAN
+    sanitizerFiber = __tsan_create_fiber(0);
+#endif
+}
+
+Fiber::~Fiber() {
+#ifdef FIBER_TSAN
+    __tsan_destroy_fiber(sanitizerFiber);
+#endif
+    munmap(stack, mapped);
+}
+
+void Fiber::entry(unsigned high, unsigned low) {
+    auto self = reinterpret_cast<Fiber*>((static_cast<uintptr_t>(high) << 32) | low);
+    try {
+        self->body();
+    } catch (...) {
+        self->error = std::current_exception();
+    }
+    self->finished = true;
+#ifdef FIBER_TSAN
+    __tsan_switch_to_fiber(self->sanitizerCaller, 0);
+#endif
+    setcontext(&self->caller);
+}
+
+bool Fiber::resume() {
+    if (finished) return true;
+    outer = running;
+    running = this;
+#ifdef FIBER_TSAN
+    sanitizerCaller = __tsan_get_current_fiber();
+    __tsan_switch_to_fiber(sanitizerFiber, 0);
+#endif
+    swapcontext(&caller, &context);
+    running = outer;
+    if (finished && error) std::rethrow_exception(std::exchange(error, nullptr));
+    return finished;
+}
+
+void Fiber::yield() {
+    // После swapcontext волокно может продолжиться в другом потоке:
+    // thread_local здесь читается только до переключения
+    Fiber* self = running;
+    if (!self) return;
+#ifdef FIBER_TSAN
+    __tsan_switch_to_fiber(self->sanitizerCaller, 0);
+#endif
+    swapcontext(&self->context, &self->caller);
+}
+
+Fiber* Fiber::current() {
+    return running;
+}
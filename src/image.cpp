@@ -0,0 +1,932 @@
+#include "../inc/image.hpp"
+#include "../inc/constant_pool.hpp"
+#include "../inc/simd.hpp"
+#include "../inc/trace.hpp"
+#include "../inc/type.hpp"
+#include "../inc/visitor.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+constexpr uint32_t kNone = UINT32_MAX;
+
+enum class Tag : uint8_t {
+    Null, TranslationUnit, Type, Declarator, InitDeclarator, InitList, VarDecl, ParamDecl, FuncDecl,
+    StructDecl, NamespaceDecl, Block, If, While, DoWhile, For, Return, Break, Continue, Read, Print,
+    StaticAssert, Binary, Unary, Ternary, Cast, Subscript, Call, Literal, Identifier, Group, Postfix,
+    ScopedIdentifier, Assignment, MemberAccess, Sizeof, Exit, Assert
+};
+
+enum class TypeTag : uint8_t { Builtin = 1, Array, Struct };
+
+// Байты секции
+struct Bytes {
+    std::string data;
+
+    void u8(uint8_t v) { data.push_back(static_cast<char>(v)); }
+    void u32(uint32_t v) { data.append(reinterpret_cast<const char*>(&v), sizeof v); }
+    void i64(int64_t v) { data.append(reinterpret_cast<const char*>(&v), sizeof v); }
+    void str(std::string_view s) {
+        u32(static_cast<uint32_t>(s.size()));
+        data.append(s);
+    }
+};
+
+// Запись дерева: узлы в прямом порядке, у каждого тег и поля; номер узла —
+// его место в этом порядке, по нему на узел ссылаются планы циклов
+class ImageWriter : public Visitor {
+public:
+    Bytes nodes;
+    std::vector<const Type*> types;
+
+    void child(ASTNode* node) {
+        if (!node) {
+            nodes.u8(static_cast<uint8_t>(Tag::Null));
+            return;
+        }
+        node->accept(*this);
+    }
+    template <typename T>
+    void children(const std::vector<std::unique_ptr<T>>& list) {
+        nodes.u32(static_cast<uint32_t>(list.size()));
+        for (auto& n : list) child(n.get());
+    }
+
+    uint32_t typeRef(const Type* type) {
+        if (!type) return kNone;
+        auto [it, added] = typeNumbers.emplace(type, static_cast<uint32_t>(types.size()));
+        if (added) types.push_back(type);
+        return it->second;
+    }
+
+    void visit(TranslationUnitNode& node) override {
+        begin(node, Tag::TranslationUnit);
+        children(node.declarations);
+    }
+    void visit(TypeNode& node) override {
+        begin(node, Tag::Type);
+        nodes.str(node.type_name);
+        nodes.u8(node.is_const);
+        nodes.u8(node.is_unsigned);
+    }
+    void visit(DeclaratorNode& node) override {
+        begin(node, Tag::Declarator);
+        nodes.str(node.name);
+        nodes.u8(node.is_array);
+        nodes.u32(static_cast<uint32_t>(node.slot));
+        child(node.array_size.get());
+    }
+    void visit(InitDeclaratorNode& node) override {
+        begin(node, Tag::InitDeclarator);
+        child(node.declarator.get());
+        child(node.initializer.get());
+    }
+    void visit(VarDeclNode& node) override {
+        begin(node, Tag::VarDecl);
+        child(node.type.get());
+        children(node.declarators);
+        nodes.u8(node.is_const);
+    }
+    void visit(ParamDeclNode& node) override {
+        begin(node, Tag::ParamDecl);
+        child(node.type.get());
+        child(node.declarator.get());
+        nodes.u8(node.is_const);
+    }
+    void visit(FuncDeclNode& node) override {
+        begin(node, Tag::FuncDecl);
+        child(node.return_type.get());
+        nodes.str(node.name);
+        children(node.params);
+        child(node.body.get());
+        nodes.u8(node.is_const);
+        nodes.u32(static_cast<uint32_t>(node.frame_size));
+    }
+    void visit(StructDeclNode& node) override {
+        begin(node, Tag::StructDecl);
+        nodes.str(node.name);
+        children(node.members);
+        nodes.u32(typeRef(node.type.get()));
+    }
+    void visit(NamespaceDeclNode& node) override {
+        begin(node, Tag::NamespaceDecl);
+        nodes.str(node.name);
+        children(node.declarations);
+    }
+
+    void visit(BlockStatementNode& node) override {
+        begin(node, Tag::Block);
+        children(node.statements);
+    }
+    void visit(IfStatementNode& node) override {
+        begin(node, Tag::If);
+        child(node.condition.get());
+        child(node.then_branch.get());
+        child(node.else_branch.get());
+    }
+    void visit(WhileLoopNode& node) override {
+        begin(node, Tag::While);
+        child(node.condition.get());
+        child(node.body.get());
+    }
+    void visit(DoWhileLoopNode& node) override {
+        begin(node, Tag::DoWhile);
+        child(node.body.get());
+        child(node.condition.get());
+    }
+    void visit(ForLoopNode& node) override {
+        begin(node, Tag::For);
+        child(node.init.get());
+        child(node.condition.get());
+        child(node.increment.get());
+        child(node.body.get());
+        // План ссылается на узлы цикла, которые уже получили номера
+        const VectorLoop* plan = node.vector.get();
+        nodes.u8(plan != nullptr);
+        if (!plan) return;
+        nodes.u8(static_cast<uint8_t>(plan->shape));
+        nodes.u8(static_cast<uint8_t>(plan->op));
+        nodes.u8(static_cast<uint8_t>(plan->kind));
+        nodes.u8(plan->inclusive);
+        nodes.u8(plan->xArray);
+        nodes.u8(plan->yArray);
+        for (ASTNode* n : {static_cast<ASTNode*>(plan->counter), plan->bound, plan->target, plan->x, plan->y}) {
+            nodes.u32(n ? numbers.at(n) : kNone);
+        }
+    }
+    void visit(ReturnStatementNode& node) override {
+        begin(node, Tag::Return);
+        child(node.expression.get());
+    }
+    void visit(BreakStmtNode& node) override { begin(node, Tag::Break); }
+    void visit(ContinueStmtNode& node) override { begin(node, Tag::Continue); }
+    void visit(ReadStmtNode& node) override {
+        begin(node, Tag::Read);
+        child(node.argument.get());
+    }
+    void visit(PrintStmtNode& node) override {
+        begin(node, Tag::Print);
+        child(node.argument.get());
+    }
+    void visit(StaticAssertNode& node) override {
+        begin(node, Tag::StaticAssert);
+        child(node.condition.get());
+        nodes.str(node.message);
+    }
+
+    void visit(BinaryExprNode& node) override {
+        expr(node, Tag::Binary);
+        nodes.str(node.op);
+        child(node.left.get());
+        child(node.right.get());
+    }
+    void visit(UnaryExprNode& node) override {
+        expr(node, Tag::Unary);
+        nodes.str(node.op);
+        child(node.operand.get());
+    }
+    void visit(TernaryExprNode& node) override {
+        expr(node, Tag::Ternary);
+        child(node.condition.get());
+        child(node.then_expr.get());
+        child(node.else_expr.get());
+    }
+    void visit(CastExprNode& node) override {
+        expr(node, Tag::Cast);
+        child(node.type.get());
+        child(node.expression.get());
+    }
+    void visit(SubscriptExprNode& node) override {
+        expr(node, Tag::Subscript);
+        child(node.array.get());
+        child(node.index.get());
+        nodes.u8(node.checked);
+    }
+    void visit(CallExprNode& node) override {
+        expr(node, Tag::Call);
+        child(node.callee.get());
+        children(node.arguments);
+    }
+    void visit(LiteralExprNode& node) override {
+        expr(node, Tag::Literal);
+        child(node.type.get());
+        nodes.str(node.value);
+        nodes.u32(node.constant);
+    }
+    void visit(IdentifierExprNode& node) override {
+        expr(node, Tag::Identifier);
+        nodes.str(node.name);
+        nodes.u32(static_cast<uint32_t>(node.slot));
+    }
+    void visit(GroupExprNode& node) override {
+        expr(node, Tag::Group);
+        child(node.expression.get());
+    }
+    void visit(PostfixExprNode& node) override {
+        expr(node, Tag::Postfix);
+        child(node.expr.get());
+        nodes.str(node.op);
+    }
+    void visit(InitListNode& node) override {
+        expr(node, Tag::InitList);
+        children(node.elements);
+    }
+    void visit(SizeofExprNode& node) override {
+        expr(node, Tag::Sizeof);
+        child(node.operand.get());
+        nodes.u8(node.isType);
+        nodes.i64(node.size);
+    }
+    void visit(ExitExprNode& node) override {
+        expr(node, Tag::Exit);
+        children(node.arguments);
+    }
+    void visit(AssertExprNode& node) override {
+        expr(node, Tag::Assert);
+        children(node.arguments);
+    }
+    void visit(AssignmentExprNode& node) override {
+        expr(node, Tag::Assignment);
+        child(node.left.get());
+        child(node.right.get());
+        nodes.str(node.op);
+    }
+    void visit(MemberAccessExprNode& node) override {
+        expr(node, Tag::MemberAccess);
+        child(node.object.get());
+        nodes.str(node.member);
+        nodes.str(node.op);
+        // Поле — номер в раскладке структуры объекта
+        auto object = dynamic_cast<ExprNode*>(node.object.get());
+        auto st = object ? dynamic_cast<const StructType*>(object->resolved_type.get()) : nullptr;
+        if (st && node.field && node.field >= st->layout.data() && node.field < st->layout.data() + st->layout.size()) {
+            nodes.u32(typeRef(st));
+            nodes.u32(static_cast<uint32_t>(node.field - st->layout.data()));
+        } else {
+            nodes.u32(kNone);
+            nodes.u32(kNone);
+        }
+    }
+    void visit(ScopedIdentifierExprNode& node) override {
+        expr(node, Tag::ScopedIdentifier);
+        nodes.u32(static_cast<uint32_t>(node.path.size()));
+        for (auto& part : node.path) nodes.str(part);
+    }
+
+    // Типы пишутся после дерева: поля структур добавляют новые
+    Bytes writeTypes() {
+        Bytes out;
+        std::vector<Bytes> entries;
+        for (size_t k = 0; k < types.size(); ++k) {
+            Bytes e;
+            const Type* type = types[k];
+            if (auto b = dynamic_cast<const BuiltinType*>(type)) {
+                e.u8(static_cast<uint8_t>(TypeTag::Builtin));
+                e.str(b->name);
+                e.u8(b->is_const);
+                e.u8(b->is_unsigned);
+            } else if (auto a = dynamic_cast<const ArrayType*>(type)) {
+                e.u8(static_cast<uint8_t>(TypeTag::Array));
+                e.u32(typeRef(a->element.get()));
+                e.i64(static_cast<int64_t>(a->length));
+            } else if (auto s = dynamic_cast<const StructType*>(type)) {
+                e.u8(static_cast<uint8_t>(TypeTag::Struct));
+                e.str(s->name);
+                e.i64(static_cast<int64_t>(s->size));
+                e.i64(static_cast<int64_t>(s->align));
+                // Порядок полей в таблице не важен, но образ должен быть воспроизводим
+                std::vector<std::pair<std::string, const Type*>> fields;
+                for (auto& [name, t] : s->fields) fields.emplace_back(name, t.get());
+                std::sort(fields.begin(), fields.end());
+                e.u32(static_cast<uint32_t>(fields.size()));
+                for (auto& [name, t] : fields) {
+                    e.str(name);
+                    e.u32(typeRef(t));
+                }
+                e.u32(static_cast<uint32_t>(s->layout.size()));
+                for (const FieldLayout& f : s->layout) {
+                    e.str(f.name);
+                    e.u8(static_cast<uint8_t>(f.storage.kind));
+                    e.u8(static_cast<uint8_t>(f.storage.element));
+                    e.u32(f.storage.count);
+                    e.u32(typeRef(f.storage.layout));
+                    e.i64(static_cast<int64_t>(f.offset));
+                }
+            } else {
+                throw ImageError("unknown type " + type->toString());
+            }
+            entries.push_back(std::move(e));
+        }
+        out.u32(static_cast<uint32_t>(entries.size()));
+        for (auto& e : entries) out.data += e.data;
+        return out;
+    }
+
+private:
+    uint32_t count = 0;
+    std::unordered_map<const ASTNode*, uint32_t> numbers;
+    std::unordered_map<const Type*, uint32_t> typeNumbers;
+
+    void begin(ASTNode& node, Tag tag) {
+        nodes.u8(static_cast<uint8_t>(tag));
+        nodes.u32(static_cast<uint32_t>(node.line));
+        numbers[&node] = count++;
+    }
+    void expr(ExprNode& node, Tag tag) {
+        begin(node, tag);
+        nodes.u32(typeRef(node.resolved_type.get()));
+    }
+};
+
+Bytes writeConstants(const ConstantPool& pool) {
+    Bytes out;
+    std::string blob;
+    out.u32(static_cast<uint32_t>(pool.size()));
+    for (uint32_t k = 0; k < pool.size(); ++k) {
+        const Value& v = pool.at(k);
+        out.u8(static_cast<uint8_t>(v.kind));
+        if (v.kind == Value::Kind::String) {
+            out.u32(static_cast<uint32_t>(blob.size()));
+            out.u32(static_cast<uint32_t>(v.s->size()));
+            blob += *v.s;
+        } else if (v.isFloating()) {
+            int64_t bits;
+            std::memcpy(&bits, &v.f, sizeof bits);
+            out.i64(bits);
+        } else {
+            out.i64(v.i);
+        }
+    }
+    out.i64(static_cast<int64_t>(blob.size()));
+    out.data += blob;
+    return out;
+}
+
+// Байт-код функций, которые компилируются вместе со всеми вызываемыми
+Bytes writeFunctions(TranslationUnitNode& program) {
+    std::vector<BytecodeFunction> compiled = compileProgram(program, constantsOf(program));
+
+    Bytes out;
+    out.u32(static_cast<uint32_t>(compiled.size()));
+    auto kinds = [&](const std::vector<Value::Kind>& list) {
+        out.u32(static_cast<uint32_t>(list.size()));
+        for (auto k : list) out.u8(static_cast<uint8_t>(k));
+    };
+    for (auto& f : compiled) {
+        out.str(f.name);
+        out.u32(static_cast<uint32_t>(f.param_count));
+        out.u32(static_cast<uint32_t>(f.frame_size));
+        out.u32(static_cast<uint32_t>(f.max_stack));
+        out.u8(static_cast<uint8_t>(f.return_kind));
+        kinds(f.param_kinds);
+        kinds(f.slot_kinds);
+        out.u32(static_cast<uint32_t>(f.callees.size()));
+        for (auto& c : f.callees) out.str(c);
+        out.u32(static_cast<uint32_t>(f.constants.size()));
+        for (Slot s : f.constants) out.i64(s.i);
+        out.u32(static_cast<uint32_t>(f.code.size()));
+        for (const Instr& in : f.code) {
+            out.u8(static_cast<uint8_t>(in.op));
+            out.u32(static_cast<uint32_t>(in.a));
+            out.u32(static_cast<uint32_t>(in.b));
+        }
+        for (int32_t line : f.lines) out.u32(static_cast<uint32_t>(line));
+    }
+    return out;
+}
+
+// Чтение секции с проверкой границ
+class Cursor {
+public:
+    Cursor(const unsigned char* p, size_t length) : p(p), end(p + length) {}
+
+    uint8_t u8() { return take<uint8_t>(); }
+    uint32_t u32() { return take<uint32_t>(); }
+    int64_t i64() { return take<int64_t>(); }
+    std::string_view view(size_t length) {
+        need(length);
+        std::string_view r(reinterpret_cast<const char*>(p), length);
+        p += length;
+        return r;
+    }
+    std::string str() { return std::string(view(u32())); }
+    // Число элементов списка: каждый занимает хотя бы байт
+    uint32_t count() {
+        uint32_t n = u32();
+        need(n);
+        return n;
+    }
+    const unsigned char* position() const { return p; }
+
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+
+    void need(size_t n) const {
+        if (static_cast<size_t>(end - p) < n) throw ImageError("truncated image");
+    }
+    template <typename T>
+    T take() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, p, sizeof v);
+        p += sizeof v;
+        return v;
+    }
+};
+
+Value::Kind kindAt(uint8_t v) {
+    if (v > static_cast<uint8_t>(Value::Kind::Array)) throw ImageError("bad value kind");
+    return static_cast<Value::Kind>(v);
+}
+
+class ImageReader {
+public:
+    std::vector<std::shared_ptr<Type>> types;
+    std::vector<const LiteralExprNode*> literals;
+
+    void readTypes(Cursor in) {
+        struct Field {
+            std::string name;
+            Storage storage;
+            uint32_t layout;
+            size_t offset;
+        };
+        struct Entry {
+            TypeTag tag;
+            uint32_t element = kNone;
+            std::vector<std::pair<std::string, uint32_t>> fields;
+            std::vector<Field> layout;
+        };
+        uint32_t n = in.count();
+        std::vector<Entry> entries(n);
+        for (uint32_t k = 0; k < n; ++k) {
+            Entry& e = entries[k];
+            e.tag = static_cast<TypeTag>(in.u8());
+            if (e.tag == TypeTag::Builtin) {
+                std::string name = in.str();
+                bool isConst = in.u8();
+                bool isUnsigned = in.u8();
+                types.push_back(std::make_shared<BuiltinType>(name, isConst, isUnsigned));
+            } else if (e.tag == TypeTag::Array) {
+                e.element = in.u32();
+                types.push_back(std::make_shared<ArrayType>(nullptr, static_cast<size_t>(in.i64())));
+            } else if (e.tag == TypeTag::Struct) {
+                auto st = std::make_shared<StructType>(in.str());
+                st->size = static_cast<size_t>(in.i64());
+                st->align = static_cast<size_t>(in.i64());
+                for (uint32_t f = 0, count = in.count(); f < count; ++f) {
+                    std::string name = in.str();
+                    e.fields.emplace_back(name, in.u32());
+                }
+                for (uint32_t f = 0, count = in.count(); f < count; ++f) {
+                    Field field;
+                    field.name = in.str();
+                    field.storage.kind = kindAt(in.u8());
+                    field.storage.element = kindAt(in.u8());
+                    field.storage.count = in.u32();
+                    field.layout = in.u32();
+                    field.offset = static_cast<size_t>(in.i64());
+                    e.layout.push_back(std::move(field));
+                }
+                types.push_back(st);
+            } else {
+                throw ImageError("bad type tag");
+            }
+        }
+        // Ссылки между типами связываются, когда созданы все
+        for (uint32_t k = 0; k < n; ++k) {
+            Entry& e = entries[k];
+            if (auto a = std::dynamic_pointer_cast<ArrayType>(types[k])) {
+                a->element = type(e.element);
+                if (!a->element) throw ImageError("array type without element");
+            } else if (auto st = std::dynamic_pointer_cast<StructType>(types[k])) {
+                for (auto& [name, t] : e.fields) st->fields[name] = type(t);
+                for (auto& f : e.layout) {
+                    f.storage.layout = structType(f.layout);
+                    st->layout.push_back({f.name, f.storage, f.offset});
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<ASTNode> node(Cursor& in) {
+        auto tag = static_cast<Tag>(in.u8());
+        if (tag == Tag::Null) return nullptr;
+        uint32_t number = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(nullptr);
+        int line = static_cast<int>(in.u32());
+        std::unique_ptr<ASTNode> n = make(tag, in);
+        n->line = line;
+        nodes[number] = n.get();
+        return n;
+    }
+
+private:
+    std::vector<ASTNode*> nodes; // по номерам из ImageWriter
+
+    std::shared_ptr<Type> type(uint32_t index) const {
+        if (index == kNone) return nullptr;
+        if (index >= types.size()) throw ImageError("bad type reference");
+        return types[index];
+    }
+    const StructType* structType(uint32_t index) const {
+        if (index == kNone) return nullptr;
+        auto st = dynamic_cast<const StructType*>(type(index).get());
+        if (!st) throw ImageError("bad struct reference");
+        return st;
+    }
+    template <typename T>
+    std::unique_ptr<T> nodeAs(Cursor& in) {
+        auto n = node(in);
+        if (n && !dynamic_cast<T*>(n.get())) throw ImageError("unexpected node");
+        return std::unique_ptr<T>(static_cast<T*>(n.release()));
+    }
+    template <typename T = ASTNode>
+    std::vector<std::unique_ptr<T>> list(Cursor& in) {
+        std::vector<std::unique_ptr<T>> r;
+        for (uint32_t k = 0, n = in.count(); k < n; ++k) r.push_back(nodeAs<T>(in));
+        return r;
+    }
+    template <typename T>
+    T* ref(uint32_t number) const {
+        if (number == kNone) return nullptr;
+        if (number >= nodes.size() || !dynamic_cast<T*>(nodes[number])) throw ImageError("bad node reference");
+        return static_cast<T*>(nodes[number]);
+    }
+
+    std::unique_ptr<ASTNode> make(Tag tag, Cursor& in) {
+        switch (tag) {
+        case Tag::TranslationUnit: return std::make_unique<TranslationUnitNode>(list(in));
+        case Tag::Type: {
+            std::string name = in.str();
+            bool isConst = in.u8();
+            bool isUnsigned = in.u8();
+            return std::make_unique<TypeNode>(name, isConst, isUnsigned);
+        }
+        case Tag::Declarator: {
+            std::string name = in.str();
+            bool isArray = in.u8();
+            int slot = static_cast<int>(in.u32());
+            auto decl = std::make_unique<DeclaratorNode>(name, node(in));
+            decl->is_array = isArray;
+            decl->slot = slot;
+            return decl;
+        }
+        case Tag::InitDeclarator: {
+            auto decl = nodeAs<DeclaratorNode>(in);
+            return std::make_unique<InitDeclaratorNode>(std::move(decl), node(in));
+        }
+        case Tag::VarDecl: {
+            auto type = node(in);
+            auto decls = list<InitDeclaratorNode>(in);
+            return std::make_unique<VarDeclNode>(std::move(type), std::move(decls), in.u8());
+        }
+        case Tag::ParamDecl: {
+            auto type = node(in);
+            auto decl = nodeAs<DeclaratorNode>(in);
+            return std::make_unique<ParamDeclNode>(std::move(type), std::move(decl), in.u8());
+        }
+        case Tag::FuncDecl: {
+            auto ret = node(in);
+            std::string name = in.str();
+            auto params = list<ParamDeclNode>(in);
+            auto body = node(in);
+            auto func = std::make_unique<FuncDeclNode>(std::move(ret), name, std::move(params), std::move(body), in.u8());
+            func->frame_size = static_cast<int>(in.u32());
+            return func;
+        }
+        case Tag::StructDecl: {
+            std::string name = in.str();
+            auto decl = std::make_unique<StructDeclNode>(name, list<VarDeclNode>(in));
+            uint32_t index = in.u32();
+            structType(index);
+            decl->type = std::dynamic_pointer_cast<StructType>(type(index));
+            return decl;
+        }
+        case Tag::NamespaceDecl: {
+            std::string name = in.str();
+            return std::make_unique<NamespaceDeclNode>(name, list(in));
+        }
+        case Tag::Block: return std::make_unique<BlockStatementNode>(list(in));
+        case Tag::If: {
+            auto cond = node(in);
+            auto then_b = node(in);
+            return std::make_unique<IfStatementNode>(std::move(cond), std::move(then_b), node(in));
+        }
+        case Tag::While: {
+            auto cond = node(in);
+            return std::make_unique<WhileLoopNode>(std::move(cond), node(in));
+        }
+        case Tag::DoWhile: {
+            auto body = node(in);
+            return std::make_unique<DoWhileLoopNode>(std::move(body), node(in));
+        }
+        case Tag::For: {
+            auto init = node(in);
+            auto cond = node(in);
+            auto inc = node(in);
+            auto loop = std::make_unique<ForLoopNode>(std::move(init), std::move(cond), std::move(inc), node(in));
+            if (in.u8()) {
+                auto plan = std::make_shared<VectorLoop>();
+                plan->shape = static_cast<VectorLoop::Shape>(in.u8());
+                plan->op = static_cast<VectorOp>(in.u8());
+                plan->kind = kindAt(in.u8());
+                plan->inclusive = in.u8();
+                plan->xArray = in.u8();
+                plan->yArray = in.u8();
+                plan->counter = ref<IdentifierExprNode>(in.u32());
+                plan->bound = ref<ASTNode>(in.u32());
+                plan->target = ref<ASTNode>(in.u32());
+                plan->x = ref<ASTNode>(in.u32());
+                plan->y = ref<ASTNode>(in.u32());
+                loop->vector = std::move(plan);
+            }
+            return loop;
+        }
+        case Tag::Return: return std::make_unique<ReturnStatementNode>(node(in));
+        case Tag::Break: return std::make_unique<BreakStmtNode>();
+        case Tag::Continue: return std::make_unique<ContinueStmtNode>();
+        case Tag::Read: return std::make_unique<ReadStmtNode>(node(in));
+        case Tag::Print: return std::make_unique<PrintStmtNode>(node(in));
+        case Tag::StaticAssert: {
+            auto cond = node(in);
+            return std::make_unique<StaticAssertNode>(std::move(cond), in.str());
+        }
+        default: return expression(tag, in);
+        }
+    }
+
+    std::unique_ptr<ASTNode> expression(Tag tag, Cursor& in) {
+        std::shared_ptr<Type> resolved = type(in.u32());
+        std::unique_ptr<ExprNode> e;
+        switch (tag) {
+        case Tag::Binary: {
+            std::string op = in.str();
+            auto lhs = node(in);
+            e = std::make_unique<BinaryExprNode>(op, std::move(lhs), node(in));
+            break;
+        }
+        case Tag::Unary: {
+            std::string op = in.str();
+            e = std::make_unique<UnaryExprNode>(op, node(in));
+            break;
+        }
+        case Tag::Ternary: {
+            auto cond = node(in);
+            auto then_e = node(in);
+            e = std::make_unique<TernaryExprNode>(std::move(cond), std::move(then_e), node(in));
+            break;
+        }
+        case Tag::Cast: {
+            auto t = node(in);
+            e = std::make_unique<CastExprNode>(std::move(t), node(in));
+            break;
+        }
+        case Tag::Subscript: {
+            auto array = node(in);
+            auto sub = std::make_unique<SubscriptExprNode>(std::move(array), node(in));
+            sub->checked = in.u8();
+            e = std::move(sub);
+            break;
+        }
+        case Tag::Call: {
+            auto callee = node(in);
+            e = std::make_unique<CallExprNode>(std::move(callee), list(in));
+            break;
+        }
+        case Tag::Literal: {
+            auto t = node(in);
+            auto lit = std::make_unique<LiteralExprNode>(std::move(t), in.str());
+            lit->constant = in.u32();
+            literals.push_back(lit.get());
+            e = std::move(lit);
+            break;
+        }
+        case Tag::Identifier: {
+            auto id = std::make_unique<IdentifierExprNode>(in.str());
+            id->slot = static_cast<int>(in.u32());
+            e = std::move(id);
+            break;
+        }
+        case Tag::Group: e = std::make_unique<GroupExprNode>(node(in)); break;
+        case Tag::Postfix: {
+            auto operand = node(in);
+            e = std::make_unique<PostfixExprNode>(std::move(operand), in.str());
+            break;
+        }
+        case Tag::InitList: e = std::make_unique<InitListNode>(list(in)); break;
+        case Tag::Sizeof: {
+            auto operand = node(in);
+            auto s = std::make_unique<SizeofExprNode>(std::move(operand), in.u8());
+            s->size = in.i64();
+            e = std::move(s);
+            break;
+        }
+        case Tag::Exit: e = std::make_unique<ExitExprNode>(list(in)); break;
+        case Tag::Assert: e = std::make_unique<AssertExprNode>(list(in)); break;
+        case Tag::Assignment: {
+            auto left = node(in);
+            auto right = node(in);
+            e = std::make_unique<AssignmentExprNode>(std::move(left), std::move(right), in.str());
+            break;
+        }
+        case Tag::MemberAccess: {
+            auto object = node(in);
+            std::string member = in.str();
+            auto access = std::make_unique<MemberAccessExprNode>(std::move(object), member, in.str());
+            const StructType* st = structType(in.u32());
+            uint32_t field = in.u32();
+            if (st) {
+                if (field >= st->layout.size()) throw ImageError("bad field reference");
+                access->field = &st->layout[field];
+            }
+            e = std::move(access);
+            break;
+        }
+        case Tag::ScopedIdentifier: {
+            std::vector<std::string> path;
+            for (uint32_t k = 0, n = in.count(); k < n; ++k) path.push_back(in.str());
+            e = std::make_unique<ScopedIdentifierExprNode>(std::move(path));
+            break;
+        }
+        default: throw ImageError("bad node tag");
+        }
+        e->resolved_type = std::move(resolved);
+        return e;
+    }
+};
+
+void readConstants(Cursor in, ConstantPool& pool, std::shared_ptr<const void> memory) {
+    uint32_t n = in.count();
+    std::vector<Value> values(n);
+    std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> texts;
+    for (uint32_t k = 0; k < n; ++k) {
+        Value::Kind kind = kindAt(in.u8());
+        if (kind == Value::Kind::String) {
+            uint32_t start = in.u32();
+            texts.push_back({k, {start, in.u32()}});
+        } else if (kind == Value::Kind::Float || kind == Value::Kind::Double) {
+            int64_t bits = in.i64();
+            double f;
+            std::memcpy(&f, &bits, sizeof f);
+            values[k] = Value::floating(kind, f);
+        } else {
+            values[k] = Value::integer(kind, in.i64());
+        }
+    }
+    std::string_view blob = in.view(static_cast<size_t>(in.i64()));
+    std::vector<std::pair<uint32_t, std::string_view>> strings;
+    for (auto [index, range] : texts) {
+        if (range.first > blob.size() || range.second > blob.size() - range.first) throw ImageError("bad string");
+        strings.emplace_back(index, blob.substr(range.first, range.second));
+    }
+    pool.adopt(std::move(values), strings, std::move(memory));
+}
+
+std::vector<std::unique_ptr<BytecodeFunction>> readFunctions(Cursor in) {
+    std::vector<std::unique_ptr<BytecodeFunction>> r;
+    auto kinds = [&](std::vector<Value::Kind>& list) {
+        for (uint32_t k = 0, n = in.count(); k < n; ++k) list.push_back(kindAt(in.u8()));
+    };
+    for (uint32_t k = 0, n = in.count(); k < n; ++k) {
+        auto f = std::make_unique<BytecodeFunction>();
+        f->name = in.str();
+        f->param_count = static_cast<int>(in.u32());
+        f->frame_size = static_cast<int>(in.u32());
+        f->max_stack = static_cast<int>(in.u32());
+        f->return_kind = kindAt(in.u8());
+        kinds(f->param_kinds);
+        kinds(f->slot_kinds);
+        for (uint32_t c = 0, count = in.count(); c < count; ++c) f->callees.push_back(in.str());
+        for (uint32_t c = 0, count = in.count(); c < count; ++c) f->constants.push_back(Slot{.i = in.i64()});
+        uint32_t length = in.count();
+        f->code.resize(length);
+        for (Instr& instr : f->code) {
+            uint8_t op = in.u8();
+            if (op > static_cast<uint8_t>(Op::NeD)) throw ImageError("bad instruction");
+            instr.op = static_cast<Op>(op);
+            instr.a = static_cast<int32_t>(in.u32());
+            instr.b = static_cast<int32_t>(in.u32());
+        }
+        f->lines.resize(length);
+        for (int32_t& line : f->lines) line = static_cast<int32_t>(in.u32());
+        r.push_back(std::move(f));
+    }
+    return r;
+}
+
+uint64_t checksum(const unsigned char* p, size_t n) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t k = 0; k < n; ++k) h = (h ^ p[k]) * 1099511628211ull;
+    return h;
+}
+
+void align8(std::string& data) {
+    data.resize((data.size() + 7) / 8 * 8, '\0');
+}
+
+} // namespace
+
+bool isImageFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof ImageHeader::kMagic] = {};
+    file.read(magic, sizeof magic);
+    return file && std::memcmp(magic, ImageHeader::kMagic, sizeof magic) == 0;
+}
+
+void writeImage(TranslationUnitNode& program, const std::string& path, const std::string& notes) {
+    ImageWriter writer;
+    writer.child(&program);
+    Bytes sections[ImageHeader::kSectionCount];
+    sections[ImageHeader::Nodes] = std::move(writer.nodes);
+    sections[ImageHeader::Types] = writer.writeTypes();
+    sections[ImageHeader::Constants] = writeConstants(constantsOf(program));
+    sections[ImageHeader::Functions] = writeFunctions(program);
+    sections[ImageHeader::Notes].data = notes;
+
+    ImageHeader header{};
+    std::memcpy(header.magic, ImageHeader::kMagic, sizeof header.magic);
+    header.version = ImageHeader::kVersion;
+    header.byteOrder = ImageHeader::kByteOrder;
+    std::string image(sizeof header, '\0');
+    for (int s = 0; s < ImageHeader::kSectionCount; ++s) {
+        align8(image);
+        header.offsets[s] = image.size();
+        header.lengths[s] = sections[s].data.size();
+        image += sections[s].data;
+    }
+    header.size = image.size();
+    header.checksum = checksum(reinterpret_cast<const unsigned char*>(image.data()) + sizeof header,
+                               image.size() - sizeof header);
+    std::memcpy(image.data(), &header, sizeof header);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(image.data(), static_cast<std::streamsize>(image.size()));
+    if (!file) throw ImageError("cannot write " + path);
+}
+
+ProgramImage loadImage(const std::string& path) {
+    Trace::Span span("image", "load", path);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw ImageError("cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ImageHeader)) {
+        ::close(fd);
+        throw ImageError(path + " is not an image");
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw ImageError("cannot map " + path);
+    std::shared_ptr<const void> memory(data, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+
+    ImageHeader header;
+    std::memcpy(&header, data, sizeof header);
+    if (std::memcmp(header.magic, ImageHeader::kMagic, sizeof header.magic) != 0) {
+        throw ImageError(path + " is not an image");
+    }
+    if (header.version != ImageHeader::kVersion) {
+        throw ImageError(path + ": image version " + std::to_string(header.version) + ", expected " +
+                         std::to_string(ImageHeader::kVersion));
+    }
+    if (header.byteOrder != ImageHeader::kByteOrder) throw ImageError(path + ": foreign byte order");
+    if (header.size != size) throw ImageError(path + ": truncated image");
+    if (header.checksum != checksum(static_cast<const unsigned char*>(data) + sizeof header, size - sizeof header)) {
+        throw ImageError(path + ": checksum mismatch");
+    }
+    auto section = [&](ImageHeader::Section s) {
+        if (header.offsets[s] > size || header.lengths[s] > size - header.offsets[s]) {
+            throw ImageError(path + ": bad section");
+        }
+        return Cursor(static_cast<const unsigned char*>(data) + header.offsets[s], header.lengths[s]);
+    };
+
+    ImageReader reader;
+    reader.readTypes(section(ImageHeader::Types));
+    Cursor nodes = section(ImageHeader::Nodes);
+    auto root = reader.node(nodes);
+    if (!dynamic_cast<TranslationUnitNode*>(root.get())) throw ImageError(path + ": no program");
+
+    ProgramImage image;
+    image.program.reset(static_cast<TranslationUnitNode*>(root.release()));
+    image.program->constants = std::make_shared<ConstantPool>();
+    readConstants(section(ImageHeader::Constants), *image.program->constants, memory);
+    for (auto lit : reader.literals) {
+        if (lit->constant != ConstantPool::kNone && lit->constant >= image.program->constants->size()) {
+            throw ImageError(path + ": bad constant reference");
+        }
+    }
+    image.bytecode = readFunctions(section(ImageHeader::Functions));
+    Cursor notes = section(ImageHeader::Notes);
+    image.notes = std::string(notes.view(header.lengths[ImageHeader::Notes]));
+    return image;
+}
@@ -0,0 +1,246 @@
+#include "../inc/inliner.hpp"
+#include "../inc/ast_clone.hpp"
+#include "../inc/ast_utils.hpp"
+#include "../inc/const_fold.hpp"
+#include <algorithm>
+#include <functional>
+
+void Inliner::run(TranslationUnitNode& root) {
+    for (auto& decl : root.declarations) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(decl.get()); func && func->body) {
+            functions[func->name] = func;
+        }
+    }
+    buildCallGraph();
+
+    // Вызываемые функции обрабатываются раньше вызывающих: к моменту встраивания
+    // их тела уже упрощены, а встроенные константы сразу сворачиваются
+    ConstantFolder folder;
+    folder.collectGlobals(root);
+    for (const auto& name : bottomUpOrder()) {
+        FuncDeclNode* func = functions[name];
+        currentFunction = name;
+        inlineCalls(func->body, 0);
+        folder.runOnFunction(*func);
+    }
+}
+
+void Inliner::buildCallGraph() {
+    for (auto& [name, func] : functions) {
+        auto& callees = callGraph[name];
+        walk(*func->body, [&](ASTNode& node) {
+            if (auto call = dynamic_cast<CallExprNode*>(&node)) {
+                if (auto id = dynamic_cast<IdentifierExprNode*>(call->callee.get())) callees.insert(id->name);
+            }
+        });
+    }
+}
+
+// Алгоритм Тарьяна: компоненты сильной связности выдаются в порядке "сначала вызываемые"
+std::vector<std::string> Inliner::bottomUpOrder() {
+    std::vector<std::string> order;
+    std::unordered_map<std::string, int> index, lowlink;
+    std::unordered_set<std::string> onStack;
+    std::vector<std::string> stack;
+    int counter = 0;
+
+    std::vector<std::string> names;
+    for (auto& [name, func] : functions) names.push_back(name);
+    std::sort(names.begin(), names.end());
+
+    std::function<void(const std::string&)> connect = [&](const std::string& v) {
+        index[v] = lowlink[v] = counter++;
+        stack.push_back(v);
+        onStack.insert(v);
+        for (const auto& w : callGraph[v]) {
+            if (!functions.count(w)) continue;
+            if (!index.count(w)) {
+                connect(w);
+                lowlink[v] = std::min(lowlink[v], lowlink[w]);
+            } else if (onStack.count(w)) {
+                lowlink[v] = std::min(lowlink[v], index[w]);
+            }
+        }
+        if (lowlink[v] != index[v]) return;
+
+        std::vector<std::string> component;
+        std::string w;
+        do {
+            w = stack.back();
+            stack.pop_back();
+            onStack.erase(w);
+            component.push_back(w);
+        } while (w != v);
+        if (component.size() > 1 || callGraph[v].count(v)) {
+            recursive.insert(component.begin(), component.end());
+        }
+        order.insert(order.end(), component.begin(), component.end());
+    };
+
+    for (const auto& name : names) {
+        if (!index.count(name)) connect(name);
+    }
+    return order;
+}
+
+// Тело пригодно для встраивания, если это один return без записей в переменные
+// и без обращений ко всему, кроме параметров
+ASTNode* Inliner::inlinableBody(FuncDeclNode& func, std::string& reason) {
+    auto block = dynamic_cast<BlockStatementNode*>(func.body.get());
+    if (!block || block->statements.size() != 1) {
+        reason = "body is not a single return";
+        return nullptr;
+    }
+    auto ret = dynamic_cast<ReturnStatementNode*>(block->statements[0].get());
+    if (!ret || !ret->expression) {
+        reason = "body is not a single return";
+        return nullptr;
+    }
+
+    std::unordered_set<std::string> params;
+    for (auto& p : func.params) params.insert(p->declarator->name);
+    std::unordered_set<std::string> assigned;
+    collectAssigned(*ret->expression, assigned);
+    if (!assigned.empty()) {
+        reason = "body writes to variables";
+        return nullptr;
+    }
+
+    bool ok = true;
+    std::function<void(ASTNode&)> check = [&](ASTNode& node) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(&node)) {
+            if (!params.count(id->name)) ok = false;
+            return;
+        }
+        if (auto call = dynamic_cast<CallExprNode*>(&node)) {
+            for (auto& arg : call->arguments) check(*arg);
+            return;
+        }
+        if (dynamic_cast<ScopedIdentifierExprNode*>(&node) || dynamic_cast<ReadStmtNode*>(&node)) ok = false;
+        forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { check(*child); });
+    };
+    check(*ret->expression);
+    if (!ok) {
+        reason = "body refers to non-parameter names";
+        return nullptr;
+    }
+    return ret->expression.get();
+}
+
+// Аргумент подставляется вместо каждого вхождения параметра: сложный аргумент
+// параметра, который встречается не один раз, исполнялся бы иначе, чем при вызове.
+// Переменную или литерал можно копировать и отбрасывать
+bool Inliner::argumentsUsedOnce(FuncDeclNode& func, ASTNode& body, CallExprNode& call) {
+    std::unordered_map<std::string, int> uses;
+    std::function<void(ASTNode&)> count = [&](ASTNode& node) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(&node)) {
+            ++uses[id->name];
+            return;
+        }
+        if (auto inner = dynamic_cast<CallExprNode*>(&node)) {
+            for (auto& arg : inner->arguments) count(*arg);
+            return;
+        }
+        forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { count(*child); });
+    };
+    count(body);
+
+    for (size_t i = 0; i < call.arguments.size(); ++i) {
+        ASTNode* arg = call.arguments[i].get();
+        while (auto group = dynamic_cast<GroupExprNode*>(arg)) arg = group->expression.get();
+        bool trivial = dynamic_cast<IdentifierExprNode*>(arg) || dynamic_cast<LiteralExprNode*>(arg);
+        if (!trivial && uses[func.params[i]->declarator->name] != 1) return false;
+    }
+    return true;
+}
+
+void Inliner::inlineCalls(std::unique_ptr<ASTNode>& slot, int loopDepth) {
+    if (!slot) return;
+
+    bool isLoop = dynamic_cast<ForLoopNode*>(slot.get()) || dynamic_cast<WhileLoopNode*>(slot.get()) ||
+                  dynamic_cast<DoWhileLoopNode*>(slot.get());
+    if (auto loop = dynamic_cast<ForLoopNode*>(slot.get())) {
+        inlineCalls(loop->init, loopDepth);
+        inlineCalls(loop->condition, loopDepth + 1);
+        inlineCalls(loop->increment, loopDepth + 1);
+        inlineCalls(loop->body, loopDepth + 1);
+        return;
+    }
+    if (isLoop) {
+        forEachSlot(*slot, [&](std::unique_ptr<ASTNode>& child) { inlineCalls(child, loopDepth + 1); });
+        return;
+    }
+
+    auto call = dynamic_cast<CallExprNode*>(slot.get());
+    if (!call) {
+        forEachSlot(*slot, [&](std::unique_ptr<ASTNode>& child) { inlineCalls(child, loopDepth); });
+        return;
+    }
+
+    for (auto& arg : call->arguments) inlineCalls(arg, loopDepth);
+    auto id = dynamic_cast<IdentifierExprNode*>(call->callee.get());
+    if (!id) return;
+
+    InlineDecision decision{currentFunction, id->name, loopDepth};
+    auto it = functions.find(id->name);
+    ASTNode* body = nullptr;
+    size_t threshold = kBaseThreshold + kHotLoopBonus * loopDepth;
+    if (it == functions.end()) {
+        decision.reason = "no definition";
+    } else if (recursive.count(id->name)) {
+        decision.reason = "recursive";
+    } else if (it->second->params.size() != call->arguments.size()) {
+        decision.reason = "argument count mismatch";
+    } else if (!(body = inlinableBody(*it->second, decision.reason))) {
+        // причина уже записана
+    } else if (countNodes(*body) > threshold) {
+        decision.reason = "too large (cost " + std::to_string(countNodes(*body)) + " > threshold " +
+                          std::to_string(threshold) + ")";
+    } else if (!std::all_of(call->arguments.begin(), call->arguments.end(),
+                            [](const std::unique_ptr<ASTNode>& a) { return isPure(*a); })) {
+        decision.reason = "argument has side effects";
+    } else if (!std::all_of(call->arguments.begin(), call->arguments.end(),
+                            [](const std::unique_ptr<ASTNode>& a) { return cannotFail(*a); })) {
+        // Аргумент неиспользуемого параметра пропал бы вместе с ошибкой, а порядок
+        // ошибок в разных аргументах зависел бы от тела
+        decision.reason = "argument can fail at run time";
+    } else if (!argumentsUsedOnce(*it->second, *body, *call)) {
+        decision.reason = "parameter is not used exactly once";
+    } else {
+        // Подстановка одновременная: аргумент может ссылаться на имя другого параметра
+        std::unordered_map<std::string, ASTNode*> args;
+        for (size_t i = 0; i < call->arguments.size(); ++i) {
+            args[it->second->params[i]->declarator->name] = call->arguments[i].get();
+        }
+        AstCloner cloner;
+        std::unique_ptr<ASTNode> expr = cloner.clone(*body);
+        std::function<void(std::unique_ptr<ASTNode>&)> substitute = [&](std::unique_ptr<ASTNode>& s) {
+            if (auto param = dynamic_cast<IdentifierExprNode*>(s.get())) {
+                auto a = args.find(param->name);
+                if (a != args.end()) s = cloner.clone(*a->second);
+                return;
+            }
+            if (auto inner = dynamic_cast<CallExprNode*>(s.get())) {
+                for (auto& arg : inner->arguments) substitute(arg);
+                return;
+            }
+            forEachSlot(*s, substitute);
+        };
+        substitute(expr);
+
+        decision.inlined = true;
+        decision.reason = "cost " + std::to_string(countNodes(*body)) + ", threshold " + std::to_string(threshold);
+        auto group = std::make_unique<GroupExprNode>(std::move(expr));
+        group->resolved_type = static_cast<ExprNode*>(body)->resolved_type;
+        slot = std::move(group);
+    }
+    decisions.push_back(decision);
+}
+
+void Inliner::printReport(std::ostream& out) const {
+    out << "Inliner report:" << std::endl;
+    for (const auto& d : decisions) {
+        out << "  " << d.caller << " -> " << d.callee << " (loop depth " << d.loop_depth << "): "
+            << (d.inlined ? "inlined" : "not inlined") << ", " << d.reason << std::endl;
+    }
+}
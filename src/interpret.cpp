@@ -0,0 +1,156 @@
+#include "../inc/interpret.hpp"
+#include "../inc/bytecode.hpp"
+#include "../inc/compilation.hpp"
+#include "../inc/interpreter.hpp"
+#include "../inc/io.hpp"
+#include "../inc/jit.hpp"
+#include "../inc/scheduler.hpp"
+#include "../inc/tiering.hpp"
+#include <sstream>
+
+namespace interpret {
+
+// Всё, что исполнения только читают
+struct Program::State {
+    std::unique_ptr<ASTNode> tree; // TranslationUnitNode с пулом констант
+    TranslationUnitNode* unit = nullptr;
+    std::vector<BytecodeFunction> bytecode; // копия связывается в каждом исполнении
+    CompileOptions options;
+    std::string report;
+};
+
+namespace {
+
+Termination terminationOf(Limit limit) {
+    switch (limit) {
+    case Limit::Steps: return Termination::Steps;
+    case Limit::Time: return Termination::Time;
+    case Limit::Depth: return Termination::Depth;
+    case Limit::Memory: return Termination::Memory;
+    case Limit::Output: return Termination::Output;
+    }
+    return Termination::Error;
+}
+
+} // namespace
+
+CompileError::CompileError(std::vector<std::string> errors)
+    : std::runtime_error(errors.empty() ? "Compile Error" : errors.front()), messages(std::move(errors)) {}
+
+Program compile(const std::string& source, const CompileOptions& options) {
+    Compilation compilation(source);
+    if (!compilation.run()) throw CompileError(compilation.getErrors());
+
+    auto state = std::make_shared<Program::State>();
+    state->tree = compilation.takeProgram();
+    state->unit = dynamic_cast<TranslationUnitNode*>(state->tree.get());
+    state->options = options;
+    std::ostringstream report;
+    prepareProgram(*state->unit, options.optimize, options.optimize ? &report : nullptr);
+    state->report = report.str();
+    if (options.tier) state->bytecode = compileProgram(*state->unit, *state->unit->constants);
+    return Program(std::move(state));
+}
+
+int Program::run(IO& io, const Limits& publicLimits) const {
+    ExecutionLimits limits;
+    limits.steps = publicLimits.steps;
+    limits.seconds = publicLimits.seconds;
+    limits.callDepth = publicLimits.callDepth;
+    limits.memory = publicLimits.memory;
+    limits.output = publicLimits.output;
+    TranslationUnitNode& unit = *state->unit;
+    OutputBuffer out(io.write ? io.write : [&io](std::string_view text) {
+        io.output += text;
+        return true;
+    });
+    // Перед ожиданием ввода получатель видит всё, что уже напечатано
+    auto read = [&](char* buffer, size_t size) {
+        out.flush();
+        return io.read(buffer, size);
+    };
+    std::unique_ptr<InputBuffer> input = io.read ? std::make_unique<InputBuffer>(read)
+                                                 : std::make_unique<InputBuffer>(std::string_view(io.input));
+    InputBuffer& in = *input;
+    Interpreter interpreter(unit, out, in);
+    // В волокне планировщика: компиляция без фонового потока, без JIT
+    FiberScheduler* scheduler = FiberScheduler::current();
+    std::unique_ptr<Jit> jit;
+    std::unique_ptr<TierManager> tiers;
+    if (state->options.tier) {
+        // Машинный код не уступает поток и не считает шаги и глубину
+        if (state->options.jit && !scheduler && !limits.needsInterpreter()) jit = std::make_unique<Jit>(unit);
+        TierOptions tierOptions{state->options.tierCalls, state->options.tierLoops, false};
+        tierOptions.background = !scheduler;
+        tiers = std::make_unique<TierManager>(unit, jit.get(), tierOptions);
+        std::vector<std::unique_ptr<BytecodeFunction>> code;
+        code.reserve(state->bytecode.size());
+        for (const auto& f : state->bytecode) code.push_back(std::make_unique<BytecodeFunction>(f));
+        tiers->preload(std::move(code));
+        interpreter.setTiers(tiers.get(), false);
+    }
+    if (scheduler) interpreter.setLimits(limits, &Fiber::yield, scheduler->getQuantum());
+    else interpreter.setLimits(limits);
+    int code = 0;
+    io.termination = Termination::Exit;
+    try {
+        code = interpreter.run();
+    } catch (const LimitError& e) {
+        io.errors += e.what();
+        io.errors += '\n';
+        io.termination = terminationOf(e.limit);
+        code = 1;
+    } catch (const RuntimeError& e) {
+        io.errors += e.what();
+        io.errors += '\n';
+        io.termination = Termination::Error;
+        code = 1;
+    }
+    out.flush();
+    // Программа завершилась, но последний сброс вывода упёрся в предел
+    if (out.isTruncated() && io.termination == Termination::Exit) {
+        io.errors += "Runtime Error: Output limit of " + std::to_string(limits.output) + " bytes exceeded\n";
+        io.termination = Termination::Output;
+        code = 1;
+    }
+    return code;
+}
+
+const char* toString(Termination termination) {
+    switch (termination) {
+    case Termination::Exit: return "exit";
+    case Termination::Error: return "error";
+    case Termination::Steps: return "steps";
+    case Termination::Time: return "time";
+    case Termination::Depth: return "depth";
+    case Termination::Memory: return "memory";
+    case Termination::Output: return "output";
+    }
+    return "?";
+}
+
+const std::string& Program::report() const {
+    return state->report;
+}
+
+Scheduler::Scheduler(unsigned threads, int64_t quantum)
+    : fibers(std::make_unique<FiberScheduler>(threads, quantum)) {}
+
+Scheduler::~Scheduler() = default;
+
+void Scheduler::spawn(std::function<void()> task) {
+    fibers->spawn(std::move(task));
+}
+
+void Scheduler::submit(Program program, IO& io, std::function<void(int)> done) {
+    fibers->spawn([program = std::move(program), &io, done = std::move(done)] {
+        int code = program.run(io);
+        if (done) done(code);
+    });
+}
+
+void Scheduler::wait() {
+    fibers->wait();
+}
+
+} // namespace interpret
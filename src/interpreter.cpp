@@ -0,0 +1,765 @@
+#include "../inc/interpreter.hpp"
+#include "../inc/simd.hpp"
+#include "../inc/trace.hpp"
+#include "../inc/type.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+Interpreter::Interpreter(TranslationUnitNode& program, OutputBuffer& out, InputBuffer& in)
+    : program(program), out(out), in(in), constants(constantsOf(program)), traceCalls(Trace::getCallSampling()) {
+    for (auto& decl : program.declarations) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(decl.get()); func && func->body) {
+            functions[func->name] = func;
+        } else if (auto st = dynamic_cast<StructDeclNode*>(decl.get())) {
+            structs[st->name] = st->type.get();
+        }
+    }
+}
+
+void Interpreter::setTiers(TierManager* tiers, bool verify) {
+    this->tiers = tiers;
+    this->verify = verify;
+}
+
+int Interpreter::run() {
+    auto it = functions.find("main");
+    if (it == functions.end()) {
+        throw RuntimeError("Function main is not defined");
+    }
+    Trace::Span span("execute", "execute");
+    try {
+        program.accept(*this); // глобальные переменные
+        std::vector<Value> args;
+        Value code = call(*it->second, args);
+        return code.isInteger() ? static_cast<int>(code.i) : 0;
+    } catch (const ProgramExit& e) {
+        return e.code;
+    }
+}
+
+Value Interpreter::eval(ASTNode& node) {
+    if (counters) counters->node(node);
+    node.accept(*this);
+    return std::move(result);
+}
+
+void Interpreter::exec(ASTNode& node) {
+    if (counters) counters->node(node);
+    node.accept(*this);
+}
+
+// После тела цикла: true — выйти из цикла
+bool Interpreter::loopFlow() {
+    if (flow == Flow::Break) {
+        flow = Flow::Normal;
+        return true;
+    }
+    if (flow == Flow::Continue) flow = Flow::Normal;
+    return flow == Flow::Return;
+}
+
+void Interpreter::setBudget(Budget* budget) {
+    this->budget = budget;
+    if (tiers) tiers->setBudget(budget);
+}
+
+void Interpreter::setLimits(const ExecutionLimits& limits, std::function<void()> yield, int64_t quantum) {
+    if (limits.callDepth > 0) maxDepth = std::min(limits.callDepth, kMaxCallDepth);
+    if (tiers) tiers->setMaxDepth(maxDepth);
+    if (limits.memory) {
+        memory.limit = limits.memory;
+        meter = &memory;
+    }
+    out.setLimit(limits.output);
+    if (!limits.steps && limits.seconds <= 0 && !yield) return;
+
+    // Время проверяется раз в квант: часы не читаются на каждом шаге
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::time_point::max();
+    if (limits.seconds > 0) {
+        deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(limits.seconds));
+    }
+    double seconds = limits.seconds;
+    ownBudget = std::make_unique<Budget>(quantum, [deadline, seconds, yield = std::move(yield)] {
+        if (deadline != Clock::time_point::max() && Clock::now() >= deadline) {
+            std::string text = std::to_string(seconds);
+            text.erase(text.find_last_not_of('0') + 1);
+            if (text.back() == '.') text.pop_back();
+            throw LimitError(Limit::Time, "Time limit of " + text + " s exceeded");
+        }
+        if (yield) yield();
+    }, limits.steps);
+    setBudget(ownBudget.get());
+}
+
+void Interpreter::setProfiler(Profiler* profiler) {
+    this->profiler = profiler;
+    if (tiers) tiers->setProfiler(profiler);
+    if (!profiler) return;
+    if (!budget) {
+        ownBudget = std::make_unique<Budget>(profiler->getQuantum(), nullptr);
+        setBudget(ownBudget.get());
+    }
+    budget->setSampler([profiler] { return profiler->due(); }, profiler->getQuantum());
+}
+
+void Interpreter::setCounters(ExecutionCounters* counters) {
+    this->counters = counters;
+    if (tiers) tiers->setCounters(counters);
+}
+
+void Interpreter::sample(const ASTNode* at) {
+    if (!profiler) return;
+    if (at && !profiler->frames.empty()) profiler->frames.back().line = at->line;
+    profiler->sample();
+}
+
+Value Interpreter::call(FuncDeclNode& func, std::vector<Value>& args) {
+    if (budget && budget->step()) sample(nullptr);
+    Profiler::Call frame(profiler, func.name, func.line);
+    if (traceCalls && ++callsSinceTrace >= traceCalls) {
+        callsSinceTrace = 0;
+        Trace::Span span(func.name);
+        return dispatch(func, args);
+    }
+    return dispatch(func, args);
+}
+
+Value Interpreter::dispatch(FuncDeclNode& func, std::vector<Value>& args) {
+    if (!tiers) return interpretCall(func, args);
+
+    tiers->poll();
+    TierManager::Profile& p = tiers->profile(func);
+    if (p.tier == Tier::Tree) {
+        tiers->countCall(p);
+        TierManager::Profile* saved = profile;
+        profile = &p;
+        Value v = interpretCall(func, args);
+        profile = saved;
+        return v;
+    }
+
+    std::optional<Value> r;
+    if (p.tier == Tier::Native) {
+        // Машинный код есть только у функций над int
+        std::vector<int64_t> raw;
+        raw.reserve(args.size());
+        for (auto& a : args) raw.push_back(a.i);
+        if (auto n = tiers->runNative(p, raw)) r = Value::integer(Value::Kind::Int, *n);
+    }
+    // Машинный код отказался (деление на ноль и т.п.): байт-код повторит вызов
+    // и сообщит об ошибке так же, как интерпретатор
+    if (!r) r = tiers->runBytecode(p, args, depth);
+
+    Value v = *r;
+    if (verify) {
+        // Эталон считается без уровней, в том числе для вложенных вызовов
+        ++verifiedCalls;
+        TierManager* saved = tiers;
+        TierManager::Profile* savedProfile = profile;
+        tiers = nullptr;
+        profile = nullptr;
+        std::vector<Value> copy = args;
+        Value expected = interpretCall(func, copy);
+        tiers = saved;
+        profile = savedProfile;
+        // Вещественные сравниваются побитно: union хранит double в i
+        if (expected.kind != v.kind || expected.i != v.i) {
+            ++mismatches;
+            std::cerr << (p.tier == Tier::Native ? "JIT" : "Bytecode") << " mismatch: " << func.name << "(";
+            for (size_t i = 0; i < args.size(); ++i) std::cerr << (i ? ", " : "") << toString(args[i]);
+            std::cerr << ") = " << toString(v) << ", interpreter = " << toString(expected) << std::endl;
+        }
+    }
+    return v;
+}
+
+Value Interpreter::interpretCall(FuncDeclNode& func, std::vector<Value>& args) {
+    if (depth >= maxDepth) {
+        throw LimitError(Limit::Depth, "Call stack overflow in " + func.name);
+    }
+    std::vector<Value> locals(std::max<size_t>(func.frame_size, args.size()));
+    for (size_t i = 0; i < args.size(); ++i) locals[i] = std::move(args[i]);
+
+    if (counters) counters->node(func);
+    std::vector<Value>* saved = frame;
+    frame = &locals;
+    ++depth;
+    exec(*func.body);
+    --depth;
+    frame = saved;
+    Value ret = flow == Flow::Return ? std::move(returnValue) : Value();
+    flow = Flow::Normal;
+
+    auto type = dynamic_cast<TypeNode*>(func.return_type.get());
+    Value::Kind kind = type ? kindOf(type->type_name, type->is_unsigned) : Value::Kind::Void;
+    if (kind == Value::Kind::Void || !(ret.isInteger() || ret.isFloating())) return ret;
+    return convertTo(ret, kind);
+}
+
+// Значение по умолчанию: нули, структуры — обнулённая память по раскладке
+Value Interpreter::defaultValue(TypeNode& type) {
+    auto st = structs.find(type.type_name);
+    if (st != structs.end()) return makeStruct(st->second, meter);
+    Value::Kind kind = kindOf(type.type_name, type.is_unsigned);
+    return kind == Value::Kind::Float || kind == Value::Kind::Double ? Value::floating(kind, 0)
+                                                                     : Value::integer(kind, 0);
+}
+
+// Начальное значение переменной; объявление всегда инициализирует слот
+Value Interpreter::declare(TypeNode& type, InitDeclaratorNode& decl) {
+    auto st = structs.find(type.type_name);
+    if (decl.declarator->array_size) {
+        Value size = eval(*decl.declarator->array_size);
+        if (!size.isInteger() || size.i < 0) {
+            throw RuntimeError("Invalid array size for " + decl.declarator->name);
+        }
+        // Элементы лежат подряд без тегов: скаляры нужной ширины или структуры по раскладке
+        Storage element;
+        if (st != structs.end()) {
+            element.kind = Value::Kind::Struct;
+            element.layout = st->second;
+        } else {
+            element.kind = kindOf(type.type_name, type.is_unsigned);
+        }
+        Value arr = makeArray(element, static_cast<size_t>(size.i), meter);
+        if (auto list = dynamic_cast<InitListNode*>(decl.initializer.get())) {
+            if (list->elements.size() > arr.length()) {
+                throw RuntimeError("Too many initializers for " + decl.declarator->name);
+            }
+            size_t stride = element.size();
+            initialize(*arr.agg, *list, [&](size_t k) { return std::make_pair(k * stride, element); });
+        }
+        return arr;
+    }
+
+    Value v = defaultValue(type);
+    if (auto list = dynamic_cast<InitListNode*>(decl.initializer.get())) {
+        // Инициализация структуры по порядку полей
+        if (st == structs.end()) throw RuntimeError("Initializer list for scalar " + decl.declarator->name);
+        const auto& fields = st->second->layout;
+        if (list->elements.size() > fields.size()) {
+            throw RuntimeError("Too many initializers for " + decl.declarator->name);
+        }
+        initialize(*v.agg, *list, [&](size_t k) { return std::make_pair(fields[k].offset, fields[k].storage); });
+    } else if (decl.initializer) {
+        store(&v, eval(*decl.initializer));
+    }
+    return v;
+}
+
+// Список из одних числовых литералов собирается в байты один раз и хранится
+// в пуле констант; каждое следующее объявление копирует их целиком
+void Interpreter::initialize(Aggregate& memory, InitListNode& list,
+                             const std::function<std::pair<size_t, Storage>(size_t)>& element) {
+    auto it = constantLists.find(&list);
+    if (it == constantLists.end()) {
+        bool constant = !list.elements.empty();
+        for (auto& e : list.elements) {
+            ASTNode* node = e.get();
+            if (auto un = dynamic_cast<UnaryExprNode*>(node); un && un->op == "-") node = un->operand.get();
+            auto lit = dynamic_cast<LiteralExprNode*>(node);
+            auto type = lit ? dynamic_cast<TypeNode*>(lit->type.get()) : nullptr;
+            if (!type || type->type_name == "string") constant = false;
+        }
+        std::vector<unsigned char> image;
+        if (constant) {
+            auto [offset, last] = element(list.elements.size() - 1);
+            Aggregate scratch;
+            scratch.raw.assign(offset + last.size(), 0);
+            for (size_t k = 0; k < list.elements.size(); ++k) {
+                auto [at, what] = element(k);
+                storeRaw(scratch, at, what, eval(*list.elements[k]));
+            }
+            image = std::move(scratch.raw);
+        }
+        it = constantLists.emplace(&list, std::move(image)).first;
+    }
+    if (!it->second.empty()) {
+        std::memcpy(memory.raw.data(), it->second.data(), it->second.size());
+        return;
+    }
+    for (size_t k = 0; k < list.elements.size(); ++k) {
+        auto [at, what] = element(k);
+        storeRaw(memory, at, what, eval(*list.elements[k]));
+    }
+}
+
+void Interpreter::store(const Place& target, const Value& v) {
+    if (target.value) store(target.value, v);
+    else storeRaw(**target.memory, target.offset, target.what, v);
+}
+
+// Запись с приведением к виду переменной
+void Interpreter::store(Value* target, const Value& v) {
+    if (target->kind == Value::Kind::Struct && v.kind == Value::Kind::Struct && target->layout == v.layout) {
+        // Переменная владеет своей памятью: копия ложится на место старой
+        storeRaw(*target->agg, target->offset, Storage{Value::Kind::Struct, Value::Kind::Void, 0, v.layout}, v);
+    } else if (target->kind == Value::Kind::Struct || target->kind == Value::Kind::Array ||
+               target->kind == Value::Kind::Void || target->kind == Value::Kind::String) {
+        *target = copyValue(v, meter);
+    } else {
+        *target = convertTo(v, target->kind);
+    }
+}
+
+Value* Interpreter::lvalue(ASTNode& node) {
+    if (auto id = dynamic_cast<IdentifierExprNode*>(&node)) {
+        if (id->slot >= 0) return &(*frame)[id->slot];
+        auto it = globals.find(id->name);
+        if (it == globals.end()) throw RuntimeError("Unknown variable " + id->name);
+        return &it->second;
+    }
+    if (auto scoped = dynamic_cast<ScopedIdentifierExprNode*>(&node)) {
+        auto it = globals.find(scoped->getName());
+        if (it == globals.end()) throw RuntimeError("Unknown variable " + scoped->getName());
+        return &it->second;
+    }
+    if (auto group = dynamic_cast<GroupExprNode*>(&node)) {
+        return lvalue(*group->expression);
+    }
+    if (auto un = dynamic_cast<UnaryExprNode*>(&node); un && un->op == "&") {
+        return lvalue(*un->operand);
+    }
+    throw RuntimeError("Expression is not assignable");
+}
+
+// Поле — смещение от начала структуры, элемент — смещение от начала массива;
+// хеш-таблиц по именам полей нет
+Interpreter::Place Interpreter::place(ASTNode& node) {
+    if (auto mem = dynamic_cast<MemberAccessExprNode*>(&node)) {
+        Place base = place(*mem->object);
+        if (base.value) {
+            if (base.value->kind != Value::Kind::Struct) throw RuntimeError("Member access on non-struct value");
+            base = Place{nullptr, &base.value->agg, base.value->offset};
+        }
+        if (!mem->field) throw RuntimeError("No member " + mem->member);
+        return Place{nullptr, base.memory, base.offset + mem->field->offset, mem->field->storage};
+    }
+    auto sub = dynamic_cast<SubscriptExprNode*>(&node);
+    if (!sub) return Place{lvalue(node)};
+    Value index = eval(*sub->index);
+    Place base = place(*sub->array);
+    Storage element;
+    size_t size = 0;
+    if (base.value) {
+        const Value& arr = *base.value;
+        if (arr.kind != Value::Kind::Array) throw RuntimeError("Subscript of non-array value");
+        element.kind = arr.element;
+        if (arr.element == Value::Kind::Struct) element.layout = arr.layout;
+        size = arr.length();
+        base = Place{nullptr, &arr.agg, arr.offset};
+    } else {
+        if (base.what.kind != Value::Kind::Array) throw RuntimeError("Subscript of non-array value");
+        element.kind = base.what.element;
+        size = base.what.count;
+    }
+    int64_t k = index.asInt();
+    if (sub->checked && (k < 0 || k >= static_cast<int64_t>(size))) {
+        throw RuntimeError("Array index " + std::to_string(k) + " out of bounds [0, " + std::to_string(size) + ")");
+    }
+    return Place{nullptr, base.memory, base.offset + static_cast<size_t>(k) * element.size(), element};
+}
+
+Value Interpreter::arithmetic(const std::string& op, const Value& l, const Value& r) {
+    using K = Value::Kind;
+    if (l.isFloating() || r.isFloating()) {
+        double a = l.asDouble(), b = r.asDouble();
+        K kind = (l.kind == K::Double || r.kind == K::Double) ? K::Double : K::Float;
+        if (op == "+") return Value::floating(kind, a + b);
+        if (op == "-") return Value::floating(kind, a - b);
+        if (op == "*") return Value::floating(kind, a * b);
+        if (op == "/") return Value::floating(kind, a / b);
+        if (op == "<") return Value::integer(K::Int, a < b);
+        if (op == "<=") return Value::integer(K::Int, a <= b);
+        if (op == ">") return Value::integer(K::Int, a > b);
+        if (op == ">=") return Value::integer(K::Int, a >= b);
+        if (op == "==") return Value::integer(K::Int, a == b);
+        if (op == "!=") return Value::integer(K::Int, a != b);
+        throw RuntimeError("Operator " + op + " is not defined for floating values");
+    }
+
+    // Целочисленное продвижение как в C: не уже int
+    K kind = std::max({l.kind, r.kind, K::Int});
+    bool isUnsigned = kind == K::UInt || kind == K::ULong;
+    int64_t a = l.i, b = r.i;
+    if (op == "+") return Value::integer(kind, static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)));
+    if (op == "-") return Value::integer(kind, static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)));
+    if (op == "*") return Value::integer(kind, static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)));
+    if (op == "/" || op == "%") {
+        if (b == 0) throw RuntimeError("Division by zero");
+        if (isUnsigned) {
+            uint64_t ua = static_cast<uint64_t>(a), ub = static_cast<uint64_t>(b);
+            return Value::integer(kind, static_cast<int64_t>(op == "/" ? ua / ub : ua % ub));
+        }
+        if (b == -1) return Value::integer(kind, op == "/" ? static_cast<int64_t>(0 - static_cast<uint64_t>(a)) : 0);
+        return Value::integer(kind, op == "/" ? a / b : a % b);
+    }
+    if (isUnsigned) {
+        uint64_t ua = static_cast<uint64_t>(a), ub = static_cast<uint64_t>(b);
+        if (op == "<") return Value::integer(K::Int, ua < ub);
+        if (op == "<=") return Value::integer(K::Int, ua <= ub);
+        if (op == ">") return Value::integer(K::Int, ua > ub);
+        if (op == ">=") return Value::integer(K::Int, ua >= ub);
+    }
+    if (op == "<") return Value::integer(K::Int, a < b);
+    if (op == "<=") return Value::integer(K::Int, a <= b);
+    if (op == ">") return Value::integer(K::Int, a > b);
+    if (op == ">=") return Value::integer(K::Int, a >= b);
+    if (op == "==") return Value::integer(K::Int, a == b);
+    if (op == "!=") return Value::integer(K::Int, a != b);
+    throw RuntimeError("Unknown binary operator " + op);
+}
+
+void Interpreter::visit(TranslationUnitNode& node) {
+    for (auto& decl : node.declarations) {
+        if (dynamic_cast<VarDeclNode*>(decl.get())) exec(*decl);
+    }
+}
+
+void Interpreter::visit(TypeNode& node) {}
+void Interpreter::visit(DeclaratorNode& node) {}
+void Interpreter::visit(InitDeclaratorNode& node) {}
+void Interpreter::visit(ParamDeclNode& node) {}
+void Interpreter::visit(FuncDeclNode& node) {}
+void Interpreter::visit(StructDeclNode& node) {}
+void Interpreter::visit(NamespaceDeclNode& node) {}
+
+void Interpreter::visit(VarDeclNode& node) {
+    auto type = dynamic_cast<TypeNode*>(node.type.get());
+    for (auto& d : node.declarators) {
+        Value v = declare(*type, *d);
+        if (d->declarator->slot >= 0) (*frame)[d->declarator->slot] = std::move(v);
+        else globals[d->declarator->name] = std::move(v);
+    }
+}
+
+void Interpreter::visit(BlockStatementNode& node) {
+    for (auto& stmt : node.statements) {
+        exec(*stmt);
+        if (flow != Flow::Normal) return;
+    }
+}
+
+void Interpreter::visit(IfStatementNode& node) {
+    if (eval(*node.condition).truthy()) exec(*node.then_branch);
+    else if (node.else_branch) exec(*node.else_branch);
+}
+
+void Interpreter::visit(WhileLoopNode& node) {
+    TierManager::LoopProfile* loop = loopProfile(node);
+    while (eval(*node.condition).truthy()) {
+        exec(*node.body);
+        if (budget && budget->step()) sample(&node);
+        if (loopFlow() || backEdge(loop) == Osr::Finished) return;
+    }
+}
+
+void Interpreter::visit(DoWhileLoopNode& node) {
+    TierManager::LoopProfile* loop = loopProfile(node);
+    do {
+        exec(*node.body);
+        if (budget && budget->step()) sample(&node);
+        if (loopFlow() || backEdge(loop) == Osr::Finished) return;
+    } while (eval(*node.condition).truthy());
+}
+
+void Interpreter::visit(ForLoopNode& node) {
+    if (node.init) exec(*node.init);
+    // Векторное ядро не исполняет узлы тела: со счётчиками цикл идёт по дереву
+    if (node.vector && !counters && runVector(*node.vector)) return;
+    TierManager::LoopProfile* loop = loopProfile(node);
+    while (!node.condition || eval(*node.condition).truthy()) {
+        exec(*node.body);
+        if (budget && budget->step()) sample(&node);
+        if (loopFlow()) return;
+        if (node.increment) exec(*node.increment);
+        Osr osr = backEdge(loop);
+        if (osr == Osr::Finished) return;
+        if (osr == Osr::Resumed && node.increment) exec(*node.increment);
+    }
+}
+
+// Весь цикл одним вызовом векторного ядра. Если хоть один массив короче диапазона
+// счётчика, цикл исполняется обычным образом и сообщает об ошибке на нужной итерации
+bool Interpreter::runVector(const VectorLoop& plan) {
+    Place counter = place(*plan.counter);
+    int64_t from = counter.get().asInt();
+    int64_t to = eval(*plan.bound).asInt() + (plan.inclusive ? 1 : 0);
+    if (to <= from || from < 0) return false;
+    size_t n = static_cast<size_t>(to - from);
+    size_t width = Aggregate::kindSize(plan.kind);
+
+    Aggregate scalars;
+    scalars.raw.assign(2 * width, 0);
+    auto operand = [&](ASTNode* node, bool array, size_t slot, VectorOperand& out) {
+        Value v = eval(*node);
+        if (!array) {
+            storeRaw(scalars, slot * width, Storage{plan.kind}, v);
+            out = VectorOperand{scalars.raw.data() + slot * width, true};
+            return true;
+        }
+        if (static_cast<size_t>(to) > v.length()) return false;
+        out = VectorOperand{v.agg->raw.data() + v.offset + static_cast<size_t>(from) * width, false};
+        return true;
+    };
+    VectorOperand x, y;
+    if (!operand(plan.x, plan.xArray, 0, x)) return false;
+    if (plan.y && !operand(plan.y, plan.yArray, 1, y)) return false;
+
+    if (plan.shape == VectorLoop::Shape::Map) {
+        Value target = eval(*plan.target);
+        if (static_cast<size_t>(to) > target.length()) return false;
+        vectorMap(plan.op, plan.kind, target.agg->raw.data() + target.offset + static_cast<size_t>(from) * width, x, y, n);
+    } else {
+        Place sum = place(*plan.target);
+        int64_t total = vectorSum(plan.op, plan.kind, x, y, n);
+        store(sum, Value::integer(plan.kind, static_cast<int64_t>(static_cast<uint64_t>(sum.get().i) + static_cast<uint64_t>(total))));
+    }
+    store(counter, Value::integer(Value::Kind::Int, to));
+    return true;
+}
+
+// Счётчики обратного перехода; если цикл уже в байт-коде, кадр переходит в него
+Interpreter::Osr Interpreter::backEdge(TierManager::LoopProfile* loop) {
+    if (!loop) return Osr::None;
+    tiers->countBackEdge(*profile);
+    if (!tiers->countLoop(*loop)) return Osr::None;
+    return enterLoop(*loop);
+}
+
+// Замена на стеке: значения переменных переносятся из кадра в слоты байт-кода
+// и обратно. Деоптимизация возвращает в интерпретатор посреди итерации:
+// он исполняет оператор точки возобновления и остатки объемлющих блоков
+Interpreter::Osr Interpreter::enterLoop(TierManager::LoopProfile& loop) {
+    std::vector<Value>& locals = *frame;
+    const BytecodeFunction* code = loop.code;
+    // Слот переносится по виду, который ему назначил компилятор цикла
+    std::vector<Slot> slots(locals.size(), Slot{});
+    for (size_t i = 0; i < locals.size() && i < code->slot_kinds.size(); ++i) {
+        if (code->slot_kinds[i] != Value::Kind::Void && (locals[i].isInteger() || locals[i].isFloating())) {
+            slots[i] = toSlot(locals[i], code->slot_kinds[i]);
+        }
+    }
+
+    BytecodeVM::LoopExit exit = tiers->runLoop(loop, slots, depth);
+    for (int slot : loop.stores) locals[slot] = fromSlot(slots[slot], code->slot_kinds[slot]);
+
+    if (exit.op == Op::Exit) return Osr::Finished;
+    if (exit.op == Op::Ret) {
+        returnValue = fromSlot(exit.value, code->return_kind);
+        flow = Flow::Return;
+        return Osr::Finished;
+    }
+    const ResumePoint& point = code->resume[exit.point];
+    exec(*point.statement);
+    for (auto [block, next] : point.rest) {
+        for (size_t i = next; i < block->statements.size() && flow == Flow::Normal; ++i) {
+            exec(*block->statements[i]);
+        }
+    }
+    return loopFlow() ? Osr::Finished : Osr::Resumed;
+}
+
+void Interpreter::visit(ReturnStatementNode& node) {
+    returnValue = node.expression ? copyValue(eval(*node.expression), meter) : Value();
+    flow = Flow::Return;
+}
+
+void Interpreter::visit(BreakStmtNode& node) {
+    flow = Flow::Break;
+}
+
+void Interpreter::visit(ContinueStmtNode& node) {
+    flow = Flow::Continue;
+}
+
+void Interpreter::visit(BinaryExprNode& node) {
+    if (node.op == "&&") {
+        bool v = eval(*node.left).truthy() && eval(*node.right).truthy();
+        result = Value::integer(Value::Kind::Int, v);
+        return;
+    }
+    if (node.op == "||") {
+        bool v = eval(*node.left).truthy() || eval(*node.right).truthy();
+        result = Value::integer(Value::Kind::Int, v);
+        return;
+    }
+    Value l = eval(*node.left);
+    Value r = eval(*node.right);
+    result = arithmetic(node.op, l, r);
+}
+
+void Interpreter::visit(UnaryExprNode& node) {
+    if (node.op == "++" || node.op == "--") {
+        Place target = place(*node.operand);
+        store(target, arithmetic(node.op == "++" ? "+" : "-", target.get(), Value::integer(Value::Kind::Int, 1)));
+        result = target.get();
+        return;
+    }
+    if (node.op == "&") {
+        result = eval(*node.operand);
+        return;
+    }
+    Value v = eval(*node.operand);
+    if (node.op == "-") {
+        result = v.isFloating() ? Value::floating(v.kind, -v.f) : arithmetic("-", Value::integer(Value::Kind::Int, 0), v);
+    } else if (node.op == "!") {
+        result = Value::integer(Value::Kind::Int, !v.truthy());
+    } else if (node.op == "+") {
+        result = v;
+    } else {
+        throw RuntimeError("Unsupported unary operator " + node.op);
+    }
+}
+
+void Interpreter::visit(TernaryExprNode& node) {
+    result = eval(eval(*node.condition).truthy() ? *node.then_expr : *node.else_expr);
+}
+
+void Interpreter::visit(CastExprNode& node) {
+    auto type = dynamic_cast<TypeNode*>(node.type.get());
+    result = convertTo(eval(*node.expression), kindOf(type->type_name, type->is_unsigned));
+}
+
+void Interpreter::visit(SubscriptExprNode& node) {
+    result = place(node).get();
+}
+
+void Interpreter::visit(CallExprNode& node) {
+    auto callee = dynamic_cast<IdentifierExprNode*>(node.callee.get());
+    auto it = callee ? functions.find(callee->name) : functions.end();
+    if (it == functions.end()) {
+        throw RuntimeError("Call to undefined function");
+    }
+    FuncDeclNode& func = *it->second;
+    std::vector<Value> args;
+    args.reserve(node.arguments.size());
+    for (size_t i = 0; i < node.arguments.size(); ++i) {
+        Value arg = copyValue(eval(*node.arguments[i]), meter);
+        auto type = dynamic_cast<TypeNode*>(func.params[i]->type.get());
+        Value::Kind kind = kindOf(type->type_name, type->is_unsigned);
+        args.push_back(kind != Value::Kind::Void && (arg.isInteger() || arg.isFloating()) ? convertTo(arg, kind) : arg);
+    }
+    if (profiler && !profiler->frames.empty()) profiler->frames.back().line = node.line;
+    result = call(func, args);
+}
+
+void Interpreter::visit(LiteralExprNode& node) {
+    if (node.constant == ConstantPool::kNone) throw RuntimeError("Invalid literal " + node.value);
+    result = constants.at(node.constant);
+}
+
+void Interpreter::visit(IdentifierExprNode& node) {
+    result = *lvalue(node);
+}
+
+void Interpreter::visit(ScopedIdentifierExprNode& node) {
+    result = *lvalue(node);
+}
+
+void Interpreter::visit(GroupExprNode& node) {
+    node.expression->accept(*this);
+}
+
+void Interpreter::visit(PostfixExprNode& node) {
+    Place target = place(*node.expr);
+    Value old = target.get();
+    store(target, arithmetic(node.op == "++" ? "+" : "-", old, Value::integer(Value::Kind::Int, 1)));
+    result = old;
+}
+
+void Interpreter::visit(InitListNode& node) {
+    throw RuntimeError("Initializer list outside of a declaration");
+}
+
+void Interpreter::visit(SizeofExprNode& node) {
+    if (node.size < 0) throw RuntimeError("sizeof of unchecked expression");
+    result = Value::integer(Value::Kind::Int, node.size);
+}
+
+void Interpreter::visit(StaticAssertNode& node) {
+    if (!eval(*node.condition).truthy()) {
+        throw RuntimeError("Static assertion failed: " + node.message);
+    }
+}
+
+void Interpreter::visit(ExitExprNode& node) {
+    int code = node.arguments.empty() ? 0 : static_cast<int>(eval(*node.arguments[0]).asInt());
+    out.flush();
+    throw ProgramExit{code};
+}
+
+void Interpreter::visit(AssertExprNode& node) {
+    if (!node.arguments.empty() && !eval(*node.arguments[0]).truthy()) {
+        throw RuntimeError("Assertion failed");
+    }
+    result = Value();
+}
+
+void Interpreter::visit(ReadStmtNode& node) {
+    Place target = place(*node.argument);
+    Value current = target.get();
+    // В построчном режиме приглашение должно появиться до ожидания ввода
+    if (out.isLineBuffered()) out.flush();
+    bool ok = false;
+    if (current.isFloating()) {
+        double v = 0;
+        ok = in.readDouble(v);
+        store(target, Value::floating(current.kind, v));
+    } else if (current.kind == Value::Kind::Char || current.kind == Value::Kind::UChar) {
+        char c = 0;
+        ok = in.readChar(c);
+        store(target, Value::integer(current.kind, c));
+    } else if (current.isInteger()) {
+        long long v = 0;
+        ok = in.readInt(v);
+        store(target, Value::integer(current.kind, v));
+    } else {
+        throw RuntimeError("read() expects a scalar variable");
+    }
+    if (!ok) throw RuntimeError("Failed to read input");
+}
+
+void Interpreter::visit(PrintStmtNode& node) {
+    Value v = eval(*node.argument);
+    using K = Value::Kind;
+    switch (v.kind) {
+    case K::Float:
+    case K::Double: out.writeDouble(v.f); break;
+    case K::ULong: out.writeUInt(static_cast<uint64_t>(v.i)); break;
+    case K::Char:
+    case K::UChar: out.put(static_cast<char>(v.i)); break;
+    case K::String: out.write(*v.s); break;
+    case K::Bool: out.write(v.i ? "true" : "false"); break;
+    default:
+        if (v.isInteger()) out.writeInt(v.i);
+        else out.write(toString(v));
+    }
+    out.endLine();
+}
+
+void Interpreter::visit(AssignmentExprNode& node) {
+    Value v = eval(*node.right);
+    Place target = place(*node.left);
+    if (node.op == "=") {
+        store(target, v);
+    } else {
+        store(target, arithmetic(node.op.substr(0, 1), target.get(), v));
+    }
+    result = target.get();
+}
+
+void Interpreter::visit(MemberAccessExprNode& node) {
+    if (!dynamic_cast<CallExprNode*>(node.object.get())) {
+        result = place(node).get();
+        return;
+    }
+    // Поле временного значения, например f().x
+    Value base = eval(*node.object);
+    if (base.kind != Value::Kind::Struct) throw RuntimeError("Member access on non-struct value");
+    if (!node.field) throw RuntimeError("No member " + node.member);
+    result = loadRaw(base.agg, base.offset + node.field->offset, node.field->storage);
+}
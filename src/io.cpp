@@ -0,0 +1,176 @@
+#include "../inc/io.hpp"
+#include "../inc/limits.hpp"
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+OutputBuffer::OutputBuffer(int fd, bool lineBuffered) : fd(fd), lineBuffered(lineBuffered), buffer(kCapacity) {}
+
+OutputBuffer::OutputBuffer(std::function<bool(std::string_view)> sink)
+    : fd(-1), sink(std::move(sink)), lineBuffered(false), buffer(kCapacity) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+char* OutputBuffer::reserve(size_t n) {
+    if (used + n > buffer.size()) {
+        flush();
+        checkLimit();
+        if (n > buffer.size()) buffer.resize(n);
+    }
+    return buffer.data() + used;
+}
+
+void OutputBuffer::checkLimit() {
+    if (truncated) throw LimitError(Limit::Output, "Output limit of " + std::to_string(limit) + " bytes exceeded");
+}
+
+void OutputBuffer::put(char c) {
+    *reserve(1) = c;
+    ++used;
+}
+
+void OutputBuffer::write(std::string_view text) {
+    // Длинный текст не копируется: буфер сбрасывается, текст пишется сразу
+    if (text.size() > buffer.size() / 2) {
+        flush();
+        send(text.data(), text.size());
+        checkLimit();
+        return;
+    }
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    used += text.size();
+}
+
+void OutputBuffer::writeInt(int64_t v) {
+    char* p = reserve(24);
+    used = std::to_chars(p, p + 24, v).ptr - buffer.data();
+}
+
+void OutputBuffer::writeUInt(uint64_t v) {
+    char* p = reserve(24);
+    used = std::to_chars(p, p + 24, v).ptr - buffer.data();
+}
+
+void OutputBuffer::writeDouble(double v) {
+    char* p = reserve(32);
+    used = std::to_chars(p, p + 32, v, std::chars_format::general, 6).ptr - buffer.data();
+}
+
+void OutputBuffer::endLine() {
+    put('\n');
+    if (lineBuffered) {
+        flush();
+        checkLimit();
+    }
+}
+
+bool OutputBuffer::flush() {
+    bool ok = send(buffer.data(), used);
+    used = 0;
+    return ok;
+}
+
+bool OutputBuffer::send(const char* data, size_t size) {
+    if (limit && size > limit - written) {
+        size = static_cast<size_t>(limit - written);
+        truncated = true;
+    }
+    written += size;
+    if (size == 0) return true;
+    if (sink) return sink(std::string_view(data, size));
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+InputBuffer::InputBuffer(int fd) : fd(fd), buffer(kBlock) {}
+
+InputBuffer::InputBuffer(std::string_view text) : fd(-1), buffer(text.begin(), text.end()), end(text.size()), eof(true) {}
+
+InputBuffer::InputBuffer(std::function<size_t(char*, size_t)> source)
+    : fd(-1), source(std::move(source)), buffer(kBlock) {}
+
+bool InputBuffer::fill() {
+    if (eof) return false;
+    if (pos > 0) {
+        std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+        end -= pos;
+        pos = 0;
+    }
+    if (buffer.size() - end < kBlock) buffer.resize(end + kBlock);
+    if (source) {
+        size_t n = source(buffer.data() + end, buffer.size() - end);
+        if (n == 0) {
+            eof = true;
+            return false;
+        }
+        end += n;
+        return true;
+    }
+    for (;;) {
+        ssize_t n = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            eof = true;
+            return false;
+        }
+        end += static_cast<size_t>(n);
+        return true;
+    }
+}
+
+bool InputBuffer::skipSpace() {
+    for (;;) {
+        while (pos < end && std::isspace(static_cast<unsigned char>(buffer[pos]))) ++pos;
+        if (pos < end) return true;
+        if (!fill()) return false;
+    }
+}
+
+size_t InputBuffer::word() {
+    size_t len = 0;
+    for (;;) {
+        while (pos + len < end && !std::isspace(static_cast<unsigned char>(buffer[pos + len]))) ++len;
+        if (pos + len < end || !fill()) return len;
+    }
+}
+
+bool InputBuffer::readInt(long long& v) {
+    if (!skipSpace()) return false;
+    size_t len = word(); // может сдвинуть буфер
+    const char* first = buffer.data() + pos;
+    const char* last = first + len;
+    if (first != last && *first == '+') ++first;
+    auto [ptr, ec] = std::from_chars(first, last, v);
+    if (ec != std::errc()) return false;
+    pos = ptr - buffer.data();
+    return true;
+}
+
+bool InputBuffer::readDouble(double& v) {
+    if (!skipSpace()) return false;
+    size_t len = word(); // может сдвинуть буфер
+    const char* first = buffer.data() + pos;
+    const char* last = first + len;
+    if (first != last && *first == '+') ++first;
+    auto [ptr, ec] = std::from_chars(first, last, v);
+    if (ec != std::errc()) return false;
+    pos = ptr - buffer.data();
+    return true;
+}
+
+bool InputBuffer::readChar(char& c) {
+    if (!skipSpace()) return false;
+    c = buffer[pos++];
+    return true;
+}
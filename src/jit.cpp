@@ -0,0 +1,377 @@
+#include "../inc/jit.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Буфер машинного кода с записью little-endian операндов
+struct CodeBuffer {
+    std::vector<uint8_t> bytes;
+
+    void emit(std::initializer_list<uint8_t> data) { bytes.insert(bytes.end(), data); }
+    void u32(uint32_t v) {
+        for (int k = 0; k < 4; ++k) bytes.push_back(static_cast<uint8_t>(v >> (8 * k)));
+    }
+    void u64(uint64_t v) {
+        for (int k = 0; k < 8; ++k) bytes.push_back(static_cast<uint8_t>(v >> (8 * k)));
+    }
+    // mov rax/rcx, imm64
+    void movRax(const void* p) { emit({0x48, 0xB8}); u64(reinterpret_cast<uint64_t>(p)); }
+    void movRcx(const void* p) { emit({0x48, 0xB9}); u64(reinterpret_cast<uint64_t>(p)); }
+    // Место под rel32, заполняется после раскладки
+    size_t rel32() {
+        size_t at = bytes.size();
+        u32(0);
+        return at;
+    }
+    void patch(size_t at, size_t target) {
+        int32_t rel = static_cast<int32_t>(target) - static_cast<int32_t>(at + 4);
+        std::memcpy(&bytes[at], &rel, 4);
+    }
+    size_t size() const { return bytes.size(); }
+};
+
+int32_t localOffset(int slot) {
+    return -16 - 8 * slot;
+}
+
+// Шаблоны есть только для int: причина отказа или пустая строка
+std::string intOnly(const BytecodeFunction& func) {
+    if (func.return_kind != Value::Kind::Int) return "return type is not int";
+    for (Value::Kind kind : func.param_kinds) {
+        if (kind != Value::Kind::Int) return "parameter is not int";
+    }
+    for (const Instr& in : func.code) {
+        bool typed = in.op > Op::Deopt || (in.op == Op::CmpJz && static_cast<Op>(in.b) > Op::Ne);
+        if (typed) return "uses values other than int";
+    }
+    return "";
+}
+
+} // namespace
+
+Jit::Jit(TranslationUnitNode& program) : constants(constantsOf(program)) {
+    for (auto& decl : program.declarations) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(decl.get()); func && func->body) {
+            functions[func->name] = func;
+        }
+    }
+    if (isSupported()) emitEntry();
+}
+
+Jit::~Jit() {
+#if defined(__x86_64__)
+    for (auto& r : regions) munmap(r.base, r.size);
+#endif
+}
+
+bool Jit::isSupported() {
+#if defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void* Jit::install(const std::vector<uint8_t>& code) {
+#if defined(__x86_64__)
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (code.size() + page - 1) / page * page;
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return nullptr;
+    std::memcpy(mem, code.data(), code.size());
+    // W^X: после записи память только читается и исполняется
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        return nullptr;
+    }
+    regions.push_back({mem, size});
+    return mem;
+#else
+    return nullptr;
+#endif
+}
+
+// Переходник из C++: сохраняет callee-saved регистры и вершину стека,
+// к которой возвращается обработчик отказа
+void Jit::emitEntry() {
+    CodeBuffer c;
+    c.emit({0x55, 0x53, 0x41, 0x54});             // push rbp; push rbx; push r12
+    c.movRax(&savedStack);
+    c.emit({0x48, 0x89, 0x20});                   // mov [rax], rsp
+    c.emit({0x48, 0x89, 0xF8});                   // mov rax, rdi
+    c.emit({0x48, 0x89, 0xF7});                   // mov rdi, rsi
+    c.emit({0xFF, 0xD0});                         // call rax
+    c.emit({0x41, 0x5C, 0x5B, 0x5D, 0xC3});       // pop r12; pop rbx; pop rbp; ret
+    entry = reinterpret_cast<Entry>(install(c.bytes));
+}
+
+std::vector<uint8_t> Jit::translate(const BytecodeFunction& func) {
+    CodeBuffer c;
+    std::vector<size_t> offsets(func.code.size() + 1);
+    std::vector<std::pair<size_t, int32_t>> jumps;  // (место rel32, номер инструкции)
+    std::vector<size_t> bails;
+
+    // Пролог: кадр, счётчик глубины, копирование аргументов в слоты 0..n-1
+    int frame = std::max(func.frame_size, func.param_count);
+    c.emit({0x55, 0x48, 0x89, 0xE5, 0x53});        // push rbp; mov rbp, rsp; push rbx
+    if (frame > 0) {
+        c.emit({0x48, 0x81, 0xEC});                 // sub rsp, imm32
+        c.u32(8 * frame);
+    }
+    c.movRax(&depth);
+    c.emit({0x48, 0xFF, 0x00});                     // inc qword [rax]
+    c.emit({0x48, 0x81, 0x38});                     // cmp qword [rax], imm32
+    c.u32(kMaxDepth);
+    c.emit({0x0F, 0x8F});                           // jg bail
+    bails.push_back(c.rel32());
+    for (int i = 0; i < func.param_count; ++i) {
+        c.emit({0x48, 0x8B, 0x87});                 // mov rax, [rdi + disp32]
+        c.u32(8 * (func.param_count - 1 - i));
+        c.emit({0x48, 0x89, 0x85});                 // mov [rbp + disp32], rax
+        c.u32(localOffset(i));
+    }
+
+    auto binary = [&](std::initializer_list<uint8_t> body) {
+        c.emit({0x59, 0x58});                       // pop rcx; pop rax
+        c.emit(body);
+        c.emit({0x48, 0x63, 0xC0, 0x50});           // movsxd rax, eax; push rax
+    };
+    auto compare = [&](uint8_t setcc) {
+        c.emit({0x59, 0x58, 0x39, 0xC8});           // pop rcx; pop rax; cmp eax, ecx
+        c.emit({0x0F, setcc, 0xC0});                // setcc al
+        c.emit({0x0F, 0xB6, 0xC0, 0x50});           // movzx eax, al; push rax
+    };
+
+    for (size_t pc = 0; pc < func.code.size(); ++pc) {
+        offsets[pc] = c.size();
+        const Instr& in = func.code[pc];
+        switch (in.op) {
+        case Op::Const:
+            c.emit({0x68});                         // push imm32
+            c.u32(static_cast<uint32_t>(in.a));
+            break;
+        case Op::Load:
+            c.emit({0xFF, 0xB5});                   // push qword [rbp + disp32]
+            c.u32(localOffset(in.a));
+            break;
+        case Op::Store:
+            c.emit({0x8F, 0x85});                   // pop qword [rbp + disp32]
+            c.u32(localOffset(in.a));
+            break;
+        case Op::Dup:
+            c.emit({0xFF, 0x34, 0x24});             // push qword [rsp]
+            break;
+        case Op::Pop:
+            c.emit({0x48, 0x83, 0xC4, 0x08});       // add rsp, 8
+            break;
+        case Op::Add: binary({0x01, 0xC8}); break;          // add eax, ecx
+        case Op::Sub: binary({0x29, 0xC8}); break;          // sub eax, ecx
+        case Op::Mul: binary({0x0F, 0xAF, 0xC1}); break;    // imul eax, ecx
+        case Op::Div:
+        case Op::Mod:
+            // Деление на ноль и INT_MIN / -1 остаются интерпретатору
+            c.emit({0x59, 0x58, 0x85, 0xC9});       // pop rcx; pop rax; test ecx, ecx
+            c.emit({0x0F, 0x84});                   // jz bail
+            bails.push_back(c.rel32());
+            c.emit({0x83, 0xF9, 0xFF, 0x75, 0x0B}); // cmp ecx, -1; jne +11
+            c.emit({0x3D});                         // cmp eax, INT_MIN
+            c.u32(0x80000000u);
+            c.emit({0x0F, 0x84});                   // je bail
+            bails.push_back(c.rel32());
+            c.emit({0x99, 0xF7, 0xF9});             // cdq; idiv ecx
+            c.emit({0x48, 0x63, static_cast<uint8_t>(in.op == Op::Div ? 0xC0 : 0xC2), 0x50}); // movsxd rax, eax/edx
+            break;
+        case Op::Neg:
+            c.emit({0x58, 0xF7, 0xD8, 0x48, 0x63, 0xC0, 0x50}); // pop rax; neg eax; movsxd; push
+            break;
+        case Op::Not:
+            c.emit({0x58, 0x48, 0x85, 0xC0});       // pop rax; test rax, rax
+            c.emit({0x0F, 0x94, 0xC0, 0x0F, 0xB6, 0xC0, 0x50}); // sete al; movzx eax, al; push rax
+            break;
+        case Op::Lt: compare(0x9C); break;
+        case Op::Le: compare(0x9E); break;
+        case Op::Gt: compare(0x9F); break;
+        case Op::Ge: compare(0x9D); break;
+        case Op::Eq: compare(0x94); break;
+        case Op::Ne: compare(0x95); break;
+        case Op::Jmp:
+            c.emit({0xE9});
+            jumps.emplace_back(c.rel32(), in.a);
+            break;
+        case Op::Jz:
+        case Op::Jnz:
+            c.emit({0x58, 0x48, 0x85, 0xC0});       // pop rax; test rax, rax
+            c.emit({0x0F, static_cast<uint8_t>(in.op == Op::Jz ? 0x84 : 0x85)});
+            jumps.emplace_back(c.rel32(), in.a);
+            break;
+        case Op::Call: {
+            // Аргументы уже на стеке: rdi указывает на последний из них
+            c.emit({0x48, 0x89, 0xE7});             // mov rdi, rsp
+            c.emit({0x48, 0x89, 0xE3});             // mov rbx, rsp
+            c.emit({0x48, 0x83, 0xE4, 0xF0});       // and rsp, -16
+            c.movRax(&compiled.at(func.callees[in.a])->code);
+            c.emit({0xFF, 0x10});                   // call [rax]
+            c.emit({0x48, 0x89, 0xDC});             // mov rsp, rbx
+            if (in.b > 0) {
+                c.emit({0x48, 0x81, 0xC4});         // add rsp, imm32
+                c.u32(8 * in.b);
+            }
+            c.emit({0x50});                         // push rax
+            break;
+        }
+        case Op::Inc:
+            c.emit({0x48, 0x8B, 0x85});             // mov rax, [rbp + disp32]
+            c.u32(localOffset(in.a));
+            c.emit({0x05});                         // add eax, imm32
+            c.u32(static_cast<uint32_t>(in.b));
+            c.emit({0x48, 0x63, 0xC0, 0x48, 0x89, 0x85}); // movsxd rax, eax; mov [rbp + disp32], rax
+            c.u32(localOffset(in.a));
+            break;
+        case Op::CmpJz: {
+            // Переход по обратному условию: jge, jg, jle, jl, jne, je
+            static const uint8_t inverse[] = {0x8D, 0x8F, 0x8E, 0x8C, 0x85, 0x84};
+            if (in.b < static_cast<int>(Op::Lt) || in.b > static_cast<int>(Op::Ne)) {
+                c.emit({0xE9});                     // jmp bail
+                bails.push_back(c.rel32());
+                break;
+            }
+            c.emit({0x59, 0x58, 0x39, 0xC8});       // pop rcx; pop rax; cmp eax, ecx
+            c.emit({0x0F, inverse[in.b - static_cast<int>(Op::Lt)]});
+            jumps.emplace_back(c.rel32(), in.a);
+            break;
+        }
+        case Op::Ret:
+            c.emit({0x58});                         // pop rax
+            c.movRcx(&depth);
+            c.emit({0x48, 0xFF, 0x09});             // dec qword [rcx]
+            c.emit({0x48, 0x8D, 0x65, 0xF8});       // lea rsp, [rbp - 8]
+            c.emit({0x5B, 0x5D, 0xC3});             // pop rbx; pop rbp; ret
+            break;
+        default:
+            // Остальные инструкции отсеивает intOnly; если такая всё же дошла сюда
+            // (например, после перестановки Op), вызов уходит в интерпретатор
+            c.emit({0xE9});                         // jmp bail
+            bails.push_back(c.rel32());
+            break;
+        }
+    }
+    offsets[func.code.size()] = c.size();
+
+    // Обработчик отказа: возврат прямо в переходник с флагом bailed
+    size_t bail = c.size();
+    c.movRax(&savedStack);
+    c.emit({0x48, 0x8B, 0x20});                     // mov rsp, [rax]
+    c.movRax(&bailed);
+    c.emit({0xC6, 0x00, 0x01});                     // mov byte [rax], 1
+    c.emit({0x31, 0xC0});                           // xor eax, eax
+    c.emit({0x41, 0x5C, 0x5B, 0x5D, 0xC3});         // pop r12; pop rbx; pop rbp; ret
+
+    for (auto [at, target] : jumps) c.patch(at, offsets[target]);
+    for (size_t at : bails) c.patch(at, bail);
+    return c.bytes;
+}
+
+bool Jit::compile(FuncDeclNode& func) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (compiled.count(func.name)) return true;
+    if (rejected.count(func.name)) return false;
+    if (!entry) {
+        rejected[func.name] = "JIT is not available on this platform";
+        return false;
+    }
+
+    // Функция компилируется вместе со всеми достижимыми из неё вызовами
+    std::unordered_map<std::string, BytecodeFunction> group;
+    std::vector<std::string> work{func.name};
+    while (!work.empty()) {
+        std::string name = work.back();
+        work.pop_back();
+        if (group.count(name) || compiled.count(name)) continue;
+
+        auto it = functions.find(name);
+        std::string reason;
+        std::optional<BytecodeFunction> bytecode;
+        BytecodeCompiler compiler(functions, constants);
+        if (it == functions.end()) {
+            reason = "calls undefined function " + name;
+        } else if (rejected.count(name)) {
+            reason = "calls " + name + ", which is not compiled";
+        } else if (!(bytecode = compiler.compile(*it->second))) {
+            reason = compiler.getError();
+            rejected[name] = reason;
+        } else if (!(reason = intOnly(*bytecode)).empty()) {
+            rejected[name] = reason;
+        }
+        if (!reason.empty()) {
+            if (name != func.name) reason = "calls " + name + ": " + reason;
+            rejected[func.name] = reason;
+            return false;
+        }
+        optimizeBytecode(*bytecode);
+        for (const auto& callee : bytecode->callees) work.push_back(callee);
+        group[name] = std::move(*bytecode);
+    }
+
+    // Сначала ячейки всех функций группы, потом код: вызовы ссылаются на ячейки
+    for (auto& [name, bytecode] : group) {
+        compiled[name] = std::make_unique<Compiled>();
+        compiled[name]->bytecode = std::move(bytecode);
+    }
+    for (auto& [name, unused] : group) {
+        Compiled& c = *compiled[name];
+        std::vector<uint8_t> code = translate(c.bytecode);
+        c.size = code.size();
+        c.code = install(code);
+    }
+    return true;
+}
+
+bool Jit::isCompiled(const FuncDeclNode& func) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return compiled.count(func.name) != 0;
+}
+
+std::optional<int64_t> Jit::invoke(const FuncDeclNode& func, const std::vector<int64_t>& args) {
+    void* code = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = compiled.find(func.name);
+        if (it != compiled.end()) code = it->second->code;
+    }
+    if (!code) return std::nullopt;
+
+    std::vector<int64_t> reversed(args.rbegin(), args.rend());
+    bailed = 0;
+    depth = 0;
+    int64_t r = entry(code, reversed.data());
+    if (bailed) {
+        bailed = 0;
+        return std::nullopt;
+    }
+    return r;
+}
+
+void Jit::printReport(std::ostream& out) const {
+    std::lock_guard<std::mutex> guard(lock);
+    out << "JIT report:" << std::endl;
+    std::vector<std::string> names;
+    for (auto& [name, c] : compiled) names.push_back(name);
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        const Compiled& c = *compiled.at(name);
+        out << "  " << name << ": " << c.bytecode.code.size() << " instructions, " << c.size
+            << " bytes of machine code" << std::endl;
+    }
+    names.clear();
+    for (auto& [name, reason] : rejected) names.push_back(name);
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        out << "  " << name << ": not compiled, " << rejected.at(name) << std::endl;
+    }
+}
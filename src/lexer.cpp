@@ -1,4 +1,5 @@
 #include "../inc/lexer.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
@@ -102,19 +103,28 @@ const std::unordered_map<std::string, TokenType> Lexer::keywords = {
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
-    while (index < input.size()) {
-        Token token = extract();
-        tokens.push_back(token);
-        if (token.type == TokenType::COMMENT_STR) {
-            tokens.erase(tokens.end()); // Прерываем после END
-        }
-        if (token.type == TokenType::END) {
-            break; // Прерываем после END
+    int line = 1;
+    size_t counted = 0; // переводы строк до этой позиции уже посчитаны
+    try {
+        while (index < input.size()) {
+            while (index < input.size() && std::isspace(input[index])) ++index;
+            line += static_cast<int>(std::count(input.begin() + counted, input.begin() + index, '\n'));
+            counted = index;
+            Token token = extract();
+            token.line = line;
+            if (token.type == TokenType::COMMENT_STR) continue; // комментарии парсеру не нужны
+            tokens.push_back(token);
+            if (token.type == TokenType::END) {
+                break; // Прерываем после END
+            }
         }
+    } catch (const LexerError& e) {
+        errors.push_back(e.what());
     }
     // Гарантируем, что последний токен — END
     if (tokens.empty() || tokens.back().type != TokenType::END) {
         tokens.push_back(Token(TokenType::END, ""));
+        tokens.back().line = line;
     }
     return tokens;
 }
@@ -141,9 +151,8 @@ Token Lexer::extract() {
 
     
 
-    std::cerr << "error: invalid character '" << input[index]<<"' in identifier " << std::endl;
-    exit(1); 
-    // throw std::runtime_error("Unexpected operator: " + op);
+    throw LexerError(std::string("error: invalid character '") + input[index] + "' in identifier ");
+    // throw LexerError("Unexpected operator: " + op);
 }
 
 
@@ -168,7 +177,7 @@ Token Lexer::extract_number() { // для чисел прописано
     }else{
         return {TokenType::FLOAT_LIT, value};
     }
-    throw std::runtime_error("Unexpected digit \n"); // std::cerr << "The unknown type of digit" << std::endl;
+    throw LexerError("Unexpected digit \n"); // std::cerr << "The unknown type of digit" << std::endl;
 }
 
 Token Lexer::extract_identifier() {
@@ -187,7 +196,7 @@ Token Lexer::extract_identifier() {
         return {it->second, name}; // Нашли ключевое слово
     }
     return {TokenType::ID, name};  // Иначе это идентификатор    
-    throw std::runtime_error("Unexpected identifier \n");
+    throw LexerError("Unexpected identifier \n");
 }
 
 
@@ -202,7 +211,6 @@ Token Lexer::extract_operator() {
         index++;
         while(index + i < input.size() && input[index + i] != '"'){
             if(input[index + i] == '\\'){
-                std::cout << "Spotted the amongus: " << input[index + i] << std::endl;
                 
                 if(escape.contains(std::string(1 , input[index + i + 1]))){
                     if(input[index + i + 1] == '0' ){
@@ -214,16 +222,14 @@ Token Lexer::extract_operator() {
                     }
                     input.erase(index+ i, 1);
                 }else{
-                    std::cerr << "error: missing terminating \' character"  << std::endl;
-                    exit(1);
+                    throw LexerError("error: missing terminating \' character");
                 }
             }
             ++i;
         }
 
         if(input.size() == index + i){
-            std::cerr << "error: missing terminating \" character"  << std::endl;
-            exit(1); 
+            throw LexerError("error: missing terminating \" character");
         }else{
             //std::cout << index + i<< std::endl;
             std::string name(input, index, i);
@@ -251,14 +257,11 @@ Token Lexer::extract_operator() {
         //std::cout << input[index + i] << std::endl;
         
         if(input.size() == index + i){
-            std::cerr << "error: missing terminating \' character"  << std::endl;
-            exit(1); 
+            throw LexerError("error: missing terminating \' character");
         }else if(i == 0){
-            std::cerr << "error: empty character constant"  << std::endl;
-            exit(1); 
+            throw LexerError("error: empty character constant");
         }else if( (i > 1 && input[index] != '\\') || (i > 2 && input[index] == '\\')){
-            std::cerr << "warning: character constant too long for its type"  << std::endl;
-            exit(1); 
+            throw LexerError("warning: character constant too long for its type");
         }else if (input[index] == '\\'){
             std::string name(input, index, i);
             index += i +1;
@@ -280,17 +283,16 @@ Token Lexer::extract_operator() {
                 }
                 return {TokenType::CHAR_LIT, name}; // Нашли ключевое слово
             }else{
-                std::cerr << "warning: unknown escape sequence: '"<< name << "'"  << std::endl;
-                exit(1); 
+                throw LexerError("warning: unknown escape sequence: '" + name + "'");
             }
-            throw std::runtime_error("Unexpected operator: " + op);
+            throw LexerError("Unexpected operator: " + op);
         }else{
             std::string name(input, index, i);
             index += i +1;
             //std::cout << name<< std::endl;
             return {TokenType::CHAR_LIT, name};
         }
-        throw std::runtime_error("Unexpected operator: " + op);
+        throw LexerError("Unexpected operator: " + op);
     }
 
     // проверяем, есть ли следующий символ в `operators`
@@ -331,7 +333,7 @@ Token Lexer::extract_operator() {
     
         // Если не нашли закрытие комментария
         if (index + i + 1 == input.size()) {
-            throw std::runtime_error("Ошибка: незавершённый многострочный комментарий");
+            throw LexerError("Ошибка: незавершённый многострочный комментарий");
         }
     
         std::string comment = input.substr(index, i);
@@ -341,7 +343,7 @@ Token Lexer::extract_operator() {
     }
     
     if (op == "*/") {
-        throw std::runtime_error("Ошибка: неожиданное закрытие комментария '*/'");
+        throw LexerError("Ошибка: неожиданное закрытие комментария '*/'");
     }
     
 
@@ -350,7 +352,7 @@ Token Lexer::extract_operator() {
         return {it->second, op};
     }
     
-    throw std::runtime_error("Unexpected operator: " + op);
+    throw LexerError("Unexpected operator: " + op);
 }
 
 /// для операторов лексер доибть 
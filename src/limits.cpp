@@ -0,0 +1,21 @@
+#include "../inc/limits.hpp"
+
+const char* limitName(Limit limit) {
+    switch (limit) {
+    case Limit::Steps: return "steps";
+    case Limit::Time: return "time";
+    case Limit::Depth: return "depth";
+    case Limit::Memory: return "memory";
+    case Limit::Output: return "output";
+    }
+    return "?";
+}
+
+void MemoryMeter::allocate(size_t bytes) {
+    if (limit && bytes > limit - used) {
+        throw LimitError(Limit::Memory, "Memory limit of " + std::to_string(limit) + " bytes exceeded (" +
+                                            std::to_string(used) + " in use, " + std::to_string(bytes) + " requested)");
+    }
+    used += bytes;
+    if (used > peak) peak = used;
+}
@@ -0,0 +1,629 @@
+#include "../inc/loop_opt.hpp"
+#include "../inc/ast_clone.hpp"
+#include "../inc/ast_utils.hpp"
+#include "../inc/simd.hpp"
+#include <algorithm>
+
+namespace {
+
+// Границы, в которых арифметика над счётчиком заведомо не переполняет int
+constexpr long long kIntLimit = 2147483647LL;
+
+bool fitsInt(long long value) {
+    return value >= -kIntLimit - 1 && value <= kIntLimit;
+}
+
+std::string flipComparison(const std::string& op) {
+    if (op == "<") return ">";
+    if (op == ">") return "<";
+    if (op == "<=") return ">=";
+    if (op == ">=") return "<=";
+    return op;
+}
+
+std::optional<long long> computeTripCount(long long start, long long step, const std::string& op, long long bound) {
+    if (step > 0 && op == "<") return start >= bound ? 0 : (bound - start + step - 1) / step;
+    if (step > 0 && op == "<=") return start > bound ? 0 : (bound - start) / step + 1;
+    if (step < 0 && op == ">") return start <= bound ? 0 : (start - bound - step - 1) / -step;
+    if (step < 0 && op == ">=") return start < bound ? 0 : (start - bound) / -step + 1;
+    if (op == "!=") {
+        long long distance = bound - start;
+        if (distance % step == 0 && distance / step >= 0) return distance / step;
+    }
+    return std::nullopt;
+}
+
+bool containsContinue(ASTNode& body) {
+    if (dynamic_cast<ContinueStmtNode*>(&body)) return true;
+    if (dynamic_cast<WhileLoopNode*>(&body) || dynamic_cast<DoWhileLoopNode*>(&body) ||
+        dynamic_cast<ForLoopNode*>(&body)) {
+        return false;
+    }
+    bool found = false;
+    forEachSlot(body, [&](std::unique_ptr<ASTNode>& child) {
+        if (!found) found = containsContinue(*child);
+    });
+    return found;
+}
+
+// Значения, которые выражение принимает, пока счётчик пробегает [lo, hi]
+struct Range {
+    long long lo;
+    long long hi;
+};
+
+std::optional<Range> valueRange(ASTNode& expr, const std::string& counter, Range counterRange) {
+    if (auto v = intLiteralValue(&expr)) return Range{*v, *v};
+    if (auto group = dynamic_cast<GroupExprNode*>(&expr)) return valueRange(*group->expression, counter, counterRange);
+    if (auto id = dynamic_cast<IdentifierExprNode*>(&expr)) {
+        if (id->name == counter && isBuiltin(id->resolved_type, "int")) return counterRange;
+        return std::nullopt;
+    }
+    auto bin = dynamic_cast<BinaryExprNode*>(&expr);
+    if (!bin || !isBuiltin(bin->resolved_type, "int")) return std::nullopt;
+    auto l = valueRange(*bin->left, counter, counterRange);
+    auto r = valueRange(*bin->right, counter, counterRange);
+    if (!l || !r) return std::nullopt;
+    Range result;
+    if (bin->op == "+") {
+        result = {l->lo + r->lo, l->hi + r->hi};
+    } else if (bin->op == "-") {
+        result = {l->lo - r->hi, l->hi - r->lo};
+    } else if (bin->op == "*") {
+        long long a = l->lo * r->lo, b = l->lo * r->hi, c = l->hi * r->lo, d = l->hi * r->hi;
+        result = {std::min({a, b, c, d}), std::max({a, b, c, d})};
+    } else {
+        return std::nullopt;
+    }
+    // Переполнение int меняет значение по модулю: такой диапазон ничего не доказывает
+    if (!fitsInt(result.lo) || !fitsInt(result.hi)) return std::nullopt;
+    return result;
+}
+
+std::unique_ptr<BlockStatementNode> asBlock(std::unique_ptr<ASTNode> stmt) {
+    if (dynamic_cast<BlockStatementNode*>(stmt.get())) {
+        return std::unique_ptr<BlockStatementNode>(static_cast<BlockStatementNode*>(stmt.release()));
+    }
+    std::vector<std::unique_ptr<ASTNode>> stmts;
+    stmts.push_back(std::move(stmt));
+    return std::make_unique<BlockStatementNode>(std::move(stmts));
+}
+
+} // namespace
+
+void LoopOptimizer::optimize(ASTNode& root) {
+    forEachSlot(root, [&](std::unique_ptr<ASTNode>& child) { optimizeSlot(child); });
+}
+
+void LoopOptimizer::optimizeSlot(std::unique_ptr<ASTNode>& slot) {
+    if (!slot) return;
+    ASTNode& node = *slot;
+
+    if (auto func = dynamic_cast<FuncDeclNode*>(&node)) {
+        currentFunction = func->name;
+        optimizeSlot(func->body);
+        return;
+    }
+
+    std::string kind;
+    if (dynamic_cast<ForLoopNode*>(&node)) kind = "for";
+    else if (dynamic_cast<WhileLoopNode*>(&node)) kind = "while";
+    else if (dynamic_cast<DoWhileLoopNode*>(&node)) kind = "do-while";
+
+    if (!kind.empty()) {
+        // Сначала внутренние циклы: их вынесенные инварианты станут кандидатами для внешнего
+        size_t index = reports.size();
+        reports.push_back({currentFunction, kind, depth + 1});
+        ++depth;
+        forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { optimizeSlot(child); });
+        --depth;
+        optimizeLoop(slot, reports[index]);
+        return;
+    }
+
+    if (dynamic_cast<StmtNode*>(&node) || dynamic_cast<DeclNode*>(&node)) {
+        forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { optimizeSlot(child); });
+    }
+}
+
+void LoopOptimizer::optimizeLoop(std::unique_ptr<ASTNode>& slot, LoopReport& report) {
+    std::unordered_set<std::string> variant;
+    collectAssigned(*slot, variant);
+
+    std::vector<std::unique_ptr<ASTNode>> prelude;
+    std::unordered_map<std::string, std::string> hoisted;
+
+    if (auto loop = dynamic_cast<ForLoopNode*>(slot.get())) {
+        auto iv = findInductionVar(*loop);
+        size_t bodySize = countNodes(*loop->body);
+        bool exits = hasLoopExit(*loop->body);
+
+        if (iv) {
+            report.induction = iv->name + (iv->start ? " = " + std::to_string(*iv->start) : "") +
+                               " step " + std::to_string(iv->step);
+            report.trip_count = iv->trip_count;
+            // До раскрутки: копии тела унаследуют снятые проверки
+            eliminateBoundsChecks(*loop, *iv, report);
+        }
+
+        if (iv && iv->start && iv->trip_count && !exits &&
+            *iv->trip_count <= kFullUnrollMaxTrips && bodySize * *iv->trip_count <= kFullUnrollMaxNodes) {
+            slot = unrollFully(*loop, *iv);
+            report.applied.push_back("unrolled fully (" + std::to_string(*iv->trip_count) + " copies)");
+            return;
+        }
+
+        hoistInvariants(loop->condition, variant, prelude, hoisted, report);
+        hoistInvariants(loop->body, variant, prelude, hoisted, report);
+        if (iv) strengthReduce(*loop, *iv, variant, prelude, report);
+
+        if (iv && !exits && vectorize(*loop, *iv, variant, report)) {
+            // Векторный цикл не раскручивается: ядро само обрабатывает хвост
+        } else if (iv && iv->start && iv->trip_count && !exits &&
+            *iv->trip_count >= 2 * kPartialUnrollFactor && countNodes(*loop->body) <= kPartialUnrollMaxBody) {
+            report.applied.push_back("unrolled by " + std::to_string(kPartialUnrollFactor) + " (remainder " +
+                                     std::to_string(*iv->trip_count % kPartialUnrollFactor) + ")");
+            slot = unrollPartially(std::move(slot), *iv);
+        }
+    } else if (auto loop = dynamic_cast<WhileLoopNode*>(slot.get())) {
+        if (auto iv = findTrailingIncrement(*loop->body, *loop->condition)) {
+            report.induction = iv->name + " step " + std::to_string(iv->step);
+        }
+        hoistInvariants(loop->condition, variant, prelude, hoisted, report);
+        hoistInvariants(loop->body, variant, prelude, hoisted, report);
+    } else if (auto loop = dynamic_cast<DoWhileLoopNode*>(slot.get())) {
+        if (auto iv = findTrailingIncrement(*loop->body, *loop->condition)) {
+            report.induction = iv->name + " step " + std::to_string(iv->step);
+        }
+        hoistInvariants(loop->body, variant, prelude, hoisted, report);
+        hoistInvariants(loop->condition, variant, prelude, hoisted, report);
+    }
+
+    if (!prelude.empty()) {
+        prelude.push_back(std::move(slot));
+        slot = std::make_unique<BlockStatementNode>(std::move(prelude));
+    }
+}
+
+// i++, ++i, i--, --i, i += c, i -= c, i = i + c, i = i - c
+std::optional<std::pair<std::string, long long>> LoopOptimizer::matchStep(ASTNode& expr) {
+    auto unit = [](const std::string& op) { return op == "++" ? 1LL : -1LL; };
+    if (auto post = dynamic_cast<PostfixExprNode*>(&expr)) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(post->expr.get())) return std::make_pair(id->name, unit(post->op));
+    }
+    if (auto un = dynamic_cast<UnaryExprNode*>(&expr)) {
+        if (un->op != "++" && un->op != "--") return std::nullopt;
+        if (auto id = dynamic_cast<IdentifierExprNode*>(un->operand.get())) return std::make_pair(id->name, unit(un->op));
+    }
+    if (auto assign = dynamic_cast<AssignmentExprNode*>(&expr)) {
+        auto id = dynamic_cast<IdentifierExprNode*>(assign->left.get());
+        if (!id) return std::nullopt;
+        if (assign->op == "+=" || assign->op == "-=") {
+            auto value = intLiteralValue(assign->right.get());
+            if (value && *value != 0) return std::make_pair(id->name, assign->op == "+=" ? *value : -*value);
+        }
+        if (assign->op == "=") {
+            auto bin = dynamic_cast<BinaryExprNode*>(assign->right.get());
+            if (!bin || (bin->op != "+" && bin->op != "-")) return std::nullopt;
+            auto lhs = dynamic_cast<IdentifierExprNode*>(bin->left.get());
+            auto value = intLiteralValue(bin->right.get());
+            if (lhs && lhs->name == id->name && value && *value != 0) {
+                return std::make_pair(id->name, bin->op == "+" ? *value : -*value);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<LoopOptimizer::InductionVar> LoopOptimizer::findInductionVar(ForLoopNode& loop) {
+    if (!loop.increment || !loop.condition) return std::nullopt;
+    auto step = matchStep(*loop.increment);
+    if (!step) return std::nullopt;
+
+    InductionVar iv;
+    iv.name = step->first;
+    iv.step = step->second;
+
+    // Тело и условие не должны менять счётчик
+    std::unordered_set<std::string> assigned;
+    collectAssigned(*loop.body, assigned);
+    collectAssigned(*loop.condition, assigned);
+    if (assigned.count(iv.name)) return std::nullopt;
+
+    auto cmp = dynamic_cast<BinaryExprNode*>(loop.condition.get());
+    if (!cmp) return std::nullopt;
+    std::string op = cmp->op;
+    ASTNode* boundExpr = nullptr;
+    IdentifierExprNode* counter = nullptr;
+    if (auto id = dynamic_cast<IdentifierExprNode*>(cmp->left.get()); id && id->name == iv.name) {
+        counter = id;
+        boundExpr = cmp->right.get();
+    } else if (auto id = dynamic_cast<IdentifierExprNode*>(cmp->right.get()); id && id->name == iv.name) {
+        counter = id;
+        boundExpr = cmp->left.get();
+        op = flipComparison(op);
+    }
+    if (!counter || !isBuiltin(counter->resolved_type, "int")) return std::nullopt;
+    if (op != "<" && op != "<=" && op != ">" && op != ">=" && op != "!=") return std::nullopt;
+    iv.counter = counter;
+    iv.bound = boundExpr;
+    iv.op = op;
+
+    if (auto decl = dynamic_cast<VarDeclNode*>(loop.init.get())) {
+        if (decl->declarators.size() == 1 && decl->declarators[0]->declarator->name == iv.name) {
+            iv.declaredInInit = true;
+            iv.startExpr = &decl->declarators[0]->initializer;
+        }
+    } else if (auto assign = dynamic_cast<AssignmentExprNode*>(loop.init.get())) {
+        auto id = dynamic_cast<IdentifierExprNode*>(assign->left.get());
+        if (assign->op == "=" && id && id->name == iv.name) iv.startExpr = &assign->right;
+    }
+    if (iv.startExpr && *iv.startExpr) iv.start = intLiteralValue(iv.startExpr->get());
+
+    auto bound = intLiteralValue(boundExpr);
+    if (iv.start && bound && fitsInt(*iv.start) && fitsInt(*bound)) {
+        iv.trip_count = computeTripCount(*iv.start, iv.step, op, *bound);
+        if (iv.trip_count && !fitsInt(*iv.start + *iv.trip_count * iv.step)) iv.trip_count.reset();
+    }
+    return iv;
+}
+
+// Для while/do-while: счётчик, который меняется только последним оператором тела
+std::optional<LoopOptimizer::InductionVar> LoopOptimizer::findTrailingIncrement(ASTNode& body, ASTNode& condition) {
+    auto block = dynamic_cast<BlockStatementNode*>(&body);
+    if (!block || block->statements.empty()) return std::nullopt;
+    auto step = matchStep(*block->statements.back());
+    if (!step) return std::nullopt;
+
+    std::unordered_set<std::string> assigned;
+    collectAssigned(condition, assigned);
+    for (size_t i = 0; i + 1 < block->statements.size(); ++i) {
+        collectAssigned(*block->statements[i], assigned);
+    }
+    if (assigned.count(step->first)) return std::nullopt;
+
+    bool compared = false;
+    walk(condition, [&](ASTNode& n) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(&n); id && id->name == step->first) compared = true;
+    });
+    if (!compared) return std::nullopt;
+
+    InductionVar iv;
+    iv.name = step->first;
+    iv.step = step->second;
+    return iv;
+}
+
+bool LoopOptimizer::isHoistable(ASTNode& expr, const std::unordered_set<std::string>& variant) {
+    auto exprNode = dynamic_cast<ExprNode*>(&expr);
+    if (!exprNode) return false;
+    auto type = std::dynamic_pointer_cast<BuiltinType>(exprNode->resolved_type);
+    if (!type || type->name == "string" || type->name == "void") return false;
+
+    // Переменные и литералы выносить незачем
+    if (auto group = dynamic_cast<GroupExprNode*>(&expr)) return isHoistable(*group->expression, variant);
+    if (auto un = dynamic_cast<UnaryExprNode*>(&expr); un && un->op != "-" && un->op != "!") return false;
+    if (!dynamic_cast<BinaryExprNode*>(&expr) && !dynamic_cast<MemberAccessExprNode*>(&expr) &&
+        !dynamic_cast<UnaryExprNode*>(&expr) && !dynamic_cast<CastExprNode*>(&expr) &&
+        !dynamic_cast<TernaryExprNode*>(&expr)) {
+        return false;
+    }
+    if (!isPure(expr)) return false;
+
+    bool ok = true;
+    walk(expr, [&](ASTNode& n) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(&n)) {
+            if (variant.count(id->name)) ok = false;
+        } else if (dynamic_cast<ScopedIdentifierExprNode*>(&n) || dynamic_cast<SubscriptExprNode*>(&n) ||
+                   dynamic_cast<InitListNode*>(&n) || dynamic_cast<SizeofExprNode*>(&n)) {
+            // Индексация может выйти за границы — её нельзя исполнять раньше времени
+            ok = false;
+        } else if (auto bin = dynamic_cast<BinaryExprNode*>(&n)) {
+            // Целое деление исполняется и тогда, когда тело цикла не исполнится ни разу:
+            // выносится только деление на константу, которое не может завершиться ошибкой
+            auto type = std::dynamic_pointer_cast<BuiltinType>(bin->resolved_type);
+            bool integral = type && type->name != "float" && type->name != "double";
+            if ((bin->op == "/" || bin->op == "%") && integral) {
+                auto divisor = constantIntValue(bin->right.get());
+                if (!divisor || *divisor == 0 || (*divisor == -1 && !type->is_unsigned)) ok = false;
+            }
+        }
+    });
+    return ok;
+}
+
+void LoopOptimizer::hoistInvariants(std::unique_ptr<ASTNode>& slot, const std::unordered_set<std::string>& variant,
+                                    std::vector<std::unique_ptr<ASTNode>>& prelude,
+                                    std::unordered_map<std::string, std::string>& hoisted, LoopReport& report) {
+    if (!slot) return;
+    if (isHoistable(*slot, variant)) {
+        auto type = static_cast<ExprNode*>(slot.get())->resolved_type;
+        std::string key = exprToString(*slot);
+        auto it = hoisted.find(key);
+        if (it == hoisted.end()) {
+            std::string temp = newTemp("licm");
+            report.applied.push_back("hoisted invariant " + key + " into " + temp);
+            it = hoisted.emplace(key, temp).first;
+            prelude.push_back(makeVarDecl(temp, type, std::move(slot)));
+        }
+        slot = makeIdentifier(it->second, type);
+        return;
+    }
+    forEachSlot(*slot, [&](std::unique_ptr<ASTNode>& child) {
+        hoistInvariants(child, variant, prelude, hoisted, report);
+    });
+}
+
+// Внутри тела счётчик пробегает [start, start + (trips - 1) * step] и не меняется;
+// индекс, который при этом остаётся в длине массива, не нужно проверять
+void LoopOptimizer::eliminateBoundsChecks(ForLoopNode& loop, const InductionVar& iv, LoopReport& report) {
+    if (!iv.start || !iv.trip_count || *iv.trip_count == 0) return;
+    long long last = *iv.start + (*iv.trip_count - 1) * iv.step;
+    Range counter{std::min(*iv.start, last), std::max(*iv.start, last)};
+
+    std::unordered_set<std::string> removed;
+    walk(*loop.body, [&](ASTNode& n) {
+        auto sub = dynamic_cast<SubscriptExprNode*>(&n);
+        if (!sub || !sub->checked) return;
+        auto array = std::dynamic_pointer_cast<ArrayType>(static_cast<ExprNode*>(sub->array.get())->resolved_type);
+        if (!array || !array->length) return;
+        auto range = valueRange(*sub->index, iv.name, counter);
+        if (!range || range->lo < 0 || range->hi >= static_cast<long long>(array->length)) return;
+        sub->checked = false;
+        std::string key = exprToString(*sub);
+        if (removed.insert(key).second) report.applied.push_back("removed bounds check of " + key);
+    });
+}
+
+// Тело из одного присваивания a[i] = x op y (или a[i] op= y) либо s = s + x op y
+// (или s += x op y), где x и y — элементы массивов с индексом i или инварианты.
+// Все массивы читаются и пишутся по одному индексу, поэтому итерации независимы.
+// Суммы — только над целыми: вещественное сложение в другом порядке округляется иначе
+bool LoopOptimizer::vectorize(ForLoopNode& loop, const InductionVar& iv,
+                              const std::unordered_set<std::string>& variant, LoopReport& report) {
+    if (iv.step != 1 || (iv.op != "<" && iv.op != "<=") || !iv.counter || !isPure(*iv.bound)) return false;
+    bool invariantBound = true;
+    walk(*iv.bound, [&](ASTNode& n) {
+        if (auto id = dynamic_cast<IdentifierExprNode*>(&n); id && variant.count(id->name)) invariantBound = false;
+        if (dynamic_cast<SubscriptExprNode*>(&n) || dynamic_cast<ScopedIdentifierExprNode*>(&n)) invariantBound = false;
+    });
+    if (!invariantBound) return false;
+
+    ASTNode* stmt = loop.body.get();
+    if (auto block = dynamic_cast<BlockStatementNode*>(stmt)) {
+        if (block->statements.size() != 1) return false;
+        stmt = block->statements[0].get();
+    }
+    auto assign = dynamic_cast<AssignmentExprNode*>(stmt);
+    auto type = assign ? std::dynamic_pointer_cast<BuiltinType>(assign->resolved_type) : nullptr;
+    if (!type) return false;
+
+    auto plan = std::make_shared<VectorLoop>();
+    plan->kind = kindOf(type->name, type->is_unsigned);
+    plan->counter = iv.counter;
+    plan->bound = iv.bound;
+    plan->inclusive = iv.op == "<=";
+    if (!vectorKind(plan->kind)) return false;
+    bool integral = plan->kind == Value::Kind::Int || plan->kind == Value::Kind::Long;
+
+    auto strip = [](ASTNode* n) {
+        while (auto group = dynamic_cast<GroupExprNode*>(n)) n = group->expression.get();
+        return n;
+    };
+    // a[i] -> a
+    auto element = [&](ASTNode* n) -> ASTNode* {
+        auto sub = dynamic_cast<SubscriptExprNode*>(strip(n));
+        if (!sub) return nullptr;
+        auto index = dynamic_cast<IdentifierExprNode*>(strip(sub->index.get()));
+        auto array = dynamic_cast<IdentifierExprNode*>(sub->array.get());
+        if (!index || index->name != iv.name || !array) return nullptr;
+        auto arrayType = std::dynamic_pointer_cast<ArrayType>(array->resolved_type);
+        auto elementType = arrayType ? std::dynamic_pointer_cast<BuiltinType>(arrayType->element) : nullptr;
+        if (!elementType || kindOf(elementType->name, elementType->is_unsigned) != plan->kind) return nullptr;
+        return array;
+    };
+    auto operand = [&](ASTNode* n, ASTNode*& node, bool& array) {
+        n = strip(n);
+        if (auto a = element(n)) {
+            node = a;
+            array = true;
+            return true;
+        }
+        auto id = dynamic_cast<IdentifierExprNode*>(n);
+        auto scalar = std::dynamic_pointer_cast<BuiltinType>(static_cast<ExprNode*>(n)->resolved_type);
+        bool invariant = dynamic_cast<LiteralExprNode*>(n) || (id && !variant.count(id->name));
+        if (!invariant || !scalar || kindOf(scalar->name, scalar->is_unsigned) != plan->kind) return false;
+        node = n;
+        array = false;
+        return true;
+    };
+    auto opOf = [&](const std::string& op) -> std::optional<VectorOp> {
+        if (op == "+") return VectorOp::Add;
+        if (op == "-") return VectorOp::Sub;
+        if (op == "*") return VectorOp::Mul;
+        if (op == "/" && !integral) return VectorOp::Div;
+        return std::nullopt;
+    };
+    // x op y или x
+    auto term = [&](ASTNode* n) {
+        n = strip(n);
+        if (auto bin = dynamic_cast<BinaryExprNode*>(n)) {
+            auto op = opOf(bin->op);
+            if (!op) return false;
+            plan->op = *op;
+            return operand(bin->left.get(), plan->x, plan->xArray) && operand(bin->right.get(), plan->y, plan->yArray);
+        }
+        plan->op = VectorOp::Copy;
+        return operand(n, plan->x, plan->xArray);
+    };
+
+    bool matched = false;
+    if (auto target = element(assign->left.get())) {
+        plan->shape = VectorLoop::Shape::Map;
+        plan->target = target;
+        if (assign->op == "=") {
+            matched = term(assign->right.get());
+        } else if (auto op = opOf(assign->op.substr(0, assign->op.size() - 1))) {
+            plan->op = *op;
+            plan->x = target;
+            plan->xArray = true;
+            matched = operand(assign->right.get(), plan->y, plan->yArray);
+        }
+    } else if (auto sum = dynamic_cast<IdentifierExprNode*>(assign->left.get()); sum && integral) {
+        plan->shape = VectorLoop::Shape::Sum;
+        plan->target = sum;
+        ASTNode* added = nullptr;
+        if (assign->op == "+=") {
+            added = assign->right.get();
+        } else if (auto bin = dynamic_cast<BinaryExprNode*>(strip(assign->right.get())); bin && assign->op == "=" && bin->op == "+") {
+            auto isSum = [&](ASTNode* n) {
+                auto id = dynamic_cast<IdentifierExprNode*>(strip(n));
+                return id && id->name == sum->name;
+            };
+            if (isSum(bin->left.get())) added = bin->right.get();
+            else if (isSum(bin->right.get())) added = bin->left.get();
+        }
+        matched = added && term(added) && (plan->xArray || plan->yArray);
+    }
+    if (!matched) return false;
+
+    loop.vector = plan;
+    report.applied.push_back("vectorized " + exprToString(*stmt) + " (" + type->toString() + ", " + vectorIsa() + ")");
+    return true;
+}
+
+// i * c внутри тела заменяется на отдельную переменную, которая растёт на c * step за итерацию
+void LoopOptimizer::strengthReduce(ForLoopNode& loop, const InductionVar& iv,
+                                   const std::unordered_set<std::string>& variant,
+                                   std::vector<std::unique_ptr<ASTNode>>& prelude, LoopReport& report) {
+    if (containsContinue(*loop.body)) return;
+
+    ASTNode* startExpr = nullptr;
+    if (!iv.start) {
+        auto id = iv.startExpr ? dynamic_cast<IdentifierExprNode*>(iv.startExpr->get()) : nullptr;
+        if (!id || variant.count(id->name) || !isBuiltin(id->resolved_type, "int")) return;
+        startExpr = id;
+    }
+
+    std::vector<std::pair<long long, std::string>> reduced;
+    std::function<void(std::unique_ptr<ASTNode>&)> visit = [&](std::unique_ptr<ASTNode>& slot) {
+        if (auto bin = dynamic_cast<BinaryExprNode*>(slot.get()); bin && bin->op == "*") {
+            auto matchCounter = [&](ASTNode* node) {
+                auto id = dynamic_cast<IdentifierExprNode*>(node);
+                return id && id->name == iv.name && isBuiltin(id->resolved_type, "int");
+            };
+            std::optional<long long> factor;
+            if (matchCounter(bin->left.get())) factor = intLiteralValue(bin->right.get());
+            else if (matchCounter(bin->right.get())) factor = intLiteralValue(bin->left.get());
+            if (factor && *factor != 0 && *factor != 1 && fitsInt(*factor * iv.step)) {
+                std::string temp;
+                for (auto& [c, name] : reduced) {
+                    if (c == *factor) temp = name;
+                }
+                if (temp.empty()) {
+                    temp = newTemp("sr");
+                    reduced.emplace_back(*factor, temp);
+                    report.applied.push_back("strength-reduced " + exprToString(*slot) + " into " + temp);
+                }
+                slot = makeIdentifier(temp, bin->resolved_type);
+                return;
+            }
+        }
+        forEachSlot(*slot, visit);
+    };
+    visit(loop.body);
+    if (reduced.empty()) return;
+
+    auto body = asBlock(std::move(loop.body));
+    auto intType = std::make_shared<BuiltinType>("int");
+    for (auto& [factor, temp] : reduced) {
+        std::unique_ptr<ASTNode> init;
+        if (iv.start) {
+            init = makeIntLiteral(*iv.start * factor);
+        } else {
+            AstCloner cloner;
+            auto product = std::make_unique<BinaryExprNode>("*", cloner.clone(*startExpr), makeIntLiteral(factor));
+            product->resolved_type = intType;
+            init = std::move(product);
+        }
+        prelude.push_back(makeVarDecl(temp, intType, std::move(init)));
+
+        auto update = std::make_unique<AssignmentExprNode>(makeIdentifier(temp, intType),
+                                                           makeIntLiteral(factor * iv.step), "+=");
+        update->resolved_type = intType;
+        body->statements.push_back(std::move(update));
+    }
+    loop.body = std::move(body);
+}
+
+// Цикл с известным числом итераций превращается в последовательность копий тела,
+// в каждой из которых счётчик заменён константой
+std::unique_ptr<ASTNode> LoopOptimizer::unrollFully(ForLoopNode& loop, const InductionVar& iv) {
+    AstCloner cloner;
+    std::vector<std::unique_ptr<ASTNode>> stmts;
+    long long value = *iv.start;
+    for (long long k = 0; k < *iv.trip_count; ++k) {
+        auto copy = cloner.clone(*loop.body);
+        auto constant = makeIntLiteral(value);
+        substituteIdentifier(copy, iv.name, *constant);
+        stmts.push_back(std::move(copy));
+        value += iv.step;
+    }
+    if (!iv.declaredInInit) {
+        // Счётчик объявлен снаружи: после цикла он должен иметь конечное значение
+        auto intType = std::make_shared<BuiltinType>("int");
+        auto assign = std::make_unique<AssignmentExprNode>(makeIdentifier(iv.name, intType), makeIntLiteral(value), "=");
+        assign->resolved_type = intType;
+        stmts.push_back(std::move(assign));
+    }
+    return std::make_unique<BlockStatementNode>(std::move(stmts));
+}
+
+// { init; for (; i != end; ) { body; inc; body; inc; ... } body; inc; ... }
+std::unique_ptr<ASTNode> LoopOptimizer::unrollPartially(std::unique_ptr<ASTNode> node, const InductionVar& iv) {
+    auto& loop = static_cast<ForLoopNode&>(*node);
+    AstCloner cloner;
+    long long trips = *iv.trip_count;
+    long long mainEnd = *iv.start + (trips / kPartialUnrollFactor) * kPartialUnrollFactor * iv.step;
+
+    std::vector<std::unique_ptr<ASTNode>> stmts;
+    if (loop.init) stmts.push_back(std::move(loop.init));
+
+    std::vector<std::unique_ptr<ASTNode>> mainBody;
+    for (long long k = 0; k < kPartialUnrollFactor; ++k) {
+        mainBody.push_back(cloner.clone(*loop.body));
+        mainBody.push_back(cloner.clone(*loop.increment));
+    }
+    auto intType = std::make_shared<BuiltinType>("int");
+    auto cond = std::make_unique<BinaryExprNode>("!=", makeIdentifier(iv.name, intType), makeIntLiteral(mainEnd));
+    cond->resolved_type = intType;
+    stmts.push_back(std::make_unique<ForLoopNode>(nullptr, std::move(cond), nullptr,
+                                                  std::make_unique<BlockStatementNode>(std::move(mainBody))));
+
+    for (long long k = 0; k < trips % kPartialUnrollFactor; ++k) {
+        stmts.push_back(cloner.clone(*loop.body));
+        stmts.push_back(cloner.clone(*loop.increment));
+    }
+    return std::make_unique<BlockStatementNode>(std::move(stmts));
+}
+
+std::string LoopOptimizer::newTemp(const std::string& prefix) {
+    return "__" + prefix + std::to_string(tempCounter++);
+}
+
+void LoopOptimizer::printReport(std::ostream& out) const {
+    out << "Loop optimizer report:" << std::endl;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const auto& r = reports[i];
+        out << "  loop " << i + 1 << " in " << r.function << ": " << r.kind << ", depth " << r.depth;
+        if (!r.induction.empty()) out << ", iv " << r.induction;
+        if (r.trip_count) out << ", trip count " << *r.trip_count;
+        out << std::endl;
+        if (r.applied.empty()) {
+            out << "    no transformations" << std::endl;
+        }
+        for (const auto& a : r.applied) {
+            out << "    " << a << std::endl;
+        }
+    }
+}
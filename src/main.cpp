@@ -1,40 +1,314 @@
 #include "reader.hpp"
-#include "lexer.hpp"
-#include "parser.hpp"
+#include "compilation.hpp"
 #include "../inc/printer.hpp"
-#include "sema.hpp"
+#include "options.hpp"
+#include "interpreter.hpp"
+#include "jit.hpp"
+#include "tiering.hpp"
+#include "c_emit.hpp"
+#include "constant_pool.hpp"
+#include "image.hpp"
+#include "cache.hpp"
+#include "batch.hpp"
+#include "server.hpp"
+#include "profiler.hpp"
+#include "counters.hpp"
+#include "time_report.hpp"
+#include "trace.hpp"
+#include "ast_utils.hpp"
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <unistd.h>
 
+// Исполнение проверенной программы; bytecode — готовый байт-код функций из образа
+static int execute(TranslationUnitNode& unit, const Options& opts,
+                   std::vector<std::unique_ptr<BytecodeFunction>> bytecode, TimeReport* report) {
+    OutputBuffer out(STDOUT_FILENO, opts.line_buffered);
+    InputBuffer in(STDIN_FILENO);
+    Interpreter interpreter(unit, out, in);
+    Jit jit(unit);
+    std::unique_ptr<TierManager> tiers;
+    bool profiling = !opts.profile.empty();
+    bool counting = opts.counters || !opts.annotate.empty();
+    if (opts.tier) {
+        TierOptions tierOptions{opts.tier_calls, opts.tier_loops, opts.tier_log};
+        // Таймер профиля считает процессорное время всего процесса: компиляция
+        // идёт в потоке исполнения и достаётся месту, где её запросили
+        tierOptions.background = !profiling;
+        // Машинный код не считает шаги, глубину вызовов и исполненные узлы
+        bool native = opts.jit && !opts.limits.needsInterpreter() && !profiling && !counting;
+        tiers = std::make_unique<TierManager>(unit, native ? &jit : nullptr, tierOptions);
+        tiers->preload(std::move(bytecode));
+        interpreter.setTiers(tiers.get(), opts.jit_verify);
+    }
+    interpreter.setLimits(opts.limits);
+    std::unique_ptr<Profiler> profiler;
+    if (profiling) {
+        bool steps = opts.profile == "steps";
+        int64_t period = opts.profile_period > 0 ? opts.profile_period : steps ? 10000 : 1000;
+        profiler = std::make_unique<Profiler>(steps ? Profiler::Mode::Steps : Profiler::Mode::Timer, period);
+        interpreter.setProfiler(profiler.get());
+    }
+    std::unique_ptr<ExecutionCounters> counters;
+    if (counting) {
+        counters = std::make_unique<ExecutionCounters>();
+        interpreter.setCounters(counters.get());
+    }
+    int code = 0;
+    bool failed = false;
+    try {
+        TimeReport::Phase phase(report, "execute");
+        if (profiler) profiler->start();
+        code = interpreter.run();
+        if (profiler) profiler->stop();
+        out.flush();
+    } catch (const RuntimeError& e) {
+        if (profiler) profiler->stop();
+        out.flush();
+        std::cerr << e.what() << std::endl;
+        code = 1;
+        failed = true;
+    }
+    out.flush();
+    if (profiler) {
+        profiler->printFlat(std::cerr);
+        if (!opts.profile_out.empty()) {
+            std::ofstream folded(opts.profile_out);
+            profiler->printFolded(folded);
+            if (!folded) std::cerr << "Не удалось записать " << opts.profile_out << std::endl;
+        }
+    }
+    if (counters && opts.counters) counters->print(unit, std::cerr);
+    if (counters && !opts.annotate.empty()) {
+        // Образ не хранит исходный текст
+        if (isImageFile(opts.input)) {
+            std::cerr << "--annotate требует исходный файл, а не образ" << std::endl;
+        } else {
+            std::ofstream annotated(opts.annotate);
+            counters->annotate(unit, readfile(opts.input), opts.input, annotated);
+            if (!annotated) std::cerr << "Не удалось записать " << opts.annotate << std::endl;
+        }
+    }
+    if (out.isTruncated() && !failed) {
+        std::cerr << "Runtime Error: Output limit of " << opts.limits.output << " bytes exceeded" << std::endl;
+        code = 1;
+    }
+    if (tiers && opts.tier_log) tiers->printReport(std::cerr);
+    if (opts.jit_verify) {
+        jit.printReport(std::cerr);
+        std::cerr << "JIT verify: " << interpreter.getVerifiedCalls() << " calls compared, "
+                  << interpreter.getMismatches() << " mismatches" << std::endl;
+    }
+    return code;
+}
 
-int main(int argc, char* argv[]) {
+// Один файл: печать токенов и дерева или бэкенды
+static int runFile(const Options& opts, TimeReport* report) {
+    // Образ уже проверен и оптимизирован: лексер, парсер и анализ не нужны
+    if (isImageFile(opts.input)) {
+        ProgramImage image;
+        try {
+            TimeReport::Phase phase(report, "load");
+            image = loadImage(opts.input);
+        } catch (const ImageError& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return execute(*image.program, opts, std::move(image.bytecode), report);
+    }
 
-    std::string buff = readfile(argc , argv);
-    Lexer lexer(buff);
-    std::vector<Token> tmp = lexer.tokenize();
-    
+    std::string buff;
+    {
+        TimeReport::Phase phase(report, "read");
+        Trace::Span span("io", "read", opts.input);
+        buff = readfile(opts.input);
+    }
+    bool backend = opts.run || !opts.emit_c.empty() || !opts.native.empty() || !opts.emit_image.empty();
+
+    // Кэш нужен только для исполнения: остальные режимы печатают промежуточные результаты
+    std::unique_ptr<CompileCache> cache;
+    std::string cacheKey;
+    if (opts.run && opts.cache && opts.emit_c.empty() && opts.native.empty() && opts.emit_image.empty()) {
+        std::string dir = opts.cache_dir.empty() ? CompileCache::defaultDir() : opts.cache_dir;
+        cache = std::make_unique<CompileCache>(dir, static_cast<uint64_t>(opts.cache_size) << 20);
+        std::optional<ProgramImage> image;
+        {
+            TimeReport::Phase phase(report, "cache");
+            cacheKey = CompileCache::key(buff, opts.optimize);
+            image = cache->load(cacheKey);
+        }
+        if (image) {
+            if (report) report->count("cached", 1);
+            std::cerr << image->notes;
+            return execute(*image->program, opts, std::move(image->bytecode), report);
+        }
+    }
 
+    Compilation compilation(buff);
+    auto failed = [&] {
+        for (const auto& error : compilation.getErrors()) std::cerr << error << std::endl;
+        return 1;
+    };
+    // Счётчики нужны и тогда, когда этап нашёл ошибки
+    auto counted = [&](bool ok) {
+        if (!report) return ok;
+        const auto& c = compilation.getCounters();
+        report->count("bytes", c.bytes);
+        report->count("tokens", c.tokens);
+        if (c.scopes || c.symbols || c.functions) {
+            report->count("scopes", c.scopes);
+            report->count("symbols", c.symbols);
+            report->count("functions", c.functions);
+            report->count("types", c.types);
+        }
+        return ok;
+    };
+    bool lexed;
+    {
+        TimeReport::Phase phase(report, "lex");
+        lexed = compilation.lex();
+    }
+    if (!counted(lexed)) return failed();
+    const std::vector<Token>& tmp = compilation.getTokens();
 
     int i = 0;
-    std::cout << "Lexer work:"<<std::endl;
-    while(i < tmp.size()){
-        
-        std::cout <<tmp.at(i).toString()<< std::endl;
-        i++;
-        
+    if (!backend) {
+        TimeReport::Phase phase(report, "print");
+        Trace::Span span("io", "print tokens");
+        std::cout << "Lexer work:"<<std::endl;
+        while(i < tmp.size()){
+            
+            std::cout <<tmp.at(i).toString()<< std::endl;
+            i++;
+            
+        }
     }
     
-    Parser parser(tmp); // Создаём объект парсера с токенами
-    auto ast = parser.parse(); // Вызываем метод parse для получения AST
-    
-    SemanticAnalyzer sem;
-    sem.analyze(*dynamic_cast<ASTNode*>(ast.get()));
+    bool parsed, analyzed = false;
+    {
+        TimeReport::Phase phase(report, "parse");
+        parsed = compilation.parse();
+    }
+    if (parsed) {
+        TimeReport::Phase phase(report, "sema");
+        analyzed = compilation.analyze();
+    }
+    if (!counted(parsed && analyzed)) return failed();
+    auto ast = compilation.takeProgram();
+    if (report) {
+        size_t nodes = 0;
+        walk(*ast, [&](ASTNode&) { ++nodes; });
+        report->count("nodes", nodes);
+    }
+
+    // При исполнении отчёты идут в stderr, чтобы не смешиваться с выводом программы;
+    // при записи в кэш они сохраняются вместе с программой
+    std::ostringstream notes;
+    std::ostream& notesOut = cache ? notes : backend ? std::cerr : std::cout;
+    auto& unit = *dynamic_cast<TranslationUnitNode*>(ast.get());
+    {
+        TimeReport::Phase phase(report, "optimize");
+        prepareProgram(unit, opts.optimize, opts.optimize ? &notesOut : nullptr);
+    }
+    if (cache) {
+        std::cerr << notes.str();
+        TimeReport::Phase phase(report, "cache-store");
+        cache->store(cacheKey, unit, notes.str());
+    }
+
+    if (!opts.emit_c.empty() || !opts.native.empty()) {
+        TimeReport::Phase phase(report, "emit");
+        Trace::Span span("emit", opts.native.empty() ? "emit C" : "native");
+        std::string source;
+        try {
+            CEmitVisitor emitter;
+            source = emitter.emit(*dynamic_cast<TranslationUnitNode*>(ast.get()));
+        } catch (const CEmitError& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        if (!opts.emit_c.empty()) {
+            std::ofstream file(opts.emit_c);
+            file << source;
+            if (!file) {
+                std::cerr << "Не удалось записать " << opts.emit_c << std::endl;
+                return 1;
+            }
+        }
+        std::string error;
+        if (!opts.native.empty() && !compileNative(source, opts.native, error)) {
+            std::cerr << "C Backend Error: " << error << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!opts.emit_image.empty()) {
+        TimeReport::Phase phase(report, "emit");
+        Trace::Span span("emit", "image");
+        try {
+            writeImage(unit, opts.emit_image);
+        } catch (const ImageError& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (opts.run) return execute(unit, opts, {}, report);
     // SemanticAnalyzer semantic;
     
     // semantic.analyze(*dynamic_cast<TranslationUnitNode*>(ast.get()));
     
     
+    TimeReport::Phase phase(report, "print");
+    Trace::Span span("io", "print tree");
     PrintVisitor smth;  // visitor дописать
     smth.print(*ast);
 
     return 0;
 }
 
+// Режим запуска по параметрам
+static int dispatch(const Options& opts) {
+    if (!opts.serve.empty()) return serve(opts.serve, static_cast<unsigned>(opts.jobs), opts.quantum, opts.limits);
+    if (!opts.connect.empty()) return runClient(opts.connect, opts.input, opts.optimize, opts.limits);
+
+    if (opts.batch) {
+        std::vector<std::string> files = opts.inputs;
+        if (!opts.files_from.empty() && !readFileList(opts.files_from, files)) {
+            std::cerr << "Не удалось прочитать список " << opts.files_from << std::endl;
+            return 1;
+        }
+        return runBatch(files, static_cast<unsigned>(opts.jobs), std::cout);
+    }
+
+    if (opts.time_report.empty()) return runFile(opts, nullptr);
+    TimeReport report(opts.input);
+    int code = runFile(opts, &report);
+    std::cout.flush();
+    if (opts.time_report == "json") report.printJson(std::cerr);
+    else report.print(std::cerr);
+    return code;
+}
+
+int main(int argc, char* argv[]) {
+
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        return 1;
+    }
+
+    if (opts.trace.empty()) return dispatch(opts);
+    Trace::start(opts.trace, opts.trace_calls);
+    int code = dispatch(opts);
+    std::cout.flush();
+    if (!Trace::finish()) {
+        std::cerr << "Не удалось записать " << opts.trace << std::endl;
+        if (code == 0) code = 1;
+    }
+    return code;
+}
+
@@ -0,0 +1,159 @@
+#include "../inc/options.hpp"
+#include <charconv>
+#include <iostream>
+
+namespace {
+
+// Значение параметра вида --name=N
+template <typename T>
+bool parseNumber(const std::string& arg, const std::string& prefix, T& value) {
+    if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+    const char* begin = arg.data() + prefix.size();
+    const char* end = arg.data() + arg.size();
+    auto [ptr, ec] = std::from_chars(begin, end, value);
+    return ec == std::errc() && ptr == end && begin != end && value > 0;
+}
+
+} // namespace
+
+bool parseOptions(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-O") {
+            opts.optimize = true;
+        } else if (arg == "--run") {
+            opts.run = true;
+        } else if (arg == "--jit") {
+            opts.run = opts.jit = true;
+        } else if (arg == "--jit-verify") {
+            opts.run = opts.jit = opts.jit_verify = true;
+        } else if (arg.starts_with("--jit-threshold=") || arg.starts_with("--tier-calls=")) {
+            if (!parseNumber(arg, arg.substr(0, arg.find('=') + 1), opts.tier_calls)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--tier-loops=")) {
+            if (!parseNumber(arg, "--tier-loops=", opts.tier_loops)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg == "--tier-log") {
+            opts.tier_log = true;
+        } else if (arg == "--line-buffered") {
+            opts.line_buffered = true;
+        } else if (arg == "--no-tier") {
+            opts.tier = false;
+        } else if (arg.starts_with("--emit-c=")) {
+            opts.emit_c = arg.substr(9);
+        } else if (arg.starts_with("--native=")) {
+            opts.native = arg.substr(9);
+        } else if (arg.starts_with("--emit-image=")) {
+            opts.emit_image = arg.substr(13);
+        } else if (arg == "--no-cache") {
+            opts.cache = false;
+        } else if (arg.starts_with("--cache-dir=")) {
+            opts.cache_dir = arg.substr(12);
+        } else if (arg.starts_with("--cache-size=")) {
+            if (!parseNumber(arg, "--cache-size=", opts.cache_size)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg == "--batch") {
+            opts.batch = true;
+        } else if (arg.starts_with("--files-from=")) {
+            opts.batch = true;
+            opts.files_from = arg.substr(13);
+        } else if (arg.starts_with("--jobs=")) {
+            if (!parseNumber(arg, "--jobs=", opts.jobs)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--serve=")) {
+            opts.serve = arg.substr(8);
+        } else if (arg.starts_with("--quantum=")) {
+            if (!parseNumber(arg, "--quantum=", opts.quantum) || opts.quantum <= 0) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--max-steps=")) {
+            if (!parseNumber(arg, "--max-steps=", opts.limits.steps)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--max-time=")) {
+            if (!parseNumber(arg, "--max-time=", opts.limits.seconds)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--max-depth=")) {
+            if (!parseNumber(arg, "--max-depth=", opts.limits.callDepth)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--max-memory=")) {
+            if (!parseNumber(arg, "--max-memory=", opts.limits.memory)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--max-output=")) {
+            if (!parseNumber(arg, "--max-output=", opts.limits.output)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--trace=")) {
+            opts.trace = arg.substr(8);
+        } else if (arg.starts_with("--trace-calls=")) {
+            if (!parseNumber(arg, "--trace-calls=", opts.trace_calls)) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg == "--profile" || arg == "--profile=time") {
+            opts.profile = "time";
+        } else if (arg == "--profile=steps") {
+            opts.profile = "steps";
+        } else if (arg.starts_with("--profile-period=")) {
+            if (!parseNumber(arg, "--profile-period=", opts.profile_period) || opts.profile_period <= 0) {
+                std::cerr << "Некорректное значение: " << arg << std::endl;
+                return false;
+            }
+        } else if (arg.starts_with("--profile-out=")) {
+            opts.profile_out = arg.substr(14);
+        } else if (arg == "--counters") {
+            opts.counters = true;
+        } else if (arg.starts_with("--annotate=")) {
+            opts.annotate = arg.substr(11);
+        } else if (arg == "--time-report" || arg == "--time-report=text") {
+            opts.time_report = "text";
+        } else if (arg == "--time-report=json") {
+            opts.time_report = "json";
+        } else if (arg.starts_with("--connect=")) {
+            opts.connect = arg.substr(10);
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Неизвестный параметр: " << arg << std::endl;
+            return false;
+        } else {
+            if (opts.input.empty()) opts.input = arg;
+            opts.inputs.push_back(arg);
+        }
+    }
+    if (!opts.profile_out.empty() && opts.profile.empty()) opts.profile = "time";
+    // Строки считает только исполнитель по дереву
+    if (!opts.annotate.empty()) opts.tier = false;
+    if (opts.input.empty() && opts.files_from.empty() && opts.serve.empty()) {
+        std::cerr << "Использование: " << argv[0]
+                  << " [-O] [--run] [--jit] [--jit-verify] [--no-tier] [--tier-calls=N]"
+                  << " [--tier-loops=N] [--tier-log] [--line-buffered]"
+                  << " [--emit-c=FILE] [--native=FILE]"
+                  << " [--emit-image=FILE] [--no-cache] [--cache-dir=DIR] [--cache-size=MB]"
+                  << " [--max-steps=N] [--max-time=SEC] [--max-depth=N] [--max-memory=BYTES] [--max-output=BYTES]"
+                  << " [--time-report[=json]] [--trace=FILE] [--trace-calls=N]"
+                  << " [--profile[=time|steps]] [--profile-period=N] [--profile-out=FILE]"
+                  << " [--counters] [--annotate=FILE]"
+                  << " <имя_файла или образ .ibc>" << std::endl;
+        std::cerr << "       " << argv[0] << " --batch [--files-from=FILE] [--jobs=N] [--trace=FILE] <файлы...>" << std::endl;
+        std::cerr << "       " << argv[0] << " --serve=SOCKET [--jobs=N] [--quantum=N] [--max-...]" << std::endl;
+        std::cerr << "       " << argv[0] << " --connect=SOCKET [-O] [--max-...] <имя_файла>" << std::endl;
+        return false;
+    }
+    return true;
+}
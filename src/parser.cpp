@@ -4,11 +4,9 @@
 #include <memory>
 #include <unordered_set>
 
-std::unordered_set<std::string> knownTypes = {
-    "int", "double", "char", "void", "bool", "short", "long", "float"
-};
-
-Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
+Parser::Parser(const std::vector<Token>& tokens)
+    : tokens(tokens),
+      knownTypes{"int", "double", "char", "void", "bool", "short", "long", "float"} {}
 
 std::unique_ptr<ASTNode> Parser::parse() {
     return parseTranslationUnit();
@@ -212,6 +210,7 @@ std::unique_ptr<ASTNode> Parser::parsePostfix() {
     auto expr = parsePrimary();  // Сначала разбираем основной элемент (литералы, идентификаторы, скобки)
     while (true) {
         if (match(TokenType::LBRACE)) {       // Вызов функции
+            int line = prev().line;
             std::vector<std::unique_ptr<ASTNode>> args;
             if (!check(TokenType::RBRACE)) {
                 do {
@@ -220,6 +219,7 @@ std::unique_ptr<ASTNode> Parser::parsePostfix() {
             }
             expect(TokenType::RBRACE, "Expected ')' after function arguments.");
             expr = std::make_unique<CallExprNode>(std::move(expr), std::move(args));  // Создаем узел для вызова функции
+            expr->line = line;
         } else if (match(TokenType::LSQUAREBRACE)) { // Индексация массива
             if (check(TokenType::RSQUAREBRACE)) {
                 reportError("Expected expression inside '[]'");
@@ -316,13 +316,16 @@ std::unique_ptr<DeclaratorNode> Parser::parseDeclarator() {
     expect(TokenType::ID, "Expected identifier");
     std::string name = prev().value;
     std::unique_ptr<ASTNode> arraySize = nullptr;
-    if (match(TokenType::LSQUAREBRACE)) {
+    bool isArray = match(TokenType::LSQUAREBRACE);
+    if (isArray) {
         if (!check(TokenType::RSQUAREBRACE)) {
             arraySize = parseExpression();
         }
         expect(TokenType::RSQUAREBRACE, "Expected ']'");
     }
-    return std::make_unique<DeclaratorNode>(name, std::move(arraySize));
+    auto declarator = std::make_unique<DeclaratorNode>(name, std::move(arraySize));
+    declarator->is_array = isArray;
+    return declarator;
 }
 
 std::unique_ptr<FuncDeclNode> Parser::parseFuncDeclaration() {
@@ -336,6 +339,7 @@ std::unique_ptr<FuncDeclNode> Parser::parseFuncDeclaration() {
     }
     expect(TokenType::ID, "Expected function name");  // 2. Идентификатор функции
     std::string funcName = prev().value;// 3. Открывающая скобка (
+    int line = prev().line;
     expect(TokenType::LBRACE, "Expected '(' after function name");// 4. Параметры
     std::vector<std::unique_ptr<ParamDeclNode>> parameters;
     if (!check(TokenType::RBRACE)) {
@@ -359,7 +363,9 @@ std::unique_ptr<FuncDeclNode> Parser::parseFuncDeclaration() {
         reportError("Expected ';' or function body after declaration");
         synchronize();
     }
-    return std::make_unique<FuncDeclNode>(std::move(returnType), funcName, std::move(parameters), std::move(body));
+    auto func = std::make_unique<FuncDeclNode>(std::move(returnType), funcName, std::move(parameters), std::move(body));
+    func->line = line;
+    return func;
 }
 
 
@@ -404,6 +410,13 @@ std::unique_ptr<ASTNode> Parser::parseBlockStatement() {
 
 
 std::unique_ptr<ASTNode> Parser::parseStatement() {
+    int line = peek().line;
+    auto stmt = parseStatementBody();
+    if (stmt) stmt->line = line;
+    return stmt;
+}
+
+std::unique_ptr<ASTNode> Parser::parseStatementBody() {
     if (check(TokenType::LFIGUREBRACE)) {
         return parseBlockStatement();
     }
@@ -502,7 +515,6 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
         expect(TokenType::LBRACE, "Expected '(' after 'for'");
 
         std::unique_ptr<ASTNode> init = nullptr;
-        std::cout << "Now in For loop parse: "<< peek().value << std::endl;
         if (!check(TokenType::SEMICOLON)) {
             if (isType()) {
                 init = parseVarDeclaration(); // обрабатываем int x = 0
@@ -628,7 +640,7 @@ void Parser::expect(TokenType type, const std::string& error_msg) {
 }
 
 void Parser::reportError(const std::string& message) {
-    std::cerr << "[Parser Error] " << message << " at token '" << peek().value << "'\n";
+    errors.push_back("[Parser Error] " + message + " at token '" + peek().value + "'");
     hadError = true;
     synchronize();
 }
@@ -4,17 +4,17 @@
 void PrintVisitor::print(ASTNode& node) {
     indent_level = 0;
     node.accept(*this);
-    std::cout << std::endl;
+    out << std::endl;
 }
 
 void PrintVisitor::indent() const {
     for (int i = 0; i < indent_level; ++i) {
-        std::cout << "  ";
+        out << "  ";
     }
 }
 
 void PrintVisitor::visit(TranslationUnitNode& node) {
-    indent(); std::cout << "TranslationUnitNode\n";
+    indent(); out << "TranslationUnitNode\n";
     ++indent_level;
     for (auto& decl : node.declarations) {
         decl->accept(*this);
@@ -24,28 +24,28 @@ void PrintVisitor::visit(TranslationUnitNode& node) {
 
 void PrintVisitor::visit(TypeNode& node) {
     indent(); 
-    std::cout << "TypeNode: " << node.type_name;
-    if (node.is_const) std::cout << " [const]";
-    if (node.is_unsigned) std::cout << " [unsigned]";
-    std::cout << "\n";
+    out << "TypeNode: " << node.type_name;
+    if (node.is_const) out << " [const]";
+    if (node.is_unsigned) out << " [unsigned]";
+    out << "\n";
 }
 
 void PrintVisitor::visit(DeclaratorNode& node) {
-    indent(); std::cout << "DeclaratorNode: " << node.name;
+    indent(); out << "DeclaratorNode: " << node.name;
     if (node.array_size) {
-        std::cout << " [";
+        out << " [";
         node.array_size->accept(*this);
-        std::cout << "]";
+        out << "]";
     }
-    std::cout << "\n";
+    out << "\n";
 }
 
 void PrintVisitor::visit(InitDeclaratorNode& node) {
-    indent(); std::cout << "InitDeclaratorNode\n";
+    indent(); out << "InitDeclaratorNode\n";
     ++indent_level;
     node.declarator->accept(*this);
     if (node.initializer) {
-        indent(); std::cout << "Initializer:\n";
+        indent(); out << "Initializer:\n";
         ++indent_level;
         node.initializer->accept(*this);
         --indent_level;
@@ -54,7 +54,7 @@ void PrintVisitor::visit(InitDeclaratorNode& node) {
 }
 
 void PrintVisitor::visit(VarDeclNode& node) {
-    indent(); std::cout << "VarDeclNode" << (node.is_const ? " (const)" : "") << "\n";
+    indent(); out << "VarDeclNode" << (node.is_const ? " (const)" : "") << "\n";
     ++indent_level;
     node.type->accept(*this);
     for (auto& decl : node.declarators) {
@@ -64,7 +64,7 @@ void PrintVisitor::visit(VarDeclNode& node) {
 }
 
 void PrintVisitor::visit(ParamDeclNode& node) {
-    indent(); std::cout << "ParamDeclNode" << (node.is_const ? " (const)" : "") << "\n";
+    indent(); out << "ParamDeclNode" << (node.is_const ? " (const)" : "") << "\n";
     ++indent_level;
     node.type->accept(*this);
     node.declarator->accept(*this);
@@ -72,14 +72,14 @@ void PrintVisitor::visit(ParamDeclNode& node) {
 }
 
 void PrintVisitor::visit(FuncDeclNode& node) {
-    indent(); std::cout << "FuncDeclNode: " << node.name << (node.is_const ? " (const)" : "") << "\n";
+    indent(); out << "FuncDeclNode: " << node.name << (node.is_const ? " (const)" : "") << "\n";
     ++indent_level;
-    indent(); std::cout << "Return type:\n";
+    indent(); out << "Return type:\n";
     ++indent_level;
     node.return_type->accept(*this);
     --indent_level;
 
-    indent(); std::cout << "Parameters:\n";
+    indent(); out << "Parameters:\n";
     ++indent_level;
     for (auto& param : node.params) {
         param->accept(*this);
@@ -87,7 +87,7 @@ void PrintVisitor::visit(FuncDeclNode& node) {
     --indent_level;
 
     if (node.body) {
-        indent(); std::cout << "Body:\n";
+        indent(); out << "Body:\n";
         ++indent_level;
         node.body->accept(*this);
         --indent_level;
@@ -96,7 +96,7 @@ void PrintVisitor::visit(FuncDeclNode& node) {
 }
 
 void PrintVisitor::visit(StructDeclNode& node) {
-    indent(); std::cout << "StructDeclNode: " << node.name << "\n";
+    indent(); out << "StructDeclNode: " << node.name << "\n";
     ++indent_level;
     for (auto& member : node.members) {
         member->accept(*this);
@@ -105,7 +105,7 @@ void PrintVisitor::visit(StructDeclNode& node) {
 }
 
 void PrintVisitor::visit(BlockStatementNode& node) {
-    indent(); std::cout << "BlockStatementNode\n";
+    indent(); out << "BlockStatementNode\n";
     ++indent_level;
     for (auto& stmt : node.statements) {
         stmt->accept(*this);
@@ -114,20 +114,20 @@ void PrintVisitor::visit(BlockStatementNode& node) {
 }
 
 void PrintVisitor::visit(IfStatementNode& node) {
-    indent(); std::cout << "IfStatementNode\n";
+    indent(); out << "IfStatementNode\n";
     ++indent_level;
-    indent(); std::cout << "Condition:\n";
+    indent(); out << "Condition:\n";
     ++indent_level;
     node.condition->accept(*this);
     --indent_level;
 
-    indent(); std::cout << "Then:\n";
+    indent(); out << "Then:\n";
     ++indent_level;
     node.then_branch->accept(*this);
     --indent_level;
 
     if (node.else_branch) {
-        indent(); std::cout << "Else:\n";
+        indent(); out << "Else:\n";
         ++indent_level;
         node.else_branch->accept(*this);
         --indent_level;
@@ -136,14 +136,14 @@ void PrintVisitor::visit(IfStatementNode& node) {
 }
 
 void PrintVisitor::visit(WhileLoopNode& node) {
-    indent(); std::cout << "WhileLoopNode\n";
+    indent(); out << "WhileLoopNode\n";
     ++indent_level;
-    indent(); std::cout << "Condition:\n";
+    indent(); out << "Condition:\n";
     ++indent_level;
     node.condition->accept(*this);
     --indent_level;
 
-    indent(); std::cout << "Body:\n";
+    indent(); out << "Body:\n";
     ++indent_level;
     node.body->accept(*this);
     --indent_level;
@@ -151,13 +151,13 @@ void PrintVisitor::visit(WhileLoopNode& node) {
 }
 
 void PrintVisitor::visit(DoWhileLoopNode& node) {
-    indent(); std::cout << "DoWhileLoopNode\n";
+    indent(); out << "DoWhileLoopNode\n";
     ++indent_level;
-    indent(); std::cout << "Body:\n";
+    indent(); out << "Body:\n";
     ++indent_level;
     node.body->accept(*this);
     --indent_level;
-    indent(); std::cout << "Condition:\n";
+    indent(); out << "Condition:\n";
     ++indent_level;
     node.condition->accept(*this);
     --indent_level;
@@ -165,27 +165,27 @@ void PrintVisitor::visit(DoWhileLoopNode& node) {
 }
 
 void PrintVisitor::visit(ForLoopNode& node) {
-    indent(); std::cout << "ForLoopNode\n";
+    indent(); out << "ForLoopNode\n";
     ++indent_level;
     if (node.init) {
-        indent(); std::cout << "Init:\n";
+        indent(); out << "Init:\n";
         ++indent_level;
         node.init->accept(*this);
         --indent_level;
     }
     if (node.condition) {
-        indent(); std::cout << "Condition:\n";
+        indent(); out << "Condition:\n";
         ++indent_level;
         node.condition->accept(*this);
         --indent_level;
     }
     if (node.increment) {
-        indent(); std::cout << "Increment:\n";
+        indent(); out << "Increment:\n";
         ++indent_level;
         node.increment->accept(*this);
         --indent_level;
     }
-    indent(); std::cout << "Body:\n";
+    indent(); out << "Body:\n";
     ++indent_level;
     node.body->accept(*this);
     --indent_level;
@@ -193,7 +193,7 @@ void PrintVisitor::visit(ForLoopNode& node) {
 }
 
 void PrintVisitor::visit(ReturnStatementNode& node) {
-    indent(); std::cout << "ReturnStatementNode\n";
+    indent(); out << "ReturnStatementNode\n";
     if (node.expression) {
         ++indent_level;
         node.expression->accept(*this);
@@ -203,7 +203,7 @@ void PrintVisitor::visit(ReturnStatementNode& node) {
 
 
 void PrintVisitor::visit(BinaryExprNode& node) {
-    indent(); std::cout << "BinaryExprNode: " << node.op << "\n";
+    indent(); out << "BinaryExprNode: " << node.op << "\n";
     ++indent_level;
     node.left->accept(*this);
     node.right->accept(*this);
@@ -211,23 +211,23 @@ void PrintVisitor::visit(BinaryExprNode& node) {
 }
 
 void PrintVisitor::visit(MemberAccessExprNode& node) {
-    indent(); std::cout << "MemberAccessExprNode: " << node.op << "\n";
+    indent(); out << "MemberAccessExprNode: " << node.op << "\n";
     ++indent_level;
     node.object ->accept(*this);
-    indent();std::cout << "Member: " << node.member << "\n";
+    indent();out << "Member: " << node.member << "\n";
     --indent_level;
 }
 
 
 void PrintVisitor::visit(UnaryExprNode& node) {
-    indent(); std::cout << "UnaryExprNode: " << node.op << "\n";
+    indent(); out << "UnaryExprNode: " << node.op << "\n";
     ++indent_level;
     node.operand->accept(*this);
     --indent_level;
 }
 
 void PrintVisitor::visit(TernaryExprNode& node) {
-    indent(); std::cout << "TernaryExprNode\n";
+    indent(); out << "TernaryExprNode\n";
     ++indent_level;
     node.condition->accept(*this);
     node.then_expr->accept(*this);
@@ -236,7 +236,7 @@ void PrintVisitor::visit(TernaryExprNode& node) {
 }
 
 // void PrintVisitor::visit(CastExprNode& node) {
-//     indent(); std::cout << "CastExprNode\n";
+//     indent(); out << "CastExprNode\n";
 //     ++indent_level;
 //     node.type->accept(*this);
 //     node.expression->accept(*this);
@@ -244,7 +244,7 @@ void PrintVisitor::visit(TernaryExprNode& node) {
 // }
 
 void PrintVisitor::visit(SubscriptExprNode& node) {
-    indent(); std::cout << "SubscriptExprNode\n";
+    indent(); out << "SubscriptExprNode\n";
     ++indent_level;
     node.array->accept(*this);
     node.index->accept(*this);
@@ -252,10 +252,10 @@ void PrintVisitor::visit(SubscriptExprNode& node) {
 }
 
 void PrintVisitor::visit(CallExprNode& node) {
-    indent(); std::cout << "CallExprNode\n";
+    indent(); out << "CallExprNode\n";
     ++indent_level;
     node.callee->accept(*this);
-    indent(); std::cout << "Arguments:\n";
+    indent(); out << "Arguments:\n";
     ++indent_level;
     for (auto& arg : node.arguments) {
         arg->accept(*this);
@@ -266,31 +266,31 @@ void PrintVisitor::visit(CallExprNode& node) {
 
 
 void PrintVisitor::visit(LiteralExprNode& node) {
-    indent(); std::cout << "LiteralExprNode: " << node.value << "\n";
+    indent(); out << "LiteralExprNode: " << node.value << "\n";
 }
 
 void PrintVisitor::visit(IdentifierExprNode& node) {
-    indent(); std::cout << "IdentifierExprNode: " << node.name << "\n";
+    indent(); out << "IdentifierExprNode: " << node.name << "\n";
 }
 
 void PrintVisitor::visit(GroupExprNode& node) {
-    indent(); std::cout << "GroupExprNode\n";
+    indent(); out << "GroupExprNode\n";
     ++indent_level;
     node.expression->accept(*this);
     --indent_level;
 }
 
 void PrintVisitor::visit(PostfixExprNode& node){
-    indent(); std::cout << "PostfixExprNode: " << node.op << "\n";
+    indent(); out << "PostfixExprNode: " << node.op << "\n";
     ++indent_level;
     node.expr->accept(*this);
     --indent_level;
 }
 
 void PrintVisitor::visit(InitListNode& node) {
-    indent(); std::cout << "InitListNode\n";
+    indent(); out << "InitListNode\n";
     ++indent_level;
-    indent(); std::cout << "Elements:\n";
+    indent(); out << "Elements:\n";
     ++indent_level;
     for (auto& element : node.elements) {
         element->accept(*this);
@@ -301,18 +301,18 @@ void PrintVisitor::visit(InitListNode& node) {
 
 void PrintVisitor::visit(BreakStmtNode& node) {
     indent();
-    std::cout << "BreakStmtNode\n";
+    out << "BreakStmtNode\n";
 }
 
 void PrintVisitor::visit(ContinueStmtNode& node) {
     indent();
-    std::cout << "ContinueStmtNode\n";
+    out << "ContinueStmtNode\n";
 }
 
 void PrintVisitor::visit(SizeofExprNode& node) {
-    indent(); std::cout << "SizeofExprNode\n";
+    indent(); out << "SizeofExprNode\n";
     ++indent_level;
-    indent(); std::cout << (node.isType ? "Type:\n" : "Expression:\n");
+    indent(); out << (node.isType ? "Type:\n" : "Expression:\n");
     ++indent_level;
     node.operand->accept(*this);
     --indent_level;
@@ -320,22 +320,22 @@ void PrintVisitor::visit(SizeofExprNode& node) {
 }
 
 void PrintVisitor::visit(StaticAssertNode& node) {
-    indent(); std::cout << "StaticAssertNode\n";
+    indent(); out << "StaticAssertNode\n";
     ++indent_level;
-    indent(); std::cout << "Condition:\n";
+    indent(); out << "Condition:\n";
     ++indent_level;
     node.condition->accept(*this);
     --indent_level;
     if (!node.message.empty()) {
-        indent(); std::cout << "Message: " << node.message << "\n";
+        indent(); out << "Message: " << node.message << "\n";
     }
     --indent_level;
 }
 
 void PrintVisitor::visit(ExitExprNode& node) {
-    indent(); std::cout << "ExitExprNode: "  << "\n";
+    indent(); out << "ExitExprNode: "  << "\n";
     ++indent_level;
-    indent(); std::cout << "Arguments:\n";
+    indent(); out << "Arguments:\n";
     ++indent_level;
     for (const auto& arg : node.arguments) {
         arg->accept(*this);
@@ -345,9 +345,9 @@ void PrintVisitor::visit(ExitExprNode& node) {
 }
 
 void PrintVisitor::visit(AssertExprNode& node) {
-    indent(); std::cout << "AssertExprNode: "  << "\n";
+    indent(); out << "AssertExprNode: "  << "\n";
     ++indent_level;
-    indent(); std::cout << "Arguments:\n";
+    indent(); out << "Arguments:\n";
     ++indent_level;
     for (const auto& arg : node.arguments) {
         arg->accept(*this);
@@ -357,9 +357,9 @@ void PrintVisitor::visit(AssertExprNode& node) {
 }
 
 void PrintVisitor::visit(ReadStmtNode& node) {
-    indent(); std::cout << "ReadStmtNode\n";
+    indent(); out << "ReadStmtNode\n";
     ++indent_level;
-    indent(); std::cout << "Argument:\n";
+    indent(); out << "Argument:\n";
     ++indent_level;
     node.argument->accept(*this);
     --indent_level;
@@ -367,9 +367,9 @@ void PrintVisitor::visit(ReadStmtNode& node) {
 }
 
 void PrintVisitor::visit(PrintStmtNode& node) {
-    indent(); std::cout << "PrintStmtNode\n";
+    indent(); out << "PrintStmtNode\n";
     ++indent_level;
-    indent(); std::cout << "Argument:\n";
+    indent(); out << "Argument:\n";
     ++indent_level;
     node.argument->accept(*this);
     --indent_level;
@@ -377,13 +377,13 @@ void PrintVisitor::visit(PrintStmtNode& node) {
 }
 
 void PrintVisitor::visit(AssignmentExprNode& node) {
-    indent(); std::cout << "AssignmentExprNode: " << node.op << "\n";
+    indent(); out << "AssignmentExprNode: " << node.op << "\n";
     ++indent_level;
-    indent(); std::cout << "Left:\n";
+    indent(); out << "Left:\n";
     ++indent_level;
     node.left->accept(*this);
     --indent_level;
-    indent(); std::cout << "Right:\n";
+    indent(); out << "Right:\n";
     ++indent_level;
     node.right->accept(*this);
     --indent_level;
@@ -391,13 +391,13 @@ void PrintVisitor::visit(AssignmentExprNode& node) {
 }
 
 void PrintVisitor::visit(CastExprNode& node) {
-    indent(); std::cout << "CastExprNode\n";
+    indent(); out << "CastExprNode\n";
     ++indent_level;
-    indent(); std::cout << "Type:\n";
+    indent(); out << "Type:\n";
     ++indent_level;
     node.type->accept(*this);
     --indent_level;
-    indent(); std::cout << "Expression:\n";
+    indent(); out << "Expression:\n";
     ++indent_level;
     node.expression->accept(*this);
     --indent_level;
@@ -406,10 +406,10 @@ void PrintVisitor::visit(CastExprNode& node) {
 
 void PrintVisitor::visit(NamespaceDeclNode& node) {
     indent();
-    std::cout << "NamespaceDeclNode: " << node.name << "\n";
+    out << "NamespaceDeclNode: " << node.name << "\n";
     ++indent_level;
     indent();
-    std::cout << "Declarations:\n";
+    out << "Declarations:\n";
     ++indent_level;
     for (auto& decl : node.declarations) {
         decl->accept(*this);
@@ -420,12 +420,12 @@ void PrintVisitor::visit(NamespaceDeclNode& node) {
 
 void PrintVisitor::visit(ScopedIdentifierExprNode& node) {
     indent();
-    std::cout << "ScopedIdentifierExprNode: ";
+    out << "ScopedIdentifierExprNode: ";
     for (size_t i = 0; i < node.path.size(); ++i) {
-        std::cout << node.path[i];
+        out << node.path[i];
         if (i < node.path.size() - 1) {
-            std::cout << "::";
+            out << "::";
         }
     }
-    std::cout << "\n";
+    out << "\n";
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "../inc/profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <set>
+#include <sys/time.h>
+
+namespace {
+
+// Сигналы таймера с прошлой выборки; обработчику доступны только атомарные без блокировок
+std::atomic<uint32_t> ticks{0};
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+struct sigaction previous;
+
+void onTick(int) {
+    ticks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void setTimer(int64_t micros) {
+    itimerval timer{};
+    timer.it_interval.tv_sec = micros / 1000000;
+    timer.it_interval.tv_usec = micros % 1000000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+// Имя функции кадра: код цикла для замены на стеке называется "f:loop"
+std::string functionName(const std::string& name) {
+    if (name.ends_with(":loop")) return name.substr(0, name.size() - 5);
+    return name;
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+} // namespace
+
+Profiler::Profiler(Mode mode, int64_t period) : mode(mode), period(period > 0 ? period : 1) {}
+
+Profiler::~Profiler() {
+    stop();
+}
+
+void Profiler::start() {
+    if (running) return;
+    running = true;
+    if (mode != Mode::Timer) return;
+    ticks.store(0, std::memory_order_relaxed);
+    struct sigaction action{};
+    action.sa_handler = onTick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &previous);
+    setTimer(period);
+}
+
+void Profiler::stop() {
+    if (!running) return;
+    running = false;
+    if (mode != Mode::Timer) return;
+    setTimer(0);
+    sigaction(SIGPROF, &previous, nullptr);
+}
+
+bool Profiler::due() {
+    if (mode == Mode::Steps) {
+        weight = 1;
+        return true;
+    }
+    uint32_t t = ticks.exchange(0, std::memory_order_relaxed);
+    weight = t;
+    return t != 0;
+}
+
+void Profiler::sample(const std::vector<Frame>& inner) {
+    size_t outer = frames.size() - (inner.empty() || frames.empty() ? 0 : 1);
+    std::vector<Frame> stack(frames.begin(), frames.begin() + outer);
+    stack.insert(stack.end(), inner.begin(), inner.end());
+    uint64_t w = weight ? weight : 1;
+    weight = 0;
+    if (stack.empty()) return;
+    stacks[stack] += w;
+    samples += w;
+}
+
+std::map<std::vector<std::pair<std::string, int>>, uint64_t> Profiler::resolve() const {
+    std::map<std::vector<std::pair<std::string, int>>, uint64_t> r;
+    for (const auto& [stack, count] : stacks) {
+        std::vector<std::pair<std::string, int>> named;
+        named.reserve(stack.size());
+        for (const Frame& f : stack) named.emplace_back(functionName(*f.function), f.line);
+        r[named] += count;
+    }
+    return r;
+}
+
+void Profiler::printFlat(std::ostream& out) const {
+    std::map<std::string, std::pair<uint64_t, uint64_t>> functions; // собственные и полные
+    std::map<std::pair<std::string, int>, uint64_t> lines;
+    for (const auto& [stack, count] : resolve()) {
+        functions[stack.back().first].first += count;
+        lines[stack.back()] += count;
+        // Рекурсивная функция считается в полных выборках один раз
+        std::set<std::string> seen;
+        for (const auto& frame : stack) {
+            if (seen.insert(frame.first).second) functions[frame.first].second += count;
+        }
+    }
+
+    char line[160];
+    out << "Profile: " << samples << " samples, ";
+    if (mode == Mode::Timer) out << "every " << period << " us of CPU time" << std::endl;
+    else out << "every " << period << " steps" << std::endl;
+
+    std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> byFunction(functions.begin(), functions.end());
+    std::stable_sort(byFunction.begin(), byFunction.end(), [](const auto& a, const auto& b) {
+        return a.second.first != b.second.first ? a.second.first > b.second.first : a.second.second > b.second.second;
+    });
+    std::snprintf(line, sizeof line, "  %10s %7s %10s %7s  %s", "self", "%", "total", "%", "function");
+    out << line << std::endl;
+    for (const auto& [name, counts] : byFunction) {
+        std::snprintf(line, sizeof line, "  %10llu %7.2f %10llu %7.2f  ", static_cast<unsigned long long>(counts.first),
+                      percent(counts.first, samples), static_cast<unsigned long long>(counts.second),
+                      percent(counts.second, samples));
+        out << line << name << std::endl;
+    }
+
+    std::vector<std::pair<std::pair<std::string, int>, uint64_t>> byLine(lines.begin(), lines.end());
+    std::stable_sort(byLine.begin(), byLine.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    out << "Hot lines:" << std::endl;
+    std::snprintf(line, sizeof line, "  %10s %7s %6s  %s", "self", "%", "line", "function");
+    out << line << std::endl;
+    for (const auto& [where, count] : byLine) {
+        std::snprintf(line, sizeof line, "  %10llu %7.2f %6d  ", static_cast<unsigned long long>(count),
+                      percent(count, samples), where.second);
+        out << line << where.first << std::endl;
+    }
+}
+
+void Profiler::printFolded(std::ostream& out) const {
+    for (const auto& [stack, count] : resolve()) {
+        for (size_t k = 0; k < stack.size(); ++k) {
+            out << (k ? ";" : "") << stack[k].first;
+            if (stack[k].second) out << ':' << stack[k].second;
+        }
+        out << ' ' << count << '\n';
+    }
+}
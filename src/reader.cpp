@@ -6,7 +6,10 @@ std::string readfile(int argc, char* argv[]){
         return "";
     }
     
-    std::string filename = argv[1];
+    return readfile(std::string(argv[1]));
+}
+
+std::string readfile(const std::string& filename){
     std::ifstream file(filename);
     
     if (!file.is_open()) {
@@ -0,0 +1,161 @@
+#include "../inc/regalloc.hpp"
+#include "../inc/ast_utils.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+void FrameAllocator::run(ASTNode& root) {
+    walk(root, [&](ASTNode& node) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(&node); func && func->body) {
+            layouts.push_back(allocate(*func));
+        }
+    });
+}
+
+FrameLayout FrameAllocator::allocate(FuncDeclNode& func) {
+    intervals.clear();
+    loops.clear();
+    scopes.clear();
+    position = 0;
+
+    // 1. Нумерация точек программы и интервалы жизни
+    scopes.emplace_back();
+    for (auto& param : func.params) {
+        declare(*param->declarator);
+    }
+    position++;
+    scan(*func.body);
+    scopes.pop_back();
+
+    // 2. Переменная, объявленная до цикла и используемая внутри него,
+    //    жива до конца цикла: значение нужно на следующей итерации
+    for (auto& iv : intervals) {
+        for (const auto& loop : loops) {
+            if (iv.start < loop.start && iv.end >= loop.start && iv.end <= loop.end) {
+                iv.end = loop.end;
+            }
+        }
+    }
+
+    // 3. Линейное сканирование. Аргументы кладутся в слоты 0..n-1 при входе, поэтому
+    //    слоты параметров закреплены и не попадают в свободные, даже если параметр
+    //    не используется
+    auto assign = [](Interval& iv, int slot) {
+        iv.slot = slot;
+        iv.decl->slot = slot;
+        for (auto* ref : iv.refs) ref->slot = slot;
+    };
+    int slotCount = static_cast<int>(func.params.size());
+    for (int i = 0; i < slotCount; ++i) assign(intervals[i], i);
+
+    std::vector<Interval*> order;
+    for (size_t i = func.params.size(); i < intervals.size(); ++i) order.push_back(&intervals[i]);
+    std::stable_sort(order.begin(), order.end(), [](Interval* a, Interval* b) { return a->start < b->start; });
+
+    auto byEnd = [](Interval* a, Interval* b) { return a->end > b->end; };
+    std::priority_queue<Interval*, std::vector<Interval*>, decltype(byEnd)> active(byEnd);
+    std::priority_queue<int, std::vector<int>, std::greater<int>> freeSlots;
+
+    for (Interval* iv : order) {
+        while (!active.empty() && active.top()->end < iv->start) {
+            freeSlots.push(active.top()->slot);
+            active.pop();
+        }
+        if (freeSlots.empty()) {
+            assign(*iv, slotCount++);
+        } else {
+            assign(*iv, freeSlots.top());
+            freeSlots.pop();
+        }
+        active.push(iv);
+    }
+
+    func.frame_size = slotCount;
+    return {func.name, slotCount, static_cast<int>(intervals.size())};
+}
+
+void FrameAllocator::declare(DeclaratorNode& decl) {
+    Interval iv;
+    iv.decl = &decl;
+    iv.start = iv.end = position++;
+    intervals.push_back(iv);
+    scopes.back().emplace_back(decl.name, intervals.size() - 1);
+}
+
+void FrameAllocator::use(IdentifierExprNode& id) {
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+        for (auto var = scope->rbegin(); var != scope->rend(); ++var) {
+            if (var->first == id.name) {
+                auto& iv = intervals[var->second];
+                iv.end = position++;
+                iv.refs.push_back(&id);
+                return;
+            }
+        }
+    }
+    // Не локальная переменная (глобальная или из пространства имён)
+    id.slot = -1;
+}
+
+// Области видимости повторяют семантический анализ: блок, for и while открывают новую
+void FrameAllocator::scan(ASTNode& node) {
+    if (auto block = dynamic_cast<BlockStatementNode*>(&node)) {
+        scopes.emplace_back();
+        for (auto& stmt : block->statements) scan(*stmt);
+        scopes.pop_back();
+        return;
+    }
+    if (auto loop = dynamic_cast<ForLoopNode*>(&node)) {
+        scopes.emplace_back();
+        if (loop->init) scan(*loop->init);
+        int start = position++;
+        if (loop->condition) scan(*loop->condition);
+        scan(*loop->body);
+        if (loop->increment) scan(*loop->increment);
+        loops.push_back({start, position++});
+        scopes.pop_back();
+        return;
+    }
+    if (auto loop = dynamic_cast<WhileLoopNode*>(&node)) {
+        scopes.emplace_back();
+        int start = position++;
+        scan(*loop->condition);
+        scan(*loop->body);
+        loops.push_back({start, position++});
+        scopes.pop_back();
+        return;
+    }
+    if (auto loop = dynamic_cast<DoWhileLoopNode*>(&node)) {
+        int start = position++;
+        scan(*loop->body);
+        scan(*loop->condition);
+        loops.push_back({start, position++});
+        return;
+    }
+    if (auto var = dynamic_cast<VarDeclNode*>(&node)) {
+        // Определение происходит после вычисления инициализатора
+        for (auto& d : var->declarators) {
+            if (d->declarator->array_size) scan(*d->declarator->array_size);
+            if (d->initializer) scan(*d->initializer);
+            declare(*d->declarator);
+        }
+        return;
+    }
+    if (auto id = dynamic_cast<IdentifierExprNode*>(&node)) {
+        use(*id);
+        return;
+    }
+    if (auto call = dynamic_cast<CallExprNode*>(&node)) {
+        for (auto& arg : call->arguments) scan(*arg);
+        return;
+    }
+    forEachSlot(node, [&](std::unique_ptr<ASTNode>& child) { scan(*child); });
+}
+
+void FrameAllocator::printReport(std::ostream& out) const {
+    out << "Frame allocator report:" << std::endl;
+    for (const auto& layout : layouts) {
+        out << "  " << layout.function << ": frame of " << layout.slot_count << " slots for "
+            << layout.variable_count << " variables" << std::endl;
+    }
+}
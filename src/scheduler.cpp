@@ -0,0 +1,102 @@
+#include "../inc/scheduler.hpp"
+#include "../inc/trace.hpp"
+#include <algorithm>
+#include <string>
+
+namespace {
+
+thread_local FiberScheduler* active = nullptr;
+
+} // namespace
+
+FiberScheduler::FiberScheduler(unsigned count, int64_t quantum) : quantum(quantum > 0 ? quantum : kDefaultQuantum) {
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned k = 0; k < count; ++k) queues.push_back(std::make_unique<Queue>());
+    for (unsigned k = 0; k < count; ++k) threads.emplace_back(&FiberScheduler::work, this, k);
+}
+
+FiberScheduler::~FiberScheduler() {
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+FiberScheduler* FiberScheduler::current() {
+    return active;
+}
+
+void FiberScheduler::spawn(std::function<void()> body) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        ++live;
+    }
+    // Новые волокна раздаются потокам по кругу
+    unsigned worker = nextWorker.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    push(worker, std::make_unique<Fiber>(std::move(body)));
+}
+
+void FiberScheduler::wait() {
+    std::unique_lock<std::mutex> guard(mutex);
+    idle.wait(guard, [&] { return live == 0; });
+}
+
+void FiberScheduler::push(unsigned worker, std::unique_ptr<Fiber> fiber) {
+    {
+        std::lock_guard<std::mutex> guard(queues[worker]->lock);
+        queues[worker]->fibers.push_back(std::move(fiber));
+    }
+    queued.fetch_add(1);
+    // Будим только если кто-то спит: queued и sleeping упорядочены (seq_cst),
+    // поэтому засыпающий поток либо увидит волокно, либо будет разбужен
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> guard(mutex);
+        wake.notify_one();
+    }
+}
+
+std::unique_ptr<Fiber> FiberScheduler::take(unsigned self) {
+    size_t count = queues.size();
+    for (size_t k = 0; k < count; ++k) {
+        Queue& queue = *queues[(self + k) % count];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.fibers.empty()) continue;
+        std::unique_ptr<Fiber> fiber;
+        if (k == 0) {
+            fiber = std::move(queue.fibers.front());
+            queue.fibers.pop_front();
+        } else {
+            fiber = std::move(queue.fibers.back());
+            queue.fibers.pop_back();
+        }
+        queued.fetch_sub(1);
+        return fiber;
+    }
+    return nullptr;
+}
+
+void FiberScheduler::work(unsigned self) {
+    active = this;
+    Trace::nameThread("fiber worker " + std::to_string(self));
+    for (;;) {
+        std::unique_ptr<Fiber> fiber = take(self);
+        if (!fiber) {
+            std::unique_lock<std::mutex> guard(mutex);
+            sleeping.fetch_add(1);
+            wake.wait(guard, [&] { return queued.load() > 0 || stopping; });
+            sleeping.fetch_sub(1);
+            if (stopping && queued.load() == 0) return;
+            continue;
+        }
+        if (!fiber->resume()) {
+            push(self, std::move(fiber));
+            continue;
+        }
+        fiber.reset();
+        std::lock_guard<std::mutex> guard(mutex);
+        if (--live == 0) idle.notify_all();
+    }
+}
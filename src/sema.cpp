@@ -1,10 +1,15 @@
 #include "../inc/sema.hpp"
+#include "../inc/ast_utils.hpp"
 
 void SemanticAnalyzer::analyze(ASTNode& root) {
-    if (auto* tu = dynamic_cast<TranslationUnitNode*>(&root)) {
-        collectFunctionSignatures(*tu);  // Сначала сигнатуры
+    try {
+        if (auto* tu = dynamic_cast<TranslationUnitNode*>(&root)) {
+            collectFunctionSignatures(*tu);  // Сначала сигнатуры
+        }
+        root.accept(*this);  // Потом всё остальное
+    } catch (const SemanticError& e) {
+        errors.push_back(e.what());
     }
-    root.accept(*this);  // Потом всё остальное
 }
 
 void SemanticAnalyzer::visit(TranslationUnitNode& node){
@@ -31,7 +36,7 @@ void SemanticAnalyzer::visit(VarDeclNode& node) {
     }
 
     for (auto& decl : node.declarators) {
-        if (!declareVariable(decl->declarator->name, type)) {
+        if (!declareVariable(decl->declarator->name, declaredType(type, *decl->declarator))) {
             throw SemanticError("Redefinition of variable: " + decl->declarator->name);
         }
         // После добавления в таблицу — проверка инициализации
@@ -59,7 +64,12 @@ void SemanticAnalyzer::collectFunctionSignatures(TranslationUnitNode& node) {
                 if (!paramTypeNode) {
                     throw SemanticError("Invalid parameter type in function " + sig.name);
                 }
-                sig.paramTypes.push_back(std::make_shared<BuiltinType>(paramTypeNode->type_name));
+                std::shared_ptr<Type> paramType = std::make_shared<BuiltinType>(paramTypeNode->type_name);
+                if (param->declarator->is_array) {
+                    // Длина параметра не проверяется: передаётся массив любой длины
+                    paramType = std::make_shared<ArrayType>(paramType, 0);
+                }
+                sig.paramTypes.push_back(paramType);
             }
 
             if (functionTable.count(sig.name)) {
@@ -113,6 +123,12 @@ void SemanticAnalyzer::visit(DeclaratorNode& node) {
 }
 
 void SemanticAnalyzer::visit(InitDeclaratorNode& node) {
+    if (auto list = dynamic_cast<InitListNode*>(node.initializer.get())) {
+        auto varType = lookupVariable(node.declarator->name);
+        if (!varType) throw SemanticError("Variable not declared before initializer");
+        checkInitList(*list, *varType, node.declarator->name);
+        return;
+    }
     if (node.initializer) {
         node.initializer->accept(*this);
 
@@ -143,33 +159,148 @@ void SemanticAnalyzer::visit(StructDeclNode& node) {
             throw SemanticError("Invalid type for member in struct " + node.name);
         }
 
-        auto memberType = std::make_shared<BuiltinType>(typeNode->type_name);
+        // Поле-структура получает тип из таблицы: через него проверяется s.p.x
+        std::shared_ptr<Type> memberType;
+        auto nested = typeTable.find(typeNode->type_name);
+        if (nested != typeTable.end()) memberType = nested->second;
+        else memberType = std::make_shared<BuiltinType>(typeNode->type_name);
+
+        Storage element;
+        size_t align = 1;
+        if (!storageOf(typeNode->type_name, typeNode->is_unsigned, element, align)) {
+            throw SemanticError("Member type " + typeNode->type_name + " is incomplete in struct " + node.name);
+        }
 
         for (const auto& initDecl : varDecl->declarators) {
             const std::string& fieldName = initDecl->declarator->name;
             if (structType->fields.count(fieldName)) {
                 throw SemanticError("Duplicate member '" + fieldName + "' in struct " + node.name);
             }
-            structType->addField(fieldName, memberType);
+            Storage storage = element;
+            if (initDecl->declarator->array_size) {
+                auto count = constantIntValue(initDecl->declarator->array_size.get());
+                if (!count || *count <= 0) {
+                    throw SemanticError("Array member '" + fieldName + "' needs a positive constant size");
+                }
+                if (element.kind == Value::Kind::Struct) {
+                    throw SemanticError("Array of structs as member '" + fieldName + "' is not supported");
+                }
+                storage.kind = Value::Kind::Array;
+                storage.element = element.kind;
+                storage.count = static_cast<uint32_t>(*count);
+                structType->addField(fieldName, std::make_shared<ArrayType>(memberType, *count));
+            } else {
+                structType->addField(fieldName, memberType);
+            }
+            structType->place(fieldName, storage, align);
         }
     }
+    structType->finishLayout();
 
     // Зарегистрируем struct как тип (в переменной/типовой таблице)
     if (typeTable.count(node.name)) {
         throw SemanticError("Redefinition of struct: " + node.name);
     }
     typeTable[node.name] = structType;
+    node.type = structType;
+}
 
+std::shared_ptr<Type> SemanticAnalyzer::declaredType(const std::shared_ptr<Type>& base, DeclaratorNode& declarator) {
+    if (!declarator.is_array) return base;
+    size_t length = 0;
+    if (declarator.array_size) {
+        auto sizeType = std::dynamic_pointer_cast<BuiltinType>(getType(*declarator.array_size));
+        if (!sizeType || kindOf(sizeType->name) < Value::Kind::Bool || kindOf(sizeType->name) > Value::Kind::ULong) {
+            throw SemanticError("Array size of " + declarator.name + " must be an integer");
+        }
+        // Неконстантный размер проверяется при исполнении, длина остаётся неизвестной
+        if (auto value = constantIntValue(declarator.array_size.get())) {
+            if (*value < 0) throw SemanticError("Negative size of array " + declarator.name);
+            length = static_cast<size_t>(*value);
+        }
+    }
+    return std::make_shared<ArrayType>(base, length);
+}
+
+// Массив — элементы по порядку, структура — поля в порядке объявления
+void SemanticAnalyzer::checkInitList(InitListNode& list, const std::shared_ptr<Type>& type, const std::string& name) {
+    std::vector<std::shared_ptr<Type>> expected;
+    if (auto arr = std::dynamic_pointer_cast<ArrayType>(type)) {
+        if (arr->length && list.elements.size() > arr->length) {
+            throw SemanticError("Too many initializers for " + name);
+        }
+        expected.assign(list.elements.size(), arr->element);
+    } else if (auto st = std::dynamic_pointer_cast<StructType>(type)) {
+        if (list.elements.size() > st->layout.size()) throw SemanticError("Too many initializers for " + name);
+        for (size_t k = 0; k < list.elements.size(); ++k) expected.push_back(st->getFieldType(st->layout[k].name));
+    } else {
+        throw SemanticError("Initializer list for scalar " + name);
+    }
+    for (size_t k = 0; k < list.elements.size(); ++k) {
+        if (!getType(*list.elements[k])->equals(*expected[k])) {
+            throw SemanticError("Initializer " + std::to_string(k + 1) + " type mismatch for variable " + name);
+        }
+    }
+    list.resolved_type = type;
+}
+
+// Выравнивание естественное, как у C на 64-битных платформах; строка — указатель
+bool SemanticAnalyzer::storageOf(const std::string& typeName, bool isUnsigned, Storage& storage,
+                                 size_t& align) const {
+    auto it = typeTable.find(typeName);
+    if (it != typeTable.end()) {
+        auto st = std::dynamic_pointer_cast<StructType>(it->second);
+        if (!st) return false;
+        storage.kind = Value::Kind::Struct;
+        storage.layout = st.get();
+        align = st->align;
+        return true;
+    }
+    storage.kind = kindOf(typeName, isUnsigned);
+    if (storage.kind == Value::Kind::Void) return false;
+    align = Aggregate::kindSize(storage.kind);
+    return true;
+}
+
+int64_t SemanticAnalyzer::sizeOf(ASTNode& operand) {
+    std::string name;
+    bool isUnsigned = false;
+    int64_t length = 1;
+    if (auto type = dynamic_cast<TypeNode*>(&operand)) {
+        name = type->type_name;
+        isUnsigned = type->is_unsigned;
+    } else {
+        auto exprType = getType(operand);
+        if (auto arr = std::dynamic_pointer_cast<ArrayType>(exprType)) {
+            if (!arr->length) throw SemanticError("sizeof of array " + arr->toString() + " with unknown length");
+            length = static_cast<int64_t>(arr->length);
+            exprType = arr->element;
+        }
+        auto builtin = std::dynamic_pointer_cast<BuiltinType>(exprType);
+        auto st = std::dynamic_pointer_cast<StructType>(exprType);
+        name = builtin ? builtin->name : st ? st->name : exprType->toString();
+        isUnsigned = builtin && builtin->is_unsigned;
+    }
+    Storage storage;
+    size_t align = 1;
+    // Строка в языке — значение, а не указатель: её размер не определён
+    if (name == "string" || !storageOf(name, isUnsigned, storage, align)) {
+        throw SemanticError("sizeof is not supported for " + name);
+    }
+    return length * static_cast<int64_t>(storage.size());
 }
 
 void SemanticAnalyzer::visit(BlockStatementNode& node) {
      enterScope();  // ← вот это критично
-    for (auto& stmt : node.statements) {
-        stmt->accept(*this);
-    }
+    for (auto& stmt : node.statements) statement(*stmt);
     exitScope(); 
 }
 
+void SemanticAnalyzer::statement(ASTNode& stmt) {
+    if (dynamic_cast<ExprNode*>(&stmt)) getType(stmt);
+    else stmt.accept(*this);
+}
+
 void SemanticAnalyzer::visit(IfStatementNode& node) {
     auto condExpr = dynamic_cast<ExprNode*>(node.condition.get());
     if (!condExpr) throw SemanticError("Invalid condition in if");
@@ -180,9 +311,9 @@ void SemanticAnalyzer::visit(IfStatementNode& node) {
         throw SemanticError("Condition in if-statement must be of type int or bool");
     }
 
-    node.then_branch->accept(*this);
+    statement(*node.then_branch);
     if (node.else_branch) {
-        node.else_branch->accept(*this);
+        statement(*node.else_branch);
     }
 }
 
@@ -197,12 +328,12 @@ void SemanticAnalyzer::visit(WhileLoopNode& node) {
         throw SemanticError("Condition in while-loop must be of type int or bool");
     }
 
-    node.body->accept(*this);
+    statement(*node.body);
     exitScope();
 }
 
 void SemanticAnalyzer::visit(DoWhileLoopNode& node) {
-    node.body->accept(*this);
+    statement(*node.body);
 
     auto condExpr = dynamic_cast<ExprNode*>(node.condition.get());
     if (!condExpr) throw SemanticError("Invalid condition in do-while");
@@ -229,8 +360,8 @@ void SemanticAnalyzer::visit(ForLoopNode& node) {
         }
     }
 
-    if (node.increment) node.increment->accept(*this);
-    node.body->accept(*this);
+    if (node.increment) getType(*node.increment);
+    statement(*node.body);
     exitScope();
 }
 
@@ -256,18 +387,18 @@ void SemanticAnalyzer::visit(ContinueStmtNode& node) {
 
 void SemanticAnalyzer::visit(ReadStmtNode& node) {
     if (node.argument) {
-        node.argument->accept(*this);
+        getType(*node.argument);
     }
 }
 
 void SemanticAnalyzer::visit(PrintStmtNode& node) {
     if (node.argument) {
-        node.argument->accept(*this);
+        getType(*node.argument);
     }
 }
 
 void SemanticAnalyzer::visit(StaticAssertNode& node) {
-    node.condition->accept(*this);
+    getType(*node.condition);
 }
 
 void SemanticAnalyzer::visit(BinaryExprNode& node) {
@@ -347,13 +478,13 @@ void SemanticAnalyzer::visit(SizeofExprNode& node) {
 
 void SemanticAnalyzer::visit(ExitExprNode& node) {
     for (auto& arg : node.arguments) {
-        arg->accept(*this);
+        getType(*arg);
     }
 }
 
 void SemanticAnalyzer::visit(AssertExprNode& node) {
     for (auto& arg : node.arguments) {
-        arg->accept(*this);
+        getType(*arg);
     }
 }
 
@@ -364,6 +495,9 @@ void SemanticAnalyzer::visit(AssignmentExprNode& node) {
 
     auto lhsType = getType(*lhs);
     auto rhsType = getType(*rhs);
+    if (std::dynamic_pointer_cast<ArrayType>(lhsType)) {
+        throw SemanticError("Array is not assignable");
+    }
     if (!lhsType->equals(*rhsType)) {
         throw SemanticError("Type mismatch in assignment");
     }
@@ -383,6 +517,7 @@ void SemanticAnalyzer::visit(MemberAccessExprNode& node) {
     if (!structType->getFieldType(node.member)) {
         throw SemanticError("Struct '" + structType->name + "' has no member '" + node.member + "'");
     }
+    node.field = structType->findField(node.member);
 }
 
 void SemanticAnalyzer::visit(NamespaceDeclNode& node) {
@@ -397,11 +532,18 @@ void SemanticAnalyzer::visit(ScopedIdentifierExprNode& node) {
     // Проверка области видимости может быть добавлена позже
 }
 
+// Выводит тип и сохраняет его в узле для последующих проходов
 std::shared_ptr<Type> SemanticAnalyzer::getType(ASTNode& expr) {
     auto exprNode = dynamic_cast<ExprNode*>(&expr);
     if (!exprNode) {
         throw SemanticError("Node is not an expression");
     }
+    auto type = inferType(expr);
+    exprNode->resolved_type = type;
+    return type;
+}
+
+std::shared_ptr<Type> SemanticAnalyzer::inferType(ASTNode& expr) {
     expr.accept(*this); // пройти поддерево, если нужно
 
     if (auto id = dynamic_cast<IdentifierExprNode*>(&expr)) {
@@ -437,6 +579,7 @@ std::shared_ptr<Type> SemanticAnalyzer::getType(ASTNode& expr) {
     }
 
     if (auto tern = dynamic_cast<TernaryExprNode*>(&expr)) {
+        getType(*tern->condition);
         auto thenType = getType(*tern->then_expr);
         auto elseType = getType(*tern->else_expr);
         if (!thenType->equals(*elseType)) {
@@ -450,12 +593,16 @@ std::shared_ptr<Type> SemanticAnalyzer::getType(ASTNode& expr) {
         if (!tnode) {
             throw SemanticError("Invalid cast type");
         }
+        getType(*cast->expression);
         return std::make_shared<BuiltinType>(tnode->type_name, tnode->is_const, tnode->is_unsigned);
     }
 
     if (auto assign = dynamic_cast<AssignmentExprNode*>(&expr)) {
         auto lhsType = getType(*assign->left);
         auto rhsType = getType(*assign->right);
+        if (std::dynamic_pointer_cast<ArrayType>(lhsType)) {
+            throw SemanticError("Array is not assignable");
+        }
         if (!lhsType->equals(*rhsType)) {
             throw SemanticError("Type mismatch in assignment");
         }
@@ -497,7 +644,15 @@ std::shared_ptr<Type> SemanticAnalyzer::getType(ASTNode& expr) {
     }
 
     if (auto subscr = dynamic_cast<SubscriptExprNode*>(&expr)) {
-        return getType(*subscr->array); // TODO: проверить, что это массив
+        auto indexType = std::dynamic_pointer_cast<BuiltinType>(getType(*subscr->index));
+        if (!indexType || kindOf(indexType->name) < Value::Kind::Bool || kindOf(indexType->name) > Value::Kind::ULong) {
+            throw SemanticError("Array index must be an integer");
+        }
+        auto arrayType = std::dynamic_pointer_cast<ArrayType>(getType(*subscr->array));
+        if (!arrayType) {
+            throw SemanticError("Subscript of non-array type");
+        }
+        return arrayType->element;
     }
 
     if (auto mem = dynamic_cast<MemberAccessExprNode*>(&expr)) {
@@ -511,10 +666,24 @@ std::shared_ptr<Type> SemanticAnalyzer::getType(ASTNode& expr) {
         if (!fieldType) {
             throw SemanticError("Struct '" + structType->name + "' has no member '" + mem->member + "'");
         }
+        mem->field = structType->findField(mem->member);
 
         return fieldType;
     }
 
+    if (auto size = dynamic_cast<SizeofExprNode*>(&expr)) {
+        size->size = sizeOf(*size->operand);
+        return std::make_shared<BuiltinType>("int");
+    }
+
+    if (dynamic_cast<ExitExprNode*>(&expr)) {
+        return std::make_shared<BuiltinType>("void");
+    }
+
+    if (dynamic_cast<AssertExprNode*>(&expr)) {
+        return std::make_shared<BuiltinType>("void");
+    }
+
     if (auto scoped = dynamic_cast<ScopedIdentifierExprNode*>(&expr)) {
         std::string name = scoped->getName();  // <-- правильно достаём имя
         auto varType = lookupVariable(name);   // пока игнорируем namespace-путь
@@ -0,0 +1,345 @@
+#include "../inc/server.hpp"
+#include "../inc/cache.hpp"
+#include "../inc/fiber.hpp"
+#include "../inc/interpret.hpp"
+#include "../inc/io.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// В волокне ожидание данных не занимает поток: пока сокет пуст, волокно
+// уступает поток другим; если уступать некому, поток ждёт сокет до 1 мс
+void waitReadable(int fd) {
+    if (!Fiber::current()) return;
+    pollfd p{fd, POLLIN, 0};
+    for (int idle = 0;; ++idle) {
+        if (poll(&p, 1, idle < 64 ? 0 : 1) != 0) return;
+        Fiber::yield();
+    }
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        waitReadable(fd);
+        ssize_t n = ::read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string encode(uint32_t v) {
+    return std::string(reinterpret_cast<const char*>(&v), sizeof v);
+}
+
+uint32_t decode(const std::string& payload) {
+    uint32_t v = 0;
+    std::memcpy(&v, payload.data(), std::min(payload.size(), sizeof v));
+    return v;
+}
+
+std::string encodeLimits(const ExecutionLimits& limits) {
+    std::string out(36, '\0');
+    auto depth = static_cast<int32_t>(limits.callDepth);
+    std::memcpy(&out[0], &limits.steps, 8);
+    std::memcpy(&out[8], &limits.seconds, 8);
+    std::memcpy(&out[16], &depth, 4);
+    std::memcpy(&out[20], &limits.memory, 8);
+    std::memcpy(&out[28], &limits.output, 8);
+    return out;
+}
+
+bool decodeLimits(const std::string& payload, ExecutionLimits& limits) {
+    if (payload.size() != 36) return false;
+    int32_t depth = 0;
+    std::memcpy(&limits.steps, &payload[0], 8);
+    std::memcpy(&limits.seconds, &payload[8], 8);
+    std::memcpy(&depth, &payload[16], 4);
+    std::memcpy(&limits.memory, &payload[20], 8);
+    std::memcpy(&limits.output, &payload[28], 8);
+    limits.callDepth = depth;
+    return true;
+}
+
+// Более строгий из двух пределов; 0 — без предела
+template <typename T>
+T tighter(T a, T b) {
+    if (a <= 0) return b;
+    if (b <= 0) return a;
+    return std::min(a, b);
+}
+
+bool socketAddress(const std::string& path, sockaddr_un& addr) {
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Готовые программы по ключу CompileCache::key; вытесняется давно не использованная
+class ProgramCache {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    std::optional<interpret::Program> find(const std::string& key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(key);
+        if (it == index.end()) return std::nullopt;
+        order.splice(order.begin(), order, it->second);
+        return it->second->second;
+    }
+
+    void insert(const std::string& key, const interpret::Program& program) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (auto it = index.find(key); it != index.end()) {
+            order.erase(it->second);
+            index.erase(it);
+        }
+        order.emplace_front(key, program);
+        index[key] = order.begin();
+        if (order.size() > kCapacity) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+    }
+
+private:
+    std::mutex lock;
+    std::list<std::pair<std::string, interpret::Program>> order; // сначала последние использованные
+    std::unordered_map<std::string, std::list<std::pair<std::string, interpret::Program>>::iterator> index;
+};
+
+void handle(int fd, ProgramCache& cache, const ExecutionLimits& caps) {
+    std::string hash, source, payload;
+    uint32_t flags = 0;
+    ExecutionLimits requested;
+    bool haveSource = false;
+    Message type;
+    do {
+        if (!readMessage(fd, type, payload)) return;
+        switch (type) {
+        case Message::Hash: hash = std::move(payload); break;
+        case Message::Flags: flags = decode(payload); break;
+        case Message::Source:
+            source = std::move(payload);
+            haveSource = true;
+            break;
+        case Message::Limits:
+            if (!decodeLimits(payload, requested)) return;
+            break;
+        case Message::Run: break;
+        default: return;
+        }
+    } while (type != Message::Run);
+
+    std::optional<interpret::Program> program;
+    if (!haveSource && !hash.empty()) program = cache.find(hash);
+    if (!program) {
+        if (!haveSource) {
+            if (!sendMessage(fd, Message::NeedSource, {})) return;
+            if (!readMessage(fd, type, source) || type != Message::Source) return;
+        }
+        interpret::CompileOptions options;
+        options.optimize = flags & kServeOptimize;
+        try {
+            program = interpret::compile(source, options);
+        } catch (const interpret::CompileError& e) {
+            std::string text;
+            for (const auto& error : e.errors()) text += error + '\n';
+            sendMessage(fd, Message::Diagnostics, text);
+            sendMessage(fd, Message::Exit, encode(1) + static_cast<char>(interpret::Termination::Error));
+            return;
+        }
+        // Ключ считает сервер: ключу клиента без исходного текста не доверяем
+        cache.insert(CompileCache::key(source, options.optimize), *program);
+    }
+
+    if (!program->report().empty()) sendMessage(fd, Message::Diagnostics, program->report());
+    interpret::IO io;
+    io.read = [fd](char* buffer, size_t size) -> size_t {
+        std::string chunk;
+        Message reply;
+        if (!sendMessage(fd, Message::NeedInput, encode(static_cast<uint32_t>(std::min<size_t>(size, kMaxMessage)))) ||
+            !readMessage(fd, reply, chunk) || reply != Message::Input || chunk.size() > size) {
+            return 0;
+        }
+        std::memcpy(buffer, chunk.data(), chunk.size());
+        return chunk.size();
+    };
+    io.write = [fd](std::string_view text) { return sendMessage(fd, Message::Output, text); };
+    interpret::Limits limits;
+    limits.steps = tighter(requested.steps, caps.steps);
+    limits.seconds = tighter(requested.seconds, caps.seconds);
+    limits.callDepth = tighter(requested.callDepth, caps.callDepth);
+    limits.memory = tighter(requested.memory, caps.memory);
+    limits.output = tighter(requested.output, caps.output);
+    int code = program->run(io, limits);
+    if (!io.errors.empty()) sendMessage(fd, Message::Diagnostics, io.errors);
+    sendMessage(fd, Message::Exit, encode(static_cast<uint32_t>(code)) + static_cast<char>(io.termination));
+}
+
+} // namespace
+
+bool sendMessage(int fd, Message type, std::string_view payload) {
+    char header[5];
+    header[0] = static_cast<char>(type);
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    std::memcpy(header + 1, &size, sizeof size);
+    return sendAll(fd, header, sizeof header) && sendAll(fd, payload.data(), payload.size());
+}
+
+bool readMessage(int fd, Message& type, std::string& payload) {
+    char header[5];
+    if (!readAll(fd, header, sizeof header)) return false;
+    uint32_t size = 0;
+    std::memcpy(&size, header + 1, sizeof size);
+    auto tag = static_cast<uint8_t>(header[0]);
+    if (tag < static_cast<uint8_t>(Message::Source) || tag > static_cast<uint8_t>(Message::Limits)) return false;
+    if (size > kMaxMessage) return false;
+    type = static_cast<Message>(tag);
+    payload.resize(size);
+    return readAll(fd, payload.data(), size);
+}
+
+int serve(const std::string& socketPath, unsigned workers, int64_t quantum, const ExecutionLimits& caps) {
+    sockaddr_un addr;
+    if (!socketAddress(socketPath, addr)) {
+        std::cerr << "Слишком длинный путь сокета: " << socketPath << std::endl;
+        return 1;
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        std::cerr << "Не удалось создать сокет" << std::endl;
+        return 1;
+    }
+    // Сокет, оставшийся от завершённого сервера, удаляется; живой сервер не трогаем
+    if (connect(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) {
+        std::cerr << "Сервер уже работает: " << socketPath << std::endl;
+        close(listener);
+        return 1;
+    }
+    close(listener);
+    unlink(socketPath.c_str());
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 ||
+        listen(listener, 128) != 0) {
+        std::cerr << "Не удалось открыть сокет " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    ProgramCache cache;
+    // Соединение — волокно: потоков столько, сколько workers, а не сколько запросов
+    interpret::Scheduler scheduler(workers, quantum);
+    std::cerr << "Serving on " << socketPath << " (" << workers << " workers)" << std::endl;
+    for (;;) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        scheduler.spawn([fd, &cache, &caps] {
+            handle(fd, cache, caps);
+            close(fd);
+        });
+    }
+    std::cerr << "accept: " << std::strerror(errno) << std::endl;
+    scheduler.wait();
+    close(listener);
+    unlink(socketPath.c_str());
+    return 1;
+}
+
+int runClient(const std::string& socketPath, const std::string& file, bool optimize, const ExecutionLimits& limits) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        std::cerr << "Ошибка: не удалось открыть файл!" << std::endl;
+        return 1;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    std::string source = text.str();
+
+    sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (!socketAddress(socketPath, addr) || fd < 0 ||
+        connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        std::cerr << "Не удалось подключиться к серверу " << socketPath << std::endl;
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+    bool sent = sendMessage(fd, Message::Hash, CompileCache::key(source, optimize)) &&
+                sendMessage(fd, Message::Flags, encode(optimize ? kServeOptimize : 0));
+    sent = sent && sendMessage(fd, Message::Limits, encodeLimits(limits));
+    sent = sent && sendMessage(fd, Message::Run, {});
+
+    OutputBuffer out(STDOUT_FILENO);
+    Message type;
+    std::string payload;
+    std::vector<char> block;
+    while (sent && readMessage(fd, type, payload)) {
+        switch (type) {
+        case Message::NeedSource:
+            sent = sendMessage(fd, Message::Source, source);
+            break;
+        case Message::NeedInput: {
+            // Как и интерпретатор, перед чтением отдаём уже напечатанное
+            out.flush();
+            block.resize(std::max<uint32_t>(1, decode(payload)));
+            ssize_t n;
+            do {
+                n = ::read(STDIN_FILENO, block.data(), block.size());
+            } while (n < 0 && errno == EINTR);
+            sent = sendMessage(fd, Message::Input, std::string_view(block.data(), n > 0 ? static_cast<size_t>(n) : 0));
+            break;
+        }
+        case Message::Output:
+            out.write(payload);
+            break;
+        case Message::Diagnostics:
+            out.flush();
+            std::cerr << payload << std::flush;
+            break;
+        case Message::Exit:
+            out.flush();
+            close(fd);
+            return static_cast<int>(decode(payload));
+        default:
+            sent = false;
+            break;
+        }
+    }
+    out.flush();
+    close(fd);
+    std::cerr << "Соединение с сервером прервано" << std::endl;
+    return 1;
+}
@@ -0,0 +1,187 @@
+#include "../inc/simd.hpp"
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+// Векторные типы GCC/Clang: операции над ними компилируются в команды набора,
+// под который собрана функция (SSE2 по умолчанию, AVX2 с target("avx2"))
+template <typename T, size_t Bytes>
+struct Vec {
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+template <typename T>
+[[gnu::always_inline]] inline T load(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+// Векторы передаются по ссылке: 32-байтный вектор по значению в функции
+// без AVX менял бы ABI
+template <typename V>
+[[gnu::always_inline]] inline void loadVector(V& v, const unsigned char* p) {
+    std::memcpy(&v, p, sizeof v);
+}
+
+// a = a op b
+template <VectorOp Op, typename V>
+[[gnu::always_inline]] inline void apply(V& a, const V& b) {
+    if constexpr (Op == VectorOp::Add) a += b;
+    else if constexpr (Op == VectorOp::Sub) a -= b;
+    else if constexpr (Op == VectorOp::Mul) a *= b;
+    else if constexpr (Op == VectorOp::Div) a /= b;
+}
+
+// Полные векторы, затем скалярный хвост из n % W элементов
+template <typename T, size_t Bytes, VectorOp Op>
+[[gnu::always_inline]] inline void mapLoop(unsigned char* dst, VectorOperand x, VectorOperand y, size_t n) {
+    using V = typename Vec<T, Bytes>::type;
+    constexpr size_t W = Bytes / sizeof(T);
+    T sx = x.scalar ? load<T>(x.data) : T{};
+    T sy = y.scalar ? load<T>(y.data) : T{};
+    V bx = V{} + sx;
+    V by = V{} + sy;
+    size_t k = 0;
+    for (; k + W <= n; k += W) {
+        V a = bx, b = by;
+        if (!x.scalar) loadVector(a, x.data + k * sizeof(T));
+        if (!y.scalar) loadVector(b, y.data + k * sizeof(T));
+        apply<Op>(a, b);
+        std::memcpy(dst + k * sizeof(T), &a, sizeof a);
+    }
+    for (; k < n; ++k) {
+        T a = x.scalar ? sx : load<T>(x.data + k * sizeof(T));
+        T b = y.scalar ? sy : load<T>(y.data + k * sizeof(T));
+        apply<Op>(a, b);
+        std::memcpy(dst + k * sizeof(T), &a, sizeof a);
+    }
+}
+
+template <typename T, size_t Bytes, VectorOp Op>
+[[gnu::always_inline]] inline T sumLoop(VectorOperand x, VectorOperand y, size_t n) {
+    using V = typename Vec<T, Bytes>::type;
+    constexpr size_t W = Bytes / sizeof(T);
+    T sx = x.scalar ? load<T>(x.data) : T{};
+    T sy = y.scalar ? load<T>(y.data) : T{};
+    V bx = V{} + sx;
+    V by = V{} + sy;
+    V acc = V{};
+    size_t k = 0;
+    for (; k + W <= n; k += W) {
+        V a = bx, b = by;
+        if (!x.scalar) loadVector(a, x.data + k * sizeof(T));
+        if (!y.scalar) loadVector(b, y.data + k * sizeof(T));
+        apply<Op>(a, b);
+        acc += a;
+    }
+    T sum = 0;
+    for (size_t lane = 0; lane < W; ++lane) sum += acc[lane];
+    for (; k < n; ++k) {
+        T a = x.scalar ? sx : load<T>(x.data + k * sizeof(T));
+        T b = y.scalar ? sy : load<T>(y.data + k * sizeof(T));
+        apply<Op>(a, b);
+        sum += a;
+    }
+    return sum;
+}
+
+template <typename T, size_t Bytes>
+[[gnu::always_inline]] inline void mapOps(VectorOp op, unsigned char* dst, VectorOperand x, VectorOperand y,
+                                          size_t n) {
+    switch (op) {
+    case VectorOp::Copy: mapLoop<T, Bytes, VectorOp::Copy>(dst, x, x, n); break;
+    case VectorOp::Add: mapLoop<T, Bytes, VectorOp::Add>(dst, x, y, n); break;
+    case VectorOp::Sub: mapLoop<T, Bytes, VectorOp::Sub>(dst, x, y, n); break;
+    case VectorOp::Mul: mapLoop<T, Bytes, VectorOp::Mul>(dst, x, y, n); break;
+    case VectorOp::Div:
+        // Целое деление проверяет ноль и в ядра не попадает
+        if constexpr (std::is_floating_point_v<T>) mapLoop<T, Bytes, VectorOp::Div>(dst, x, y, n);
+        break;
+    }
+}
+
+template <typename T, size_t Bytes>
+[[gnu::always_inline]] inline T sumOps(VectorOp op, VectorOperand x, VectorOperand y, size_t n) {
+    switch (op) {
+    case VectorOp::Add: return sumLoop<T, Bytes, VectorOp::Add>(x, y, n);
+    case VectorOp::Sub: return sumLoop<T, Bytes, VectorOp::Sub>(x, y, n);
+    case VectorOp::Mul: return sumLoop<T, Bytes, VectorOp::Mul>(x, y, n);
+    default: return sumLoop<T, Bytes, VectorOp::Copy>(x, x, n);
+    }
+}
+
+// Целые считаются в беззнаковых типах той же ширины: переполнение по модулю
+template <size_t Bytes>
+[[gnu::always_inline]] inline void mapKinds(VectorOp op, Value::Kind kind, unsigned char* dst, VectorOperand x,
+                                            VectorOperand y, size_t n) {
+    switch (kind) {
+    case Value::Kind::Int: mapOps<uint32_t, Bytes>(op, dst, x, y, n); break;
+    case Value::Kind::Long: mapOps<uint64_t, Bytes>(op, dst, x, y, n); break;
+    case Value::Kind::Float: mapOps<float, Bytes>(op, dst, x, y, n); break;
+    case Value::Kind::Double: mapOps<double, Bytes>(op, dst, x, y, n); break;
+    default: break;
+    }
+}
+
+template <size_t Bytes>
+[[gnu::always_inline]] inline int64_t sumKinds(VectorOp op, Value::Kind kind, VectorOperand x, VectorOperand y,
+                                               size_t n) {
+    if (kind == Value::Kind::Int) return static_cast<int32_t>(sumOps<uint32_t, Bytes>(op, x, y, n));
+    return static_cast<int64_t>(sumOps<uint64_t, Bytes>(op, x, y, n));
+}
+
+void mapSse2(VectorOp op, Value::Kind kind, unsigned char* dst, VectorOperand x, VectorOperand y, size_t n) {
+    mapKinds<16>(op, kind, dst, x, y, n);
+}
+
+int64_t sumSse2(VectorOp op, Value::Kind kind, VectorOperand x, VectorOperand y, size_t n) {
+    return sumKinds<16>(op, kind, x, y, n);
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) void mapAvx2(VectorOp op, Value::Kind kind, unsigned char* dst, VectorOperand x,
+                                             VectorOperand y, size_t n) {
+    mapKinds<32>(op, kind, dst, x, y, n);
+}
+
+__attribute__((target("avx2"))) int64_t sumAvx2(VectorOp op, Value::Kind kind, VectorOperand x, VectorOperand y,
+                                                size_t n) {
+    return sumKinds<32>(op, kind, x, y, n);
+}
+
+bool hasAvx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+} // namespace
+
+void vectorMap(VectorOp op, Value::Kind kind, unsigned char* dst, VectorOperand x, VectorOperand y, size_t n) {
+#if defined(__x86_64__)
+    if (hasAvx2()) return mapAvx2(op, kind, dst, x, y, n);
+#endif
+    mapSse2(op, kind, dst, x, y, n);
+}
+
+int64_t vectorSum(VectorOp op, Value::Kind kind, VectorOperand x, VectorOperand y, size_t n) {
+#if defined(__x86_64__)
+    if (hasAvx2()) return sumAvx2(op, kind, x, y, n);
+#endif
+    return sumSse2(op, kind, x, y, n);
+}
+
+const char* vectorIsa() {
+#if defined(__x86_64__)
+    return hasAvx2() ? "avx2" : "sse2";
+#else
+    return "generic";
+#endif
+}
+
+bool vectorKind(Value::Kind kind) {
+    return kind == Value::Kind::Int || kind == Value::Kind::Long || kind == Value::Kind::Float ||
+           kind == Value::Kind::Double;
+}
@@ -0,0 +1,298 @@
+#include "../inc/tiering.hpp"
+#include "../inc/jit.hpp"
+#include "../inc/trace.hpp"
+#include <algorithm>
+#include <iostream>
+
+const char* tierName(Tier tier) {
+    switch (tier) {
+    case Tier::Tree: return "interpreter";
+    case Tier::Bytecode: return "bytecode";
+    case Tier::Native: return "native";
+    }
+    return "?";
+}
+
+TierManager::TierManager(TranslationUnitNode& program, Jit* jit, TierOptions options)
+    : options(options), jit(jit), constants(constantsOf(program)) {
+    for (auto& decl : program.declarations) {
+        if (auto func = dynamic_cast<FuncDeclNode*>(decl.get()); func && func->body) {
+            functions[func->name] = func;
+            profiles[func].func = func;
+        }
+    }
+}
+
+TierManager::~TierManager() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void TierManager::preload(std::vector<std::unique_ptr<BytecodeFunction>> code) {
+    for (auto& f : code) {
+        if (functions.count(f->name)) bytecode[f->name] = std::move(f);
+    }
+    // Функция без готовых вызываемых скомпилируется обычным путём
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto it = bytecode.begin(); it != bytecode.end();) {
+            auto& callees = it->second->callees;
+            if (std::any_of(callees.begin(), callees.end(), [&](auto& c) { return !bytecode.count(c); })) {
+                it = bytecode.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& [name, f] : bytecode) {
+        f->targets.clear();
+        for (const auto& callee : f->callees) f->targets.push_back(bytecode.at(callee).get());
+    }
+}
+
+TierManager::LoopProfile& TierManager::loopProfile(FuncDeclNode& func, ASTNode& loop) {
+    LoopProfile& lp = loops[&loop];
+    if (!lp.loop) {
+        lp.func = &func;
+        lp.loop = &loop;
+    }
+    return lp;
+}
+
+void TierManager::promote(Profile& p) {
+    if (p.queued || !p.func) return;
+    p.queued = true;
+    submit({p.func});
+}
+
+void TierManager::promoteLoop(LoopProfile& lp) {
+    lp.queued = true;
+    submit({lp.func, lp.loop});
+}
+
+void TierManager::submit(Job job) {
+    if (!options.background) {
+        Result r = compile(job);
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            finished.push_back(std::move(r));
+        }
+        ready.store(true, std::memory_order_release);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        queue.push_back(job);
+    }
+    // Поток заводится при первом повышении: короткие программы его не ждут
+    if (!worker.joinable()) worker = std::thread(&TierManager::work, this);
+    wake.notify_one();
+}
+
+void TierManager::work() {
+    Trace::nameThread("tier compiler");
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            wake.wait(guard, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = queue.front();
+            queue.pop_front();
+        }
+        Result r = compile(job);
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            finished.push_back(std::move(r));
+        }
+        ready.store(true, std::memory_order_release);
+    }
+}
+
+// Фоновый поток: байт-код функции или цикла и всех достижимых из них вызовов
+TierManager::Result TierManager::compile(const Job& job) {
+    Trace::Span span("tier", job.loop ? "compile loop" : "compile", job.func->name);
+    Result r{job.func, job.loop};
+    FuncDeclNode& func = *job.func;
+    if (job.loop) {
+        BytecodeCompiler compiler(functions, constants);
+        int frame = std::max(func.frame_size, static_cast<int>(func.params.size()));
+        auto code = compiler.compileLoop(func, *job.loop, frame);
+        if (!code) {
+            r.error = compiler.getError();
+            return r;
+        }
+        optimizeBytecode(*code);
+        r.loopCode = std::make_unique<BytecodeFunction>(std::move(*code));
+        if (!compileGroup(r.loopCode->callees, r)) return r;
+        for (const auto& callee : r.loopCode->callees) r.loopCode->targets.push_back(bytecode.at(callee).get());
+        return r;
+    }
+
+    if (!compileGroup({func.name}, r)) return r;
+    // Функция могла попасть в байт-код раньше как вызываемая из другой
+    if (std::none_of(r.group.begin(), r.group.end(), [&](auto& m) { return m.first == &func; })) {
+        r.group.emplace_back(&func, bytecode.at(func.name).get());
+    }
+    if (jit) r.native = jit->compile(func);
+    return r;
+}
+
+// Компилирует и связывает ещё не переведённые функции из pending и их вызываемые
+bool TierManager::compileGroup(std::vector<std::string> pending, Result& r) {
+    std::unordered_map<std::string, std::unique_ptr<BytecodeFunction>> group;
+    while (!pending.empty()) {
+        std::string name = pending.back();
+        pending.pop_back();
+        if (group.count(name) || bytecode.count(name)) continue;
+
+        auto it = functions.find(name);
+        if (it == functions.end()) {
+            r.error = "calls undefined function " + name;
+            return false;
+        }
+        BytecodeCompiler compiler(functions, constants);
+        auto code = compiler.compile(*it->second);
+        if (!code) {
+            r.error = it->second == r.func && !r.loop ? compiler.getError()
+                                                      : "calls " + name + ": " + compiler.getError();
+            return false;
+        }
+        optimizeBytecode(*code);
+        for (const auto& callee : code->callees) pending.push_back(callee);
+        group[name] = std::make_unique<BytecodeFunction>(std::move(*code));
+    }
+
+    // Связывание вызовов: вызываемые либо в группе, либо скомпилированы раньше
+    for (auto& [name, code] : group) {
+        for (const auto& callee : code->callees) {
+            auto own = group.find(callee);
+            code->targets.push_back(own != group.end() ? own->second.get() : bytecode.at(callee).get());
+        }
+    }
+    for (auto& [name, code] : group) {
+        r.group.emplace_back(functions.at(name), code.get());
+        bytecode[name] = std::move(code);
+    }
+    return true;
+}
+
+void TierManager::install() {
+    std::vector<Result> done;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        done.swap(finished);
+        ready.store(false, std::memory_order_relaxed);
+    }
+    for (auto& r : done) {
+        if (r.loop) {
+            installLoop(r);
+            continue;
+        }
+        if (!r.error.empty()) {
+            rejected[r.func->name] = r.error;
+            if (options.log) {
+                std::cerr << "Tier: " << r.func->name << " stays in interpreter, " << r.error << std::endl;
+            }
+            continue;
+        }
+        for (auto [func, code] : r.group) {
+            Profile& p = profiles[func];
+            if (p.tier != Tier::Tree) continue;
+            p.code = code;
+            p.tier = r.native && jit->isCompiled(*func) ? Tier::Native : Tier::Bytecode;
+            p.queued = true;
+            if (!options.log) continue;
+            std::cerr << "Tier: " << func->name << " -> " << tierName(p.tier);
+            if (func == r.func) {
+                std::cerr << " (" << p.calls << " calls, " << p.backEdges << " back-edges)" << std::endl;
+            } else {
+                std::cerr << " (with " << r.func->name << ")" << std::endl;
+            }
+        }
+    }
+}
+
+void TierManager::installLoop(Result& r) {
+    LoopProfile& lp = loops[r.loop];
+    if (!r.error.empty()) {
+        if (options.log) {
+            std::cerr << "Tier: loop in " << r.func->name << " stays in interpreter, " << r.error << std::endl;
+        }
+        return;
+    }
+    // Вызываемые из цикла функции тоже переходят на байт-код
+    for (auto [func, code] : r.group) {
+        Profile& p = profiles[func];
+        if (p.tier != Tier::Tree) continue;
+        p.code = code;
+        p.tier = Tier::Bytecode;
+        p.queued = true;
+    }
+    for (const Instr& in : r.loopCode->code) {
+        if ((in.op == Op::Store || in.op == Op::Inc) &&
+            std::find(lp.stores.begin(), lp.stores.end(), in.a) == lp.stores.end()) {
+            lp.stores.push_back(in.a);
+        }
+    }
+    lp.code = r.loopCode.get();
+    loopCode.push_back(std::move(r.loopCode));
+    if (options.log) {
+        std::cerr << "Tier: loop in " << r.func->name << " -> bytecode (OSR after " << lp.backEdges
+                  << " back-edges, " << lp.code->resume.size() << " deopt points)" << std::endl;
+    }
+}
+
+BytecodeVM::LoopExit TierManager::runLoop(LoopProfile& lp, std::vector<Slot>& slots, int depth) {
+    uint64_t before = vm.getIterations();
+    ++lp.entries;
+    BytecodeVM::LoopExit exit = vm.enterLoop(*lp.code, slots, depth);
+    lp.iterations += vm.getIterations() - before;
+    if (exit.op != Op::Deopt) return exit;
+
+    // Код, который почти сразу возвращается в интерпретатор, только мешает
+    if (++lp.deopts >= kDeoptLimit && lp.iterations < 4 * static_cast<uint64_t>(lp.deopts)) {
+        lp.code = nullptr;
+        lp.discarded = true;
+        if (options.log) {
+            std::cerr << "Tier: loop in " << lp.func->name << " back to interpreter after " << lp.deopts
+                      << " deopts in " << lp.iterations << " iterations" << std::endl;
+        }
+    }
+    return exit;
+}
+
+Value TierManager::runBytecode(const Profile& p, const std::vector<Value>& args, int depth) {
+    const BytecodeFunction& code = *p.code;
+    std::vector<Slot> slots(args.size());
+    for (size_t i = 0; i < args.size(); ++i) slots[i] = toSlot(args[i], code.param_kinds[i]);
+    return fromSlot(vm.call(code, slots, depth), code.return_kind);
+}
+
+std::optional<int64_t> TierManager::runNative(const Profile& p, const std::vector<int64_t>& args) {
+    return jit->invoke(*p.func, args);
+}
+
+void TierManager::printReport(std::ostream& out) const {
+    out << "Tier report:" << std::endl;
+    std::vector<std::string> names;
+    for (auto& [name, func] : functions) names.push_back(name);
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        const Profile& p = profiles.at(functions.at(name));
+        out << "  " << name << ": " << tierName(p.tier) << ", " << p.calls << " interpreted calls, "
+            << p.backEdges << " back-edges";
+        if (auto it = rejected.find(name); it != rejected.end()) out << ", not compiled: " << it->second;
+        out << std::endl;
+        for (auto& [node, lp] : loops) {
+            if (lp.func != p.func || (!lp.code && !lp.discarded)) continue;
+            out << "    loop: " << (lp.discarded ? "discarded" : "bytecode") << ", " << lp.entries << " OSR entries, "
+                << lp.iterations << " iterations, " << lp.deopts << " deopts" << std::endl;
+        }
+    }
+}
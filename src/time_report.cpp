@@ -0,0 +1,131 @@
+#include "../inc/time_report.hpp"
+#include <cstdio>
+#include <ctime>
+#include <malloc.h>
+#include <sys/resource.h>
+
+namespace {
+
+double cpuMs() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int64_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<int64_t>(info.uordblks + info.hblkhd);
+}
+
+long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+double msSince(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - from).count();
+}
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof buf, "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + '"';
+}
+
+std::string fixed(double v, int digits) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.*f", digits, v);
+    return buf;
+}
+
+} // namespace
+
+TimeReport::Phase::Phase(TimeReport* report, const char* name) : report(report), name(name) {
+    if (!report) return;
+    heap = heapInUse();
+    cpu = cpuMs();
+    wall = std::chrono::steady_clock::now();
+}
+
+TimeReport::Phase::~Phase() {
+    if (!report) return;
+    double w = msSince(wall);
+    double c = cpuMs() - cpu;
+    report->add(name, w, c, heapInUse() - heap);
+}
+
+TimeReport::TimeReport(std::string file)
+    : file(std::move(file)), start(std::chrono::steady_clock::now()), startCpu(cpuMs()) {}
+
+void TimeReport::add(const char* name, double wall, double cpu, int64_t heap) {
+    long rss = peakRssKb();
+    for (auto& m : phases) {
+        if (m.name != name) continue;
+        m.wall += wall;
+        m.cpu += cpu;
+        m.heap += heap;
+        m.peakRss = rss;
+        ++m.calls;
+        return;
+    }
+    phases.push_back({name, wall, cpu, heap, rss, 1});
+}
+
+void TimeReport::count(const std::string& name, uint64_t value) {
+    for (auto& c : counters) {
+        if (c.first == name) {
+            c.second = value;
+            return;
+        }
+    }
+    counters.emplace_back(name, value);
+}
+
+void TimeReport::print(std::ostream& out) const {
+    char line[128];
+    out << "Time report: " << file << std::endl;
+    std::snprintf(line, sizeof line, "  %-12s %10s %10s %12s %12s", "phase", "wall ms", "cpu ms", "heap KB", "peak RSS KB");
+    out << line << std::endl;
+    for (const auto& m : phases) {
+        std::snprintf(line, sizeof line, "  %-12s %10.3f %10.3f %12.1f %12ld", m.name.c_str(), m.wall, m.cpu,
+                      m.heap / 1024.0, m.peakRss);
+        out << line << std::endl;
+    }
+    std::snprintf(line, sizeof line, "  %-12s %10.3f %10.3f %12s %12ld", "total", msSince(start), cpuMs() - startCpu, "",
+                  peakRssKb());
+    out << line << std::endl;
+    if (counters.empty()) return;
+    out << " ";
+    for (size_t k = 0; k < counters.size(); ++k) {
+        out << (k ? ", " : " ") << counters[k].second << ' ' << counters[k].first;
+    }
+    out << std::endl;
+}
+
+void TimeReport::printJson(std::ostream& out) const {
+    out << "{\"file\": " << jsonString(file) << ", \"phases\": [";
+    for (size_t k = 0; k < phases.size(); ++k) {
+        const Measure& m = phases[k];
+        out << (k ? ", " : "") << "{\"name\": " << jsonString(m.name) << ", \"wall_ms\": " << fixed(m.wall, 3)
+            << ", \"cpu_ms\": " << fixed(m.cpu, 3) << ", \"heap_bytes\": " << m.heap << ", \"peak_rss_kb\": " << m.peakRss
+            << ", \"calls\": " << m.calls << "}";
+    }
+    out << "], \"total\": {\"wall_ms\": " << fixed(msSince(start), 3) << ", \"cpu_ms\": " << fixed(cpuMs() - startCpu, 3)
+        << ", \"peak_rss_kb\": " << peakRssKb() << "}, \"counters\": {";
+    for (size_t k = 0; k < counters.size(); ++k) {
+        out << (k ? ", " : "") << jsonString(counters[k].first) << ": " << counters[k].second;
+    }
+    out << "}}" << std::endl;
+}
@@ -0,0 +1,150 @@
+#include "../inc/trace.hpp"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<bool> Trace::enabled{false};
+int Trace::callSampling = 0;
+
+namespace {
+
+struct Event {
+    const char* category;
+    std::string name;
+    std::string detail;
+    double start; // мкс от начала трассировки
+    double duration;
+};
+
+struct Buffer {
+    int tid;
+    std::string name;
+    std::vector<Event> events;
+    size_t calls = 0;
+};
+
+std::mutex lock; // список буферов, путь, начало
+std::vector<std::unique_ptr<Buffer>> buffers;
+std::string output;
+std::chrono::steady_clock::time_point origin;
+std::thread::id mainThread; // поток, вызвавший start
+std::atomic<uint32_t> generation{0};
+
+thread_local Buffer* local = nullptr;
+thread_local uint32_t localGeneration = 0;
+
+// Буфер потока; после нового start поток заводит новый
+Buffer& buffer() {
+    uint32_t current = generation.load(std::memory_order_acquire);
+    if (!local || localGeneration != current) {
+        std::lock_guard<std::mutex> guard(lock);
+        buffers.push_back(std::make_unique<Buffer>());
+        local = buffers.back().get();
+        local->tid = static_cast<int>(buffers.size());
+        local->name = std::this_thread::get_id() == mainThread ? "main" : "thread " + std::to_string(local->tid);
+        localGeneration = current;
+    }
+    return *local;
+}
+
+double micros(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - origin).count();
+}
+
+void writeString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof buf, "\\u%04x", c);
+            out << buf;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+void Trace::start(const std::string& path, int calls) {
+    std::lock_guard<std::mutex> guard(lock);
+    buffers.clear();
+    output = path;
+    origin = std::chrono::steady_clock::now();
+    mainThread = std::this_thread::get_id();
+    callSampling = calls > 0 ? calls : 0;
+    generation.fetch_add(1, std::memory_order_release);
+    enabled.store(true, std::memory_order_release);
+}
+
+void Trace::nameThread(const std::string& name) {
+    if (isEnabled()) buffer().name = name;
+}
+
+bool Trace::finish() {
+    if (!isEnabled()) return true;
+    enabled.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> guard(lock);
+    std::ofstream out(output);
+    char number[32];
+    auto fixed = [&](double v) {
+        std::snprintf(number, sizeof number, "%.3f", v);
+        return number;
+    };
+    int pid = static_cast<int>(getpid());
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for (const auto& b : buffers) {
+        out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+            << ", \"tid\": " << b->tid << ", \"args\": {\"name\": ";
+        writeString(out, b->name);
+        out << "}}";
+        first = false;
+        for (const Event& e : b->events) {
+            out << ",\n{\"name\": ";
+            writeString(out, e.name);
+            out << ", \"cat\": \"" << e.category << "\", \"ph\": \"X\", \"ts\": " << fixed(e.start);
+            out << ", \"dur\": " << fixed(e.duration) << ", \"pid\": " << pid << ", \"tid\": " << b->tid;
+            if (!e.detail.empty()) {
+                out << ", \"args\": {\"detail\": ";
+                writeString(out, e.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    buffers.clear();
+    return static_cast<bool>(out);
+}
+
+Trace::Span::Span(const char* category, const char* name, std::string detail) {
+    if (!isEnabled()) return;
+    this->category = category;
+    this->name = name;
+    this->detail = std::move(detail);
+    begin = std::chrono::steady_clock::now();
+}
+
+Trace::Span::Span(const std::string& function) {
+    if (!isEnabled()) return;
+    Buffer& b = buffer();
+    if (b.calls >= kMaxCallEvents) return;
+    ++b.calls;
+    category = "call";
+    name = function;
+    begin = std::chrono::steady_clock::now();
+}
+
+Trace::Span::~Span() {
+    if (!category || !isEnabled()) return;
+    auto end = std::chrono::steady_clock::now();
+    buffer().events.push_back({category, std::move(name), std::move(detail), micros(begin), micros(end) - micros(begin)});
+}
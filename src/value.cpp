@@ -0,0 +1,221 @@
+#include "../inc/value.hpp"
+#include "../inc/type.hpp"
+#include <cstring>
+#include <sstream>
+
+Value Value::integer(Kind kind, int64_t v) {
+    Value r;
+    r.kind = kind;
+    switch (kind) {
+    case Kind::Bool: r.i = v != 0; break;
+    case Kind::Char: r.i = static_cast<int8_t>(v); break;
+    case Kind::UChar: r.i = static_cast<uint8_t>(v); break;
+    case Kind::Short: r.i = static_cast<int16_t>(v); break;
+    case Kind::UShort: r.i = static_cast<uint16_t>(v); break;
+    case Kind::Int: r.i = static_cast<int32_t>(v); break;
+    case Kind::UInt: r.i = static_cast<uint32_t>(v); break;
+    default: r.i = v; break;
+    }
+    return r;
+}
+
+Value Value::floating(Kind kind, double v) {
+    Value r;
+    r.kind = kind;
+    r.f = kind == Kind::Float ? static_cast<float>(v) : v;
+    return r;
+}
+
+Value Value::string(const std::string_view& text) {
+    Value r;
+    r.kind = Kind::String;
+    r.s = &text;
+    return r;
+}
+
+double Value::asDouble() const {
+    if (isFloating()) return f;
+    if (kind == Kind::ULong) return static_cast<double>(static_cast<uint64_t>(i));
+    return static_cast<double>(i);
+}
+
+size_t Value::length() const {
+    if (element != Kind::Struct) return static_cast<size_t>(i);
+    return (agg->raw.size() - offset) / layout->size;
+}
+
+size_t Storage::size() const {
+    size_t one = element == Value::Kind::Struct || kind == Value::Kind::Struct ? layout->size
+                                                                             : Aggregate::kindSize(element);
+    if (kind == Value::Kind::Struct) return one;
+    if (kind == Value::Kind::Array) return one * count;
+    return Aggregate::kindSize(kind);
+}
+
+Value::Kind kindOf(const std::string& typeName, bool isUnsigned) {
+    using K = Value::Kind;
+    if (typeName == "int") return isUnsigned ? K::UInt : K::Int;
+    if (typeName == "char") return isUnsigned ? K::UChar : K::Char;
+    if (typeName == "short") return isUnsigned ? K::UShort : K::Short;
+    if (typeName == "long") return isUnsigned ? K::ULong : K::Long;
+    if (typeName == "bool") return K::Bool;
+    if (typeName == "float") return K::Float;
+    if (typeName == "double") return K::Double;
+    if (typeName == "string") return K::String;
+    return K::Void;
+}
+
+Value convertTo(const Value& v, Value::Kind kind) {
+    if (v.kind == kind) return v;
+    if (kind == Value::Kind::Float || kind == Value::Kind::Double) {
+        return Value::floating(kind, v.asDouble());
+    }
+    if (kind >= Value::Kind::Bool && kind <= Value::Kind::ULong) {
+        if (kind == Value::Kind::Bool) return Value::integer(kind, v.truthy());
+        return Value::integer(kind, v.asInt());
+    }
+    return v;
+}
+
+Value copyValue(const Value& v, MemoryMeter* meter) {
+    if (v.kind != Value::Kind::Struct || !v.agg) return v;
+    Value r = makeStruct(v.layout, meter);
+    std::memcpy(r.agg->raw.data(), v.agg->raw.data() + v.offset, v.layout->size);
+    return r;
+}
+
+std::string toString(const Value& v) {
+    using K = Value::Kind;
+    switch (v.kind) {
+    case K::Bool: return v.i ? "true" : "false";
+    case K::Char:
+    case K::UChar: return std::string(1, static_cast<char>(v.i));
+    case K::ULong: return std::to_string(static_cast<uint64_t>(v.i));
+    case K::Float:
+    case K::Double: {
+        std::ostringstream out;
+        out << v.f;
+        return out.str();
+    }
+    case K::String: return std::string(*v.s);
+    case K::Struct: return "<struct " + v.layout->name + ">";
+    case K::Array: return "<array>";
+    case K::Void: return "";
+    default: return std::to_string(v.i);
+    }
+}
+
+size_t Aggregate::kindSize(Value::Kind kind) {
+    using K = Value::Kind;
+    switch (kind) {
+    case K::Bool: case K::Char: case K::UChar: return 1;
+    case K::Short: case K::UShort: return 2;
+    case K::Int: case K::UInt: case K::Float: return 4;
+    default: return 8;
+    }
+}
+
+namespace {
+
+template <typename T>
+T rawLoad(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+template <typename T>
+void rawStore(unsigned char* p, T v) {
+    std::memcpy(p, &v, sizeof v);
+}
+
+} // namespace
+
+Value loadRaw(const std::shared_ptr<Aggregate>& agg, size_t offset, const Storage& what) {
+    using K = Value::Kind;
+    const unsigned char* p = agg->raw.data() + offset;
+    switch (what.kind) {
+    case K::Bool: case K::UChar: return Value::integer(what.kind, rawLoad<uint8_t>(p));
+    case K::Char: return Value::integer(what.kind, rawLoad<int8_t>(p));
+    case K::Short: return Value::integer(what.kind, rawLoad<int16_t>(p));
+    case K::UShort: return Value::integer(what.kind, rawLoad<uint16_t>(p));
+    case K::Int: return Value::integer(what.kind, rawLoad<int32_t>(p));
+    case K::UInt: return Value::integer(what.kind, rawLoad<uint32_t>(p));
+    case K::Float: return Value::floating(what.kind, rawLoad<float>(p));
+    case K::Double: return Value::floating(what.kind, rawLoad<double>(p));
+    case K::String: {
+        Value r;
+        r.kind = K::String;
+        r.s = rawLoad<const std::string_view*>(p);
+        return r;
+    }
+    case K::Struct:
+    case K::Array: {
+        Value r;
+        r.kind = what.kind;
+        r.element = what.element;
+        r.offset = static_cast<uint32_t>(offset);
+        if (what.kind == K::Array && what.element != K::Struct) r.i = what.count;
+        else r.layout = what.layout;
+        r.agg = agg;
+        return r;
+    }
+    default: return Value::integer(what.kind, rawLoad<int64_t>(p));
+    }
+}
+
+void storeRaw(Aggregate& agg, size_t offset, const Storage& what, const Value& v) {
+    using K = Value::Kind;
+    unsigned char* p = agg.raw.data() + offset;
+    switch (what.kind) {
+    case K::Struct:
+    case K::Array:
+        // s = s: источник и приёмник могут совпадать
+        std::memmove(p, v.agg->raw.data() + v.offset, what.size());
+        return;
+    case K::String: rawStore<const std::string_view*>(p, v.s); return;
+    default: break;
+    }
+    Value c = convertTo(v, what.kind);
+    switch (Aggregate::kindSize(what.kind)) {
+    case 1: rawStore<uint8_t>(p, static_cast<uint8_t>(c.i)); break;
+    case 2: rawStore<uint16_t>(p, static_cast<uint16_t>(c.i)); break;
+    case 4:
+        if (what.kind == K::Float) rawStore<float>(p, static_cast<float>(c.f));
+        else rawStore<uint32_t>(p, static_cast<uint32_t>(c.i));
+        break;
+    default:
+        if (what.kind == K::Double) rawStore<double>(p, c.f);
+        else rawStore<int64_t>(p, c.i);
+        break;
+    }
+}
+
+// Байты учитываются до выделения: слишком большой массив не выделяется вовсе
+static std::shared_ptr<Aggregate> allocate(size_t bytes, MemoryMeter* meter) {
+    if (meter) meter->allocate(bytes);
+    auto agg = std::make_shared<Aggregate>();
+    agg->raw.assign(bytes, 0);
+    agg->meter = meter;
+    return agg;
+}
+
+Value makeStruct(const StructType* layout, MemoryMeter* meter) {
+    Value v;
+    v.kind = Value::Kind::Struct;
+    v.layout = layout;
+    v.agg = allocate(layout->size, meter);
+    return v;
+}
+
+Value makeArray(const Storage& element, size_t count, MemoryMeter* meter) {
+    Value v;
+    v.kind = Value::Kind::Array;
+    v.element = element.kind;
+    if (element.kind == Value::Kind::Struct) v.layout = element.layout;
+    else v.i = static_cast<int64_t>(count);
+    size_t stride = element.size();
+    if (stride && count > SIZE_MAX / stride) throw RuntimeError("Array of " + std::to_string(count) + " elements is too large");
+    v.agg = allocate(count * stride, meter);
+    return v;
+}
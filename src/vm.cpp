@@ -0,0 +1,303 @@
+#include "../inc/vm.hpp"
+#include "../inc/interpreter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+using K = Value::Kind;
+
+int64_t wrap(int64_t v) {
+    return static_cast<int32_t>(static_cast<uint32_t>(v));
+}
+
+int64_t wrapUnsigned(uint64_t v) {
+    return static_cast<uint32_t>(v);
+}
+
+bool isFloating(K kind) {
+    return kind == K::Float || kind == K::Double;
+}
+
+bool compare(Op op, Slot l, Slot r) {
+    switch (op) {
+    case Op::Lt: return l.i < r.i;
+    case Op::Le: return l.i <= r.i;
+    case Op::Gt: return l.i > r.i;
+    case Op::Ge: return l.i >= r.i;
+    case Op::Eq: return l.i == r.i;
+    case Op::Ne: return l.i != r.i;
+    case Op::LtU: return static_cast<uint64_t>(l.i) < static_cast<uint64_t>(r.i);
+    case Op::LeU: return static_cast<uint64_t>(l.i) <= static_cast<uint64_t>(r.i);
+    case Op::GtU: return static_cast<uint64_t>(l.i) > static_cast<uint64_t>(r.i);
+    case Op::GeU: return static_cast<uint64_t>(l.i) >= static_cast<uint64_t>(r.i);
+    case Op::LtD: return l.f < r.f;
+    case Op::LeD: return l.f <= r.f;
+    case Op::GtD: return l.f > r.f;
+    case Op::GeD: return l.f >= r.f;
+    case Op::EqD: return l.f == r.f;
+    default: return l.f != r.f;
+    }
+}
+
+// Приведение как convertTo, но без тегов
+Slot convert(Slot v, K from, K to) {
+    Slot r;
+    if (isFloating(to)) {
+        double d = isFloating(from) ? v.f
+                 : from == K::ULong ? static_cast<double>(static_cast<uint64_t>(v.i))
+                                    : static_cast<double>(v.i);
+        r.f = to == K::Float ? static_cast<float>(d) : d;
+    } else if (to == K::Bool) {
+        r.i = isFloating(from) ? v.f != 0 : v.i != 0;
+    } else {
+        r.i = Value::integer(to, isFloating(from) ? static_cast<int64_t>(v.f) : v.i).i;
+    }
+    return r;
+}
+
+} // namespace
+
+Slot BytecodeVM::call(const BytecodeFunction& func, const std::vector<Slot>& args, int depth) {
+    enter(func, args.data(), args.size(), func.param_kinds);
+    return execute(func, 0, depth);
+}
+
+BytecodeVM::LoopExit BytecodeVM::enterLoop(const BytecodeFunction& loop, std::vector<Slot>& slots, int depth) {
+    enter(loop, slots.data(), slots.size(), loop.slot_kinds);
+    // Цикл исполняется в кадре своей функции, а не как новый вызов
+    Slot value = execute(loop, 0, depth - 1);
+    std::copy(stack.begin(), stack.begin() + slots.size(), slots.begin());
+    return {exitOp, value, exitPoint};
+}
+
+void BytecodeVM::enter(const BytecodeFunction& func, const Slot* args, size_t count,
+                       const std::vector<Value::Kind>& kinds) {
+    if (stack.size() < count) stack.resize(count);
+    std::copy(args, args + count, stack.begin());
+#ifndef NDEBUG
+    if (tags.size() < stack.size()) tags.resize(stack.size());
+    for (size_t i = 0; i < count; ++i) tags[i] = i < kinds.size() ? kinds[i] : K::Void;
+#endif
+}
+
+// Вне строки: выборки редки, исполнитель только передаёт свой кадр
+void BytecodeVM::sample(Active& top, const Instr* at) {
+    if (!profiler) return;
+    top.pc = static_cast<size_t>(at - top.func->code.data());
+    std::vector<Profiler::Frame> frames;
+    for (const Active* a = &top; a; a = a->caller) {
+        const auto& lines = a->func->lines;
+        frames.push_back({&a->func->name, a->pc < lines.size() ? lines[a->pc] : 0});
+    }
+    std::reverse(frames.begin(), frames.end());
+    profiler->sample(frames);
+}
+
+#ifndef NDEBUG
+// Проверка видов операндов инструкции pc и теги после неё; sp — до исполнения
+void BytecodeVM::checkTags(const BytecodeFunction& func, size_t pc, size_t base, size_t sp) {
+    const Instr& in = func.code[pc];
+    K* t = tags.data();
+    auto expect = [&](size_t at, bool floating) {
+        if (t[at] == K::Void || isFloating(t[at]) != floating) {
+            throw std::logic_error("Bytecode type check failed in " + func.name + " at " + std::to_string(pc));
+        }
+    };
+    auto binary = [&](bool floating, K result) {
+        expect(sp - 2, floating);
+        expect(sp - 1, floating);
+        t[sp - 2] = result;
+    };
+    switch (in.op) {
+    case Op::Const: t[sp] = K::Int; break;
+    case Op::ConstK: t[sp] = static_cast<K>(in.b); break;
+    case Op::Load:
+        expect(base + in.a, isFloating(t[base + in.a]));
+        t[sp] = t[base + in.a];
+        break;
+    case Op::Store: t[base + in.a] = t[sp - 1]; break;
+    case Op::Dup: t[sp] = t[sp - 1]; break;
+    case Op::Convert:
+        expect(sp - 1, isFloating(static_cast<K>(in.a)));
+        t[sp - 1] = static_cast<K>(in.b);
+        break;
+    case Op::Neg: case Op::Not: expect(sp - 1, false); t[sp - 1] = K::Int; break;
+    case Op::NegU: expect(sp - 1, false); t[sp - 1] = K::UInt; break;
+    case Op::NegL: expect(sp - 1, false); t[sp - 1] = K::Long; break;
+    case Op::NegD: expect(sp - 1, true); break;
+    case Op::Jz: case Op::Jnz: expect(sp - 1, false); break;
+    case Op::Inc: expect(base + in.a, false); break;
+    case Op::CmpJz:
+        expect(sp - 2, static_cast<Op>(in.b) >= Op::LtD);
+        expect(sp - 1, static_cast<Op>(in.b) >= Op::LtD);
+        break;
+    case Op::Call: {
+        const BytecodeFunction& callee = *func.targets[in.a];
+        for (int i = 0; i < in.b; ++i) expect(sp - in.b + i, isFloating(callee.param_kinds[i]));
+        break;
+    }
+    case Op::Ret:
+        if (func.return_kind != K::Void) expect(sp - 1, isFloating(func.return_kind));
+        break;
+    case Op::Pop: case Op::Jmp: case Op::Exit: case Op::Deopt:
+        break;
+    case Op::Add: case Op::Sub: case Op::Mul: case Op::Div: case Op::Mod:
+    case Op::Lt: case Op::Le: case Op::Gt: case Op::Ge: case Op::Eq: case Op::Ne:
+    case Op::LtU: case Op::LeU: case Op::GtU: case Op::GeU:
+        binary(false, K::Int);
+        break;
+    case Op::AddU: case Op::SubU: case Op::MulU: case Op::DivU: case Op::ModU:
+        binary(false, K::UInt);
+        break;
+    case Op::AddL: case Op::SubL: case Op::MulL: case Op::DivL: case Op::ModL: case Op::DivUL: case Op::ModUL:
+        binary(false, K::Long);
+        break;
+    case Op::AddD: case Op::SubD: case Op::MulD: case Op::DivD:
+        binary(true, K::Double);
+        break;
+    case Op::LtD: case Op::LeD: case Op::GtD: case Op::GeD: case Op::EqD: case Op::NeD:
+        binary(true, K::Int);
+        break;
+    }
+}
+#endif
+
+// Аргументы уже лежат в stack[base..base+param_count): это первые слоты кадра
+Slot BytecodeVM::execute(const BytecodeFunction& func, size_t base, int depth, const Active* caller) {
+    if (depth >= maxDepth) {
+        throw LimitError(Limit::Depth, "Call stack overflow in " + func.name);
+    }
+    size_t frame = std::max(func.frame_size, func.param_count);
+    size_t need = base + frame + func.max_stack;
+    if (stack.size() < need) stack.resize(std::max(need, stack.size() * 2));
+    std::fill(stack.begin() + base + func.param_count, stack.begin() + base + frame, Slot{});
+#ifndef NDEBUG
+    if (tags.size() < stack.size()) tags.resize(stack.size());
+    std::fill(tags.begin() + base + func.param_count, tags.begin() + base + frame, K::Void);
+#endif
+
+    Slot* s = stack.data();
+    Slot* locals = s + base;
+    size_t sp = base + frame; // первая свободная ячейка стека вычислений
+    const Instr* code = func.code.data();
+    size_t pc = 0;
+    Active self{&func, 0, caller};
+#ifdef INTERPRET_COUNTERS
+    size_t previous = kOpCount; // пары инструкций считаются внутри вызова
+#endif
+    for (;;) {
+#ifndef NDEBUG
+        checkTags(func, pc, base, sp);
+#endif
+#ifdef INTERPRET_COUNTERS
+        if (counters) previous = counters->instruction(previous, code[pc].op);
+#endif
+        const Instr& in = code[pc++];
+        switch (in.op) {
+        case Op::Const: s[sp++].i = in.a; break;
+        case Op::ConstK: s[sp++] = func.constants[in.a]; break;
+        case Op::Load: s[sp++] = locals[in.a]; break;
+        case Op::Store: locals[in.a] = s[--sp]; break;
+        case Op::Dup: s[sp] = s[sp - 1]; ++sp; break;
+        case Op::Pop: --sp; break;
+        case Op::Convert: s[sp - 1] = convert(s[sp - 1], static_cast<K>(in.a), static_cast<K>(in.b)); break;
+
+        case Op::Add: --sp; s[sp - 1].i = wrap(s[sp - 1].i + s[sp].i); break;
+        case Op::Sub: --sp; s[sp - 1].i = wrap(s[sp - 1].i - s[sp].i); break;
+        case Op::Mul: --sp; s[sp - 1].i = wrap(s[sp - 1].i * s[sp].i); break;
+        case Op::Div:
+        case Op::Mod: {
+            int64_t r = s[--sp].i;
+            int64_t& l = s[sp - 1].i;
+            if (r == 0) throw RuntimeError("Division by zero");
+            if (in.op == Op::Div) l = wrap(r == -1 ? -l : l / r);
+            else l = r == -1 ? 0 : l % r;
+            break;
+        }
+        case Op::Neg: s[sp - 1].i = wrap(-s[sp - 1].i); break;
+        case Op::Not: s[sp - 1].i = s[sp - 1].i == 0; break;
+
+        // Операнды unsigned int могут быть знаковыми целыми: сначала 64 бита, потом усечение
+        case Op::AddU: --sp; s[sp - 1].i = wrapUnsigned(uint64_t(s[sp - 1].i) + uint64_t(s[sp].i)); break;
+        case Op::SubU: --sp; s[sp - 1].i = wrapUnsigned(uint64_t(s[sp - 1].i) - uint64_t(s[sp].i)); break;
+        case Op::MulU: --sp; s[sp - 1].i = wrapUnsigned(uint64_t(s[sp - 1].i) * uint64_t(s[sp].i)); break;
+        case Op::DivU:
+        case Op::ModU:
+        case Op::DivUL:
+        case Op::ModUL: {
+            uint64_t r = s[--sp].i;
+            uint64_t l = s[sp - 1].i;
+            if (r == 0) throw RuntimeError("Division by zero");
+            uint64_t v = in.op == Op::DivU || in.op == Op::DivUL ? l / r : l % r;
+            s[sp - 1].i = in.op == Op::DivU || in.op == Op::ModU ? wrapUnsigned(v) : static_cast<int64_t>(v);
+            break;
+        }
+        case Op::NegU: s[sp - 1].i = wrapUnsigned(0 - uint64_t(s[sp - 1].i)); break;
+
+        case Op::AddL: --sp; s[sp - 1].i = int64_t(uint64_t(s[sp - 1].i) + uint64_t(s[sp].i)); break;
+        case Op::SubL: --sp; s[sp - 1].i = int64_t(uint64_t(s[sp - 1].i) - uint64_t(s[sp].i)); break;
+        case Op::MulL: --sp; s[sp - 1].i = int64_t(uint64_t(s[sp - 1].i) * uint64_t(s[sp].i)); break;
+        case Op::DivL:
+        case Op::ModL: {
+            int64_t r = s[--sp].i;
+            int64_t& l = s[sp - 1].i;
+            if (r == 0) throw RuntimeError("Division by zero");
+            if (r == -1) l = in.op == Op::DivL ? int64_t(0 - uint64_t(l)) : 0;
+            else l = in.op == Op::DivL ? l / r : l % r;
+            break;
+        }
+        case Op::NegL: s[sp - 1].i = int64_t(0 - uint64_t(s[sp - 1].i)); break;
+
+        case Op::AddD: --sp; s[sp - 1].f += s[sp].f; break;
+        case Op::SubD: --sp; s[sp - 1].f -= s[sp].f; break;
+        case Op::MulD: --sp; s[sp - 1].f *= s[sp].f; break;
+        case Op::DivD: --sp; s[sp - 1].f /= s[sp].f; break;
+        case Op::NegD: s[sp - 1].f = -s[sp - 1].f; break;
+
+        case Op::Lt: case Op::Le: case Op::Gt: case Op::Ge: case Op::Eq: case Op::Ne:
+        case Op::LtU: case Op::LeU: case Op::GtU: case Op::GeU:
+        case Op::LtD: case Op::LeD: case Op::GtD: case Op::GeD: case Op::EqD: case Op::NeD:
+            --sp;
+            s[sp - 1].i = compare(in.op, s[sp - 1], s[sp]);
+            break;
+        case Op::Jmp:
+            pc = in.a;
+            iterations += in.b;
+            if (budget && in.b && budget->step()) [[unlikely]] sample(self, &in);
+            break;
+        case Op::Jz: if (s[--sp].i == 0) pc = in.a; break;
+        case Op::Jnz: if (s[--sp].i != 0) pc = in.a; break;
+        case Op::Inc: locals[in.a].i = wrap(locals[in.a].i + in.b); break;
+        case Op::CmpJz:
+            sp -= 2;
+            if (!compare(static_cast<Op>(in.b), s[sp], s[sp + 1])) pc = in.a;
+            break;
+        case Op::Call: {
+            // Аргументы на вершине стека становятся началом кадра вызываемой функции
+            sp -= in.b;
+            const BytecodeFunction& callee = *func.targets[in.a];
+            if (budget && budget->step()) [[unlikely]] sample(self, &in);
+            self.pc = pc - 1;
+            Slot r = execute(callee, sp, depth + 1, &self);
+            s = stack.data(); // стек мог вырасти
+            locals = s + base;
+#ifndef NDEBUG
+            tags[sp] = callee.return_kind == K::Void ? K::Int : callee.return_kind;
+#endif
+            s[sp++] = r;
+            break;
+        }
+        case Op::Ret:
+            exitOp = Op::Ret;
+            return s[sp - 1];
+        case Op::Exit:
+            exitOp = Op::Exit;
+            return Slot{};
+        case Op::Deopt:
+            exitOp = Op::Deopt;
+            exitPoint = in.a;
+            return Slot{};
+        }
+    }
+}